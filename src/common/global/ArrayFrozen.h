@@ -0,0 +1,188 @@
+//
+// v1 - Prototype character/item/tradeskill game.
+// Copyright (C) 2013 Adam Hayek (adam.hayek@gmail.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see [http://www.gnu.org/licenses/].
+//
+
+#pragma once
+
+#include "common\global\global.h"
+
+//
+//ArrayFrozen is a read only search table built from a sorted array, for large tables which are
+//searched far more often than they change, like item definitions.
+//
+//ArraySorted::Freeze already lays the item pointers out for searching, but every step of its search
+//still reads an item to compare it.  ArrayFrozen copies each item's key out with a key function and
+//stores the keys themselves in Eytzinger order, so a search only reads keys, several to a cache line,
+//until it has found its item.  Keys are compared with CompareFunc, the same as the find functions
+//generated by SortedArrayFindFuncMember, so the key function must return the member the array is sorted by.
+//
+//  SortedArrayKeyFuncMember(KeyFunc, int32, ItemDef, id);
+//  ArrayFrozen<int32, ItemDef> frozenDefs;
+//  frozenDefs.Build(itemDefs, KeyFunc);
+//  ItemDef *def = frozenDefs.Find(id);
+//
+//The table does not own the items and does not see changes to the array; Build it again after changing it.
+//
+template <class K, class C>
+class ArrayFrozen
+{
+private:
+    ArrayFrozen(ArrayFrozen const &other);
+public:
+    //returns the key of an item
+    typedef K (*KeyFunc)(C const *item);
+
+    ArrayFrozen();
+    ~ArrayFrozen();
+
+    //builds the table from the items of a sorted array, whose order must match the order of the keys.
+    template <class Array>
+    bool Build(Array const &sorted, KeyFunc keyFunc);
+
+    //finds the item with the given key, or returns NULL if there is none.
+    C *Find(K const key) const;
+
+    //number of items in the table
+    inline int32 Num() const;
+
+    //frees the table
+    void Reset();
+
+private:
+    //fills the subtree at frozenIndex from sorted, starting at itemIndex.  Returns the next item index.
+    template <class Array>
+    int32 Fill(Array const &sorted, KeyFunc keyFunc, int32 itemIndex, uint32 frozenIndex);
+
+    //number of items
+    int32 num;
+
+    //keys and items in Eytzinger order, starting at index 1.  The children of k are at 2k and 2k+1.
+    K *keys;
+    C **items;
+};
+
+//generates a key function for ArrayFrozen which returns a member of the item.
+#define SortedArrayKeyFuncMember(funcName, _KeyType, _ItemType, memberVar) static inline _KeyType funcName(_ItemType const *item) { return item->memberVar; };
+
+
+//
+//ArrayFrozen template functions
+//
+
+template <class K, class C>
+ArrayFrozen<K, C>::ArrayFrozen()
+{
+    //empty
+    num = 0;
+    keys = NULL;
+    items = NULL;
+}
+
+template <class K, class C>
+ArrayFrozen<K, C>::~ArrayFrozen()
+{
+    //free the table
+    Reset();
+}
+
+template <class K, class C> template <class Array>
+bool ArrayFrozen<K, C>::Build(Array const &sorted, KeyFunc keyFunc)
+{
+    IFBREAKFALSE(keyFunc == NULL);
+
+    //throw away the old table
+    Reset();
+
+    //check if there is nothing to search
+    if (sorted.Num() < 1)
+    {
+        return true;
+    }
+
+    //allocate the table, index 0 is unused
+    num = sorted.Num();
+    keys = new K[num + 1];
+    items = new C *[num + 1];
+    if (keys == NULL || items == NULL)
+    {
+        BREAK1();
+        Reset();
+        return false;
+    }
+    items[0] = NULL;
+
+    //an in order walk of the tree visits the items in sorted order
+    Fill(sorted, keyFunc, 0, 1);
+
+    //success
+    return true;
+}
+
+template <class K, class C> template <class Array>
+int32 ArrayFrozen<K, C>::Fill(Array const &sorted, KeyFunc keyFunc, int32 itemIndex, uint32 frozenIndex)
+{
+    //check if we are past the bottom of the tree
+    if (frozenIndex > uint32(num))
+    {
+        return itemIndex;
+    }
+
+    //left subtree has the items before us, then us, then the right subtree
+    itemIndex = Fill(sorted, keyFunc, itemIndex, frozenIndex * 2);
+    items[frozenIndex] = (C *)sorted.Get(itemIndex);
+    keys[frozenIndex] = keyFunc(items[frozenIndex]);
+    return Fill(sorted, keyFunc, itemIndex + 1, frozenIndex * 2 + 1);
+}
+
+template <class K, class C>
+C *ArrayFrozen<K, C>::Find(K const key) const
+{
+    //walk down the tree, going right whenever the key there is before the one we want
+    uint32 k = 1;
+    while (k <= uint32(num))
+    {
+        #if defined(__PLATFORM_WIN32_PC)
+        //the 16 descendants four levels down are next to each other.  Prefetching past the end is harmless.
+        _mm_prefetch((char const *)&keys[k * 16], _MM_HINT_T0);
+        #endif
+
+        k = 2 * k + uint32(::CompareFunc(keys[k], key) < 0);
+    }
+
+    //undo the right steps and the last left step, which leaves the first key that is not before the one we want
+    unsigned long trailingOnes = 0;
+    _BitScanForward(&trailingOnes, ~k);
+    k >>= trailingOnes + 1;
+
+    //check if it's the one
+    return (k != 0 && ::CompareFunc(keys[k], key) == 0) ? items[k] : NULL;
+}
+
+template <class K, class C>
+int32 ArrayFrozen<K, C>::Num() const
+{
+    return num;
+}
+
+template <class K, class C>
+void ArrayFrozen<K, C>::Reset()
+{
+    //free the table
+    delca(keys);
+    delca(items);
+    num = 0;
+}
@@ -0,0 +1,134 @@
+//
+// v1 - Prototype character/item/tradeskill game.
+// Copyright (C) 2013 Adam Hayek (adam.hayek@gmail.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see [http://www.gnu.org/licenses/].
+//
+
+#pragma once
+
+#include <string.h>
+#include "common\global\global.h"
+#include "common\global\ArrayStats.h"
+
+//
+//Hash functions for the keys of the hashed arrays.  These are declared before the arrays so the
+//array templates can see them.
+//
+
+//mixes the bits of a 32 bit value, so that every input bit affects every output bit.
+inline uint32 HashMix(uint32 value)
+{
+    //murmur3 finalizer
+    value ^= value >> 16;
+    value *= 0x85EBCA6B;
+    value ^= value >> 13;
+    value *= 0xC2B2AE35;
+    value ^= value >> 16;
+    return value;
+}
+
+//generic hash template function for integral types
+template <class Type> uint32 HashFunc(Type const value)
+{
+    //fold the high half into the low half, then mix
+    return HashMix(uint32(int64(value)) ^ uint32(int64(value) >> 32));
+}
+
+//generic hash template function for pointers that aren't strings
+template <class Type> uint32 HashFunc(Type const *value)
+{
+    //hash the address
+    return HashMix(uint32(size_t(value)));
+}
+
+//first class function overloads for strings instead of the above templates.
+inline uint32 HashFunc(char const *str)
+{
+    //FNV-1a
+    uint32 hash = 2166136261;
+    for (; *str != '\0'; str++)
+    {
+        hash = (hash ^ uint8(*str)) * 16777619;
+    }
+    return hash;
+}
+inline uint32 HashFunc(wchar const *str)
+{
+    //FNV-1a, one character at a time
+    uint32 hash = 2166136261;
+    for (; *str != 0; str++)
+    {
+        hash = (hash ^ uint32(*str)) * 16777619;
+    }
+    return hash;
+}
+
+//64 bit FNV-1a of a string, for keys that are looked up by hash alone and so need few collisions.
+inline uint64 HashFunc64(char const *str)
+{
+    uint64 hash = 14695981039346656037ULL;
+    for (; *str != '\0'; str++)
+    {
+        hash = (hash ^ uint8(*str)) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+//HashFunc64 of a string literal, unrolled by a template so the optimizer folds it to a constant.
+//The same value as HashFunc64 of the string, so literal and runtime keys can be mixed.
+//
+//  uint64 hash = HashLiteral("ITime.default");
+//
+template <int32 Index> struct HashLiteralStep
+{
+    //hashes the first Index characters
+    static __forceinline uint64 Hash(char const *str)
+    {
+        return (HashLiteralStep<Index - 1>::Hash(str) ^ uint8(str[Index - 1])) * 1099511628211ULL;
+    }
+};
+template <> struct HashLiteralStep<0>
+{
+    static __forceinline uint64 Hash(char const *str)
+    {
+        return 14695981039346656037ULL;
+    }
+};
+template <int32 Size> __forceinline uint64 HashLiteral(char const (&str)[Size])
+{
+    //the size includes the null, which isn't hashed
+    return HashLiteralStep<Size - 1>::Hash(str);
+}
+
+
+//
+//ArrayHashed maps keys to pointers to objects, using a hash table.  Keys are hashed with
+//HashFunc and compared with CompareFunc, so the same key types that work with the sorted
+//arrays work here.  The table doubles in size when it gets 7/8 full.
+//
+//Find, Add and Remove are O(1) on average.  Items are in no particular order, walk them
+//with Slots and GetSlot.
+//
+#define ArrayHashedImpl_ClassName ArrayHashed
+#include "src\ArrayHashedImpl.h"
+
+//
+//ArrayHashedOwner differs from ArrayHashed only in that it will delete
+//it's items on Empty and Reset, which become O(n).
+//
+#define ArrayHashedImpl_ClassName ArrayHashedOwner
+#define ArrayHashedImpl_Owner
+#include "src\ArrayHashedImpl.h"
+
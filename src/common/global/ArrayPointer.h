@@ -18,7 +18,12 @@
 
 #pragma once
 
+#include <stdlib.h>
+#include <string.h>
 #include "common\global\global.h"
+#include "common\global\ArrayStats.h"
+#include "common\global\ArraySpan.h"
+#include "common\global\PointerSearch.h"
 
 //
 //ArrayPointer is the most basic array type.  It holds pointers to objects
@@ -27,7 +32,7 @@
 //
 //Insertion is done at the end of the array and is O(1) when the array does 
 //not need to resize, and O(n) when the array is resized.  Overall, insertion is
-//O(log(n)) time.
+//O(log(n)) time.  The array is resized with realloc, so the heap can often grow it in place.
 //
 //There can never be a NULL pointer in the array.  Removal of an object from 
 //the array will cause a gap to occur which is filled with the element from the end
@@ -45,7 +50,18 @@
 #include "src\ArrayPointerImpl.h"
 
 //
-//ArrayPointerQueue preserves the order of items when calling Remove, which makes it O(n)
+//ArrayPointerInline differs from ArrayPointer only in that the first inlineMax pointers
+//are stored inside the array object itself, so small arrays never allocate.
+//Declare as ArrayPointerInline<Type, inlineMax>.
+//
+#define ArrayPointerImpl_ClassName ArrayPointerInline
+#define ArrayPointerImpl_Inline
+#include "src\ArrayPointerImpl.h"
+
+//
+//ArrayPointerQueue preserves the order of items when calling Remove, which makes it O(n).
+//The items are kept in a circular buffer, so PushBack, PushFront, PopFront and removing
+//the first or last item are all O(1).
 //
 #define ArrayPointerImpl_ClassName ArrayPointerQueue
 #define ArrayPointerImpl_Queue
@@ -61,7 +77,8 @@
 
 //
 //Keeps the array in sorted order to provide O(log(n)) searching.
-//Inserts and removes are still O(n).
+//Inserts and removes are still O(n).  AddBatch adds many items with one sort and one merge.
+//Large tables which rarely change can be frozen for faster searching, see Freeze, and ArrayFrozen.h.
 //
 #define ArrayPointerImpl_ClassName ArraySorted
 #define ArrayPointerImpl_Sorted
@@ -0,0 +1,157 @@
+//
+// v1 - Prototype character/item/tradeskill game.
+// Copyright (C) 2013 Adam Hayek (adam.hayek@gmail.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see [http://www.gnu.org/licenses/].
+//
+
+#pragma once
+
+#include <stddef.h>
+#include <iterator>
+#include "common\global\global.h"
+
+//
+//Helpers for walking the arrays without checking every index.  The arrays hand these out
+//from begin, end and Span.  They let hot loops skip the checks in Get, and let the standard
+//algorithms (std::sort, std::partition, std::for_each, ...) work directly on the arrays.
+//
+//Like the addresses returned by Get, they are only valid until the array is next changed.
+//In DEBUG, indexing out of range still breaks into the debugger.
+//
+
+//strips const from a type, so const iterators can report the right value_type.
+template <class T> struct ArrayNonConst { typedef T Type; };
+template <class T> struct ArrayNonConst<T const> { typedef T Type; };
+
+//
+//ArraySpan is a view of a contiguous run of items which it does not own.
+//
+//  ArraySpan<Foo *> span = array.Span();
+//  for (ArraySpan<Foo *>::iterator it = span.begin(); it != span.end(); ++it)
+//
+template <class T>
+class ArraySpan
+{
+public:
+    typedef T *iterator;
+    typedef T *const_iterator;
+    typedef typename ArrayNonConst<T>::Type value_type;
+
+    inline ArraySpan() : data(NULL), num(0) {}
+    inline ArraySpan(T *data, int32 num) : data(data), num(num) {}
+
+    //a span of non-const items can be used as a span of const items
+    template <class U>
+    inline ArraySpan(ArraySpan<U> const &other) : data(other.Data()), num(other.Num()) {}
+
+    //number of items
+    inline int32 Num() const { return num; }
+
+    //pointer to the first item
+    inline T *Data() const { return data; }
+
+    //item access without a range check
+    inline T &operator[](int32 index) const
+    {
+        #ifdef __CONFIG_DEBUG
+        if (index < 0 || index >= num) { BREAK1(); }
+        #endif
+        return data[index];
+    }
+
+    //iterators, for the standard algorithms
+    inline T *begin() const { return data; }
+    inline T *end() const { return data + num; }
+
+    //a view of count items starting at start, clipped to our items.
+    inline ArraySpan Sub(int32 start, int32 count) const
+    {
+        bound_var(start, 0, num);
+        bound_var(count, 0, num - start);
+        return ArraySpan(data + start, count);
+    }
+
+private:
+    //first item
+    T *data;
+
+    //number of items
+    int32 num;
+};
+
+//
+//ArrayRingIterator walks the items of a queue array, which are stored in a circular buffer
+//that may wrap around the end of its storage.  It is a standard random access iterator.
+//
+template <class T>
+class ArrayRingIterator
+{
+public:
+    typedef std::random_access_iterator_tag iterator_category;
+    typedef typename ArrayNonConst<T>::Type value_type;
+    typedef ptrdiff_t difference_type;
+    typedef T *pointer;
+    typedef T &reference;
+
+    inline ArrayRingIterator() : items(NULL), mask(0), first(0), index(0) {}
+
+    //storage is the queue's storage, whose length max must be a power of 2, first is the slot of
+    //item 0 and index is the item this iterator starts at.
+    inline ArrayRingIterator(T *storage, int32 max, int32 first, int32 index) : items(storage), mask(max - 1), first(first), index(index) {}
+
+    //an iterator of non-const items can be used as an iterator of const items
+    template <class U>
+    inline ArrayRingIterator(ArrayRingIterator<U> const &other) : items(other.items), mask(other.mask), first(other.first), index(other.index) {}
+
+    //item access
+    inline T &operator*() const { return items[(first + index) & mask]; }
+    inline T *operator->() const { return &items[(first + index) & mask]; }
+    inline T &operator[](difference_type offset) const { return items[(first + index + int32(offset)) & mask]; }
+
+    //movement
+    inline ArrayRingIterator &operator++() { index++; return *this; }
+    inline ArrayRingIterator &operator--() { index--; return *this; }
+    inline ArrayRingIterator operator++(int) { ArrayRingIterator old = *this; index++; return old; }
+    inline ArrayRingIterator operator--(int) { ArrayRingIterator old = *this; index--; return old; }
+    inline ArrayRingIterator &operator+=(difference_type offset) { index += int32(offset); return *this; }
+    inline ArrayRingIterator &operator-=(difference_type offset) { index -= int32(offset); return *this; }
+    inline ArrayRingIterator operator+(difference_type offset) const { ArrayRingIterator moved = *this; moved.index += int32(offset); return moved; }
+    inline ArrayRingIterator operator-(difference_type offset) const { ArrayRingIterator moved = *this; moved.index -= int32(offset); return moved; }
+    inline friend ArrayRingIterator operator+(difference_type offset, ArrayRingIterator const &it) { return it + offset; }
+
+    //distance and comparisons, only meaningful between iterators of the same array
+    inline difference_type operator-(ArrayRingIterator const &other) const { return index - other.index; }
+    inline bool operator==(ArrayRingIterator const &other) const { return index == other.index; }
+    inline bool operator!=(ArrayRingIterator const &other) const { return index != other.index; }
+    inline bool operator<(ArrayRingIterator const &other) const { return index < other.index; }
+    inline bool operator>(ArrayRingIterator const &other) const { return index > other.index; }
+    inline bool operator<=(ArrayRingIterator const &other) const { return index <= other.index; }
+    inline bool operator>=(ArrayRingIterator const &other) const { return index >= other.index; }
+
+private:
+    template <class U> friend class ArrayRingIterator;
+
+    //the circular buffer
+    T *items;
+
+    //length of the buffer minus 1, for wrapping slots
+    int32 mask;
+
+    //slot of item 0
+    int32 first;
+
+    //the item we are at
+    int32 index;
+};
@@ -0,0 +1,156 @@
+//
+// v1 - Prototype character/item/tradeskill game.
+// Copyright (C) 2013 Adam Hayek (adam.hayek@gmail.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see [http://www.gnu.org/licenses/].
+//
+
+#pragma once
+
+class Place;
+
+#include "common\global\global.h"
+
+//
+//Optional instrumentation of the arrays, to find the ones that resize too often or reserve far
+//more than they use.  Build with __CONFIG_ARRAY_STATS defined to turn it on.  Without it, the
+//arrays have no extra members and the hooks compile to nothing.
+//
+//Each array counts its resizes, the bytes it has allocated, its peak item count and capacity,
+//and how many items were added and removed.  Tag an array with the Place that owns it so the
+//report can say where it is:
+//
+//  ScreenTextImpl::ScreenTextImpl()
+//  {
+//      ARRAY_STATS_PLACE(topLeft);
+//  }
+//
+//The worst offenders are written to the debug output at TERM() time.  Arrays that are destroyed
+//before then are merged into one record per place and type, so short lived arrays still show up.
+//
+#if defined(__CONFIG_ARRAY_STATS)
+
+//the counts for an array, or for all the destroyed arrays of one place and type.
+struct ArrayStatsCounts
+{
+    //name of the array template and the Place tagged to it, if any
+    char const *typeName;
+    Place *place;
+
+    //bytes per slot
+    int32 itemSize;
+
+    //number of arrays counted
+    int32 instances;
+
+    //number of times the storage was reallocated, and the total bytes allocated by them
+    int32 resizes;
+    int64 bytesAllocated;
+
+    //the most items and the most slots the array ever had
+    int32 peakNum;
+    int32 peakMax;
+
+    //items added and removed
+    int64 adds;
+    int64 removes;
+};
+
+class ArrayStats
+{
+private:
+    ArrayStats(ArrayStats const &other);
+public:
+    ArrayStats(char const *typeName, int32 itemSize);
+    ~ArrayStats();
+
+    //tags the array with the place that owns it.
+    inline void SetPlace(Place &place);
+
+    //the storage was reallocated to newMax slots.
+    inline void Resized(int32 newMax);
+
+    //count items were added, and the array now has num items.
+    inline void Added(int32 num, int32 count = 1);
+
+    //count items were removed.
+    inline void Removed(int32 count = 1);
+
+    //writes the arrays with the most resizes and the most unused capacity to the debug output.
+    static void Report();
+
+private:
+    //our counts
+    ArrayStatsCounts counts;
+
+    //the list of live arrays
+    ArrayStats *prev;
+    ArrayStats *next;
+};
+
+//constructor initializer for an array's ArrayStats member, named after the array class
+#define ARRAY_STATS_INIT(className, itemSize) : stats(ARRAY_STATS_NAME(className), itemSize)
+#define ARRAY_STATS_NAME(className) ARRAY_STATS_NAME2(className)
+#define ARRAY_STATS_NAME2(className) #className
+
+//adds a statement to an array function which calls a function of its ArrayStats
+#define ARRAY_STATS(call) stats.call
+
+//tags an array with the place of the function this is used in
+#define ARRAY_STATS_PLACE(array) { HERE(); (array).StatsPlace(here__); }
+
+#else
+
+#define ARRAY_STATS_INIT(className, itemSize)
+#define ARRAY_STATS(call)
+#define ARRAY_STATS_PLACE(array)
+
+#endif
+
+
+#if defined(__CONFIG_ARRAY_STATS)
+//
+//ArrayStats inline functions
+//
+
+inline void ArrayStats::SetPlace(Place &place)
+{
+    counts.place = &place;
+}
+
+inline void ArrayStats::Resized(int32 newMax)
+{
+    //count it
+    counts.resizes++;
+    counts.bytesAllocated += int64(newMax) * counts.itemSize;
+
+    //remember the largest
+    bound_min(counts.peakMax, newMax);
+}
+
+inline void ArrayStats::Added(int32 num, int32 count)
+{
+    //count them
+    counts.adds += count;
+
+    //remember the most
+    bound_min(counts.peakNum, num);
+}
+
+inline void ArrayStats::Removed(int32 count)
+{
+    //count them
+    counts.removes += count;
+}
+#endif
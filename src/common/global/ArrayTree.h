@@ -0,0 +1,43 @@
+//
+// v1 - Prototype character/item/tradeskill game.
+// Copyright (C) 2013 Adam Hayek (adam.hayek@gmail.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see [http://www.gnu.org/licenses/].
+//
+
+#pragma once
+
+#include <stddef.h>
+#include <string.h>
+#include "common\global\global.h"
+
+//
+//ArrayTree keeps pointers to objects in sorted order like ArraySorted, and takes the same
+//CompareFunc and FindFunc callbacks, but keeps them in a B+tree so that Add and Remove are
+//O(log(n)) instead of O(n).  It also answers order statistic questions in O(log(n)): Get
+//returns the item at an index, and Rank returns how many items are before a given one.
+//Walk a range of items in order with LowerBound and the iterators.
+//
+//Use ArraySorted for small arrays or arrays that rarely change, since it is a single block of memory.
+//
+#define ArrayTreeImpl_ClassName ArrayTree
+#include "src\ArrayTreeImpl.h"
+
+//
+//ArrayTreeOwner differs from ArrayTree only in that it will delete
+//it's items on Empty and Reset, which become O(n).
+//
+#define ArrayTreeImpl_ClassName ArrayTreeOwner
+#define ArrayTreeImpl_Owner
+#include "src\ArrayTreeImpl.h"
@@ -0,0 +1,68 @@
+//
+// v1 - Prototype character/item/tradeskill game.
+// Copyright (C) 2013 Adam Hayek (adam.hayek@gmail.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see [http://www.gnu.org/licenses/].
+//
+
+#pragma once
+
+#include <new>
+#include <stdlib.h>
+#include <string.h>
+#include "common\global\global.h"
+#include "common\global\ArrayStats.h"
+#include "common\global\ArraySpan.h"
+
+//
+//ArrayValue is the value storing counterpart of ArrayPointer.  It holds objects
+//of its template parameter type directly in one contiguous block of memory, so
+//walking the array does not chase a pointer for every item, and adding an item
+//does not allocate it separately.  The storage will double in size every time it is filled up.
+//
+//Get returns the address of the item inside the array, so code using ArrayPointer can
+//usually switch over without changes.  That address is only valid until the array is
+//next changed.  Items are moved with memcpy, see src\ArrayValueImpl.h.
+//
+//Removal of an object from the array destroys it, and the gap is filled with the
+//item from the end of the array.  Removal is O(1).
+//
+#define ArrayValueImpl_ClassName ArrayValue
+#include "src\ArrayValueImpl.h"
+
+//
+//ArrayValueQueue preserves the order of items when calling Remove, which makes it O(n).
+//The items are kept in a circular buffer, so PushBack, PushFront, PopFront and removing
+//the first or last item are all O(1).
+//
+#define ArrayValueImpl_ClassName ArrayValueQueue
+#define ArrayValueImpl_Queue
+#include "src\ArrayValueImpl.h"
+
+//
+//Keeps the array in sorted order to provide O(log(n)) searching.
+//Inserts and removes are still O(n), but only move memory.
+//
+#define ArrayValueImpl_ClassName ArrayValueSorted
+#define ArrayValueImpl_Sorted
+#include "src\ArrayValueImpl.h"
+
+
+//
+//These macros will generate simple static Compare and Find functions that can be used in ArrayValueSorted.
+//The find function is the same as the one for the pointer arrays.
+//
+
+#define SortedValueArrayCompareFuncMember(funcName, Type, memberVar) static inline int32 funcName(Type const *left, Type const *right) { return ::CompareFunc(left->memberVar, right->memberVar); };
+#define SortedValueArrayFunctions(compareFuncName, findFuncName, _ItemType, _IDType, memberVar) SortedValueArrayCompareFuncMember(compareFuncName, _ItemType, memberVar) SortedArrayFindFuncMember(findFuncName, _IDType, _ItemType, memberVar)
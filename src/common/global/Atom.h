@@ -0,0 +1,150 @@
+//
+// v1 - Prototype character/item/tradeskill game.
+// Copyright (C) 2013 Adam Hayek (adam.hayek@gmail.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see [http://www.gnu.org/licenses/].
+//
+
+#pragma once
+
+#include "common\global\global.h"
+
+//
+//An Atom is a handle to a string in the global atom table, which keeps one copy of every string
+//interned in it, for names that are looked up and compared far more often than they are made:
+//interface names, asset paths, item and recipe identifiers.
+//
+//Two atoms are equal exactly when their strings are, so comparing them is one pointer compare.
+//The hash is computed once when the string is interned, so atoms are cheap keys for ArrayHashed.
+//The strings are never freed, so an atom and its Str stay valid for the rest of the program.
+//
+//Interning takes a lock and hashes the string, so intern names once, when the object that uses
+//them is made, and keep the atom.  Any thread may intern, and reading an atom needs no lock.
+//
+//  Atom name = Atom::Intern("IScreenText.default");
+//  if (name == other.name) ...
+//
+class Atom
+{
+public:
+    //the null atom, which is not equal to any interned string.  Its Str is "".
+    inline Atom();
+
+    //returns the atom of the given string, adding it to the table if it isn't there yet.
+    //NULL gives the null atom.
+    static Atom Intern(char const *str);
+
+    //returns the atom of the given string if it has been interned, or the null atom if it hasn't.
+    static Atom Find(char const *str);
+
+    //the string, never NULL
+    inline char const *Str() const;
+
+    //the number of characters in the string
+    inline int32 Length() const;
+
+    //the string's HashFunc, computed when it was interned
+    inline uint32 Hash() const;
+
+    //true for the null atom
+    inline bool IsNull() const;
+
+    //atoms are equal when their strings are.  The order is fixed for the life of the program but
+    //is not alphabetical.
+    inline bool operator==(Atom const &other) const;
+    inline bool operator!=(Atom const &other) const;
+    inline bool operator<(Atom const &other) const;
+    inline bool operator>(Atom const &other) const;
+
+    //number of strings in the table and the bytes they use, for memory reports
+    static int32 NumAtoms();
+    static int32 NumBytes();
+
+private:
+    //an interned string.  The characters follow the header in the same allocation.
+    class Entry
+    {
+    public:
+        uint32 hash;
+        int32 length;
+        char text[1];
+    };
+    friend class AtomTable;
+
+    inline explicit Atom(Entry const *entry);
+
+    //our string, or NULL for the null atom
+    Entry const *entry;
+};
+
+//atoms hash with their precomputed hash, so they can be ArrayHashed keys.
+inline uint32 HashFunc(Atom const value)
+{
+    return value.Hash();
+}
+
+
+//
+//Atom inline functions
+//
+
+inline Atom::Atom()
+{
+    entry = NULL;
+}
+
+inline Atom::Atom(Entry const *entry)
+{
+    this->entry = entry;
+}
+
+inline char const *Atom::Str() const
+{
+    return (entry != NULL) ? entry->text : "";
+}
+
+inline int32 Atom::Length() const
+{
+    return (entry != NULL) ? entry->length : 0;
+}
+
+inline uint32 Atom::Hash() const
+{
+    return (entry != NULL) ? entry->hash : 0;
+}
+
+inline bool Atom::IsNull() const
+{
+    return entry == NULL;
+}
+
+inline bool Atom::operator==(Atom const &other) const
+{
+    return entry == other.entry;
+}
+
+inline bool Atom::operator!=(Atom const &other) const
+{
+    return entry != other.entry;
+}
+
+inline bool Atom::operator<(Atom const &other) const
+{
+    return entry < other.entry;
+}
+
+inline bool Atom::operator>(Atom const &other) const
+{
+    return entry > other.entry;
+}
@@ -0,0 +1,207 @@
+//
+// v1 - Prototype character/item/tradeskill game.
+// Copyright (C) 2013 Adam Hayek (adam.hayek@gmail.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see [http://www.gnu.org/licenses/].
+//
+
+#pragma once
+
+class Place;
+
+#include "common\global\global.h"
+
+//
+//Optional call tree profiling, built on the contexts.  Build with __CONFIG_CALL_TREE defined to
+//turn it on.  Without it, contexts have no extra members and nothing here is compiled.
+//
+//Instrumented contexts read the cycle counter when they are made and destroyed, and their Place
+//totals the cycles of those calls.  With the call tree on, the cycles are also counted per
+//call path: each thread has a tree with a node for every chain of places from its root contexts
+//down, so a function called from two places has two nodes.  A node's inclusive cycles are the
+//time spent in its calls, and its exclusive cycles are that minus the time spent in the calls it
+//made, which are the inclusive cycles of its children.
+//
+//Only timed calls are counted in the trees, so a node of a sampled place counts 1 in its interval
+//of the calls, see CONTEXT_INSTRUMENT_SAMPLED.  Its cycles aren't scaled up like the place's are.
+//
+//Each thread builds its own tree, so counting takes no locks, and a context must only be used
+//by the thread which made it.  Nodes are never freed, so a reader can walk the trees while the
+//threads keep adding to them; the counts of a call that is still running aren't in yet.
+//
+//  for (CallTree *tree = CallTree::First(); tree != NULL; tree = tree->Next())
+//  {
+//      for (CallNode *node = tree->Root()->FirstChild(); node != NULL; node = node->NextSibling())
+//      ...
+//  }
+//
+//IProfiler writes the trees out as a Chrome trace, or as folded stacks for flame graphs.
+//
+#if defined(__CONFIG_CALL_TREE)
+
+//one call path, the place of a call and the node of its caller.
+class CallNode
+{
+    friend class CallTree;
+private:
+    CallNode(CallNode const &other);
+public:
+    //the node for a call to the given place from this node, made on the first such call
+    inline CallNode *Child(Place &place);
+
+    //counts a call which has finished
+    inline void Called(int64 cycles);
+
+    //the place of the call, or NULL for the root of a thread's tree
+    inline Place *Spot() const;
+
+    //the node of the caller, or NULL for the root
+    inline CallNode *Parent() const;
+
+    //the nodes of the calls this one made, in the order they were first made
+    inline CallNode *FirstChild() const;
+    inline CallNode *NextSibling() const;
+
+    //number of finished calls, and the cycles spent in them including the calls they made
+    inline int64 NumCalls() const;
+    inline int64 NumCycles() const;
+
+private:
+    CallNode(CallNode *parent, Place *place);
+
+    //finds or makes the child for the place, when it isn't the last one used
+    CallNode *FindChild(Place &place);
+
+    //where we are, and who called us
+    Place *place;
+    CallNode *parent;
+
+    //our children, in a list that readers can walk while we add to it
+    CallNode * volatile firstChild;
+    CallNode *lastChild;
+    CallNode * volatile nextSibling;
+
+    //the child we returned last, since calls usually repeat
+    CallNode *lastUsed;
+
+    //our counts
+    int64 numCalls;
+    int64 numCycles;
+};
+
+//the call tree of one thread
+class CallTree
+{
+private:
+    CallTree(CallTree const &other);
+public:
+    //the tree of the calling thread, made on its first call
+    static CallTree *Thread();
+
+    //the trees of every thread that has had a context, including threads which have finished
+    static CallTree *First();
+    inline CallTree *Next() const;
+
+    //the root of the tree, with no place of its own.  Its children are the root contexts.
+    inline CallNode *Root();
+
+    //the id of our thread
+    inline uint32 ThreadId() const;
+
+private:
+    CallTree(uint32 threadId);
+
+    //our root node
+    CallNode root;
+
+    //the thread we belong to
+    uint32 threadId;
+
+    //the list of every thread's tree
+    CallTree * volatile next;
+};
+
+
+//
+//CallNode inline functions
+//
+
+inline CallNode *CallNode::Child(Place &place)
+{
+    //loops call the same function over and over, so check the last one first
+    if (lastUsed != NULL && lastUsed->place == &place)
+    {
+        return lastUsed;
+    }
+    return FindChild(place);
+}
+
+inline void CallNode::Called(int64 cycles)
+{
+    //only our thread counts us
+    numCalls++;
+    numCycles += cycles;
+}
+
+inline Place *CallNode::Spot() const
+{
+    return place;
+}
+
+inline CallNode *CallNode::Parent() const
+{
+    return parent;
+}
+
+inline CallNode *CallNode::FirstChild() const
+{
+    return firstChild;
+}
+
+inline CallNode *CallNode::NextSibling() const
+{
+    return nextSibling;
+}
+
+inline int64 CallNode::NumCalls() const
+{
+    return numCalls;
+}
+
+inline int64 CallNode::NumCycles() const
+{
+    return numCycles;
+}
+
+
+//
+//CallTree inline functions
+//
+
+inline CallTree *CallTree::Next() const
+{
+    return next;
+}
+
+inline CallNode *CallTree::Root()
+{
+    return &root;
+}
+
+inline uint32 CallTree::ThreadId() const
+{
+    return threadId;
+}
+
+#endif
@@ -19,28 +19,148 @@
 #pragma once
 
 class Place;
+class PlaceCounters;
 class UserErrorStore;
 
 #include "common\global\global.h"
+#include "common\global\CallTree.h"
+
+//
+//How much the contexts measure.  An instrumented context reads the cycle counter when it is made
+//and destroyed, and counts the call and its cycles in its Place.  Each place has an interval: it
+//times 1 in that many calls, all of them at CONTEXT_INSTRUMENT_FULL, or none at
+//CONTEXT_INSTRUMENT_OFF, when it costs one compare.  Calls are counted unless the place is off.
+//
+//The build sets the interval places start with in __CONFIG_CONTEXT_INSTRUMENT.  Final builds
+//default to CONTEXT_INSTRUMENT_SAMPLED, so profiles can be taken from players' machines, and the
+//others to CONTEXT_INSTRUMENT_FULL.  A build which sets it to CONTEXT_INSTRUMENT_OFF compiles the
+//instrumentation out, and its contexts only link callers and carry user errors.
+//
+//Otherwise places can be changed while the game runs, one at a time with Place::Instrument, or
+//by a part of their function signature with ContextInstrument, which also changes places that
+//haven't been called yet.  The last rule that matches a place wins:
+//
+//  ContextInstrument("", 256);                                     //everything 1 in 256
+//  ContextInstrument("ScreenTextImpl::", CONTEXT_INSTRUMENT_FULL); //except the screen text
+//
+//The cycles of sampled places are scaled up by the calls that weren't timed, so they are estimates.
+//
+#define CONTEXT_INSTRUMENT_OFF 0
+#define CONTEXT_INSTRUMENT_FULL 1
+#define CONTEXT_INSTRUMENT_SAMPLED 64
+
+#if !defined(__CONFIG_CONTEXT_INSTRUMENT)
+    #if defined(__CONFIG_FINAL)
+        #define __CONFIG_CONTEXT_INSTRUMENT CONTEXT_INSTRUMENT_SAMPLED
+    #else
+        #define __CONFIG_CONTEXT_INSTRUMENT CONTEXT_INSTRUMENT_FULL
+    #endif
+#endif
+
+#if __CONFIG_CONTEXT_INSTRUMENT == CONTEXT_INSTRUMENT_OFF && defined(__CONFIG_CALL_TREE)
+    #error The call tree is built by instrumented contexts, __CONFIG_CONTEXT_INSTRUMENT can't be off.
+#endif
+
+//sets the interval of every place whose function signature contains match, and of the places
+//which are called later that do.  "" matches them all.  match must stay valid for the rest of
+//the program, a string literal is best.  Does nothing in builds which are off.
+void ContextInstrument(char const *match, int32 interval);
 
 //A place in code, usually a function.  
 //These objects will normally be statically allocated so they can collect profiling information
 //for the entire execution of the program.
+//
+//The counts are kept by each thread separately, in its PlaceCounters, so threads running the same
+//function never write the same memory and counting needs no interlocked instructions.  Reading a
+//count adds up every thread's, which is slow, and is only exact once the threads are done.
 class Place
 {
-    friend class Context;
+    friend class PlaceCounters;
 public:
     inline Place(char const *functionSignature);
 
+    //the function signature of this place
+    inline char const *Description() const;
+
+    //number of calls, and the clock cycles spent in them, on every thread.  The cycles of a sampled
+    //place are an estimate.
+    int64 NumCalls() const;
+    int64 NumCycles() const;
+
+    //times 1 in interval calls from now on, see CONTEXT_INSTRUMENT_OFF
+    inline void Instrument(int32 interval);
+    inline int32 Instrumented() const;
+
 private:
-    //description of this place
-    buffer256 description;
+    friend class Context;
+
+    //adds us to the places ContextInstrument changes
+    void Made();
+
+    //description of this place, the compiler's function signature string, which lives for the whole program
+    char const *description;
+
+    //we time 1 in this many calls
+    int32 volatile interval;
 
-    //number of times this function was called
+    //where our counts are in every thread's PlaceCounters, given out on our first call, or 0 before then
+    long volatile index;
+};
+
+//the counts of one place on one thread
+class PlaceCount
+{
+public:
+    //number of times the function was called, and how many of those were timed
     int64 numCalls;
+    int64 numTimed;
 
-    //how many clock cycles were spent in this function
+    //how many clock cycles were spent in the timed calls
     int64 numCycles;
+
+    //calls until the next one is timed
+    int32 countdown;
+};
+
+//number of counts in each page of a thread's PlaceCounters, and the most pages it can have
+#define PLACE_COUNTER_PAGE_BITS 8
+#define PLACE_COUNTER_PAGE_SIZE (1 << PLACE_COUNTER_PAGE_BITS)
+#define PLACE_COUNTER_PAGES 256
+
+//one thread's counts of every place.  They are in pages which are never moved or freed, so
+//other threads can add them up while the thread keeps counting.
+class PlaceCounters
+{
+private:
+    PlaceCounters(PlaceCounters const &other);
+public:
+    //the counters of the calling thread, made on its first call
+    static PlaceCounters *Thread();
+
+    //the counters of every thread that has had a context, including threads which have finished
+    static PlaceCounters *First();
+    inline PlaceCounters *Next() const;
+
+    //our counts of the given place.  Only our thread may call this.
+    inline PlaceCount &Get(Place &place);
+
+    //our counts of the given place if we have any, for adding them up
+    PlaceCount const *Find(Place const &place) const;
+
+private:
+    PlaceCounters();
+
+    //gives the place its index if it doesn't have one, and makes the page for it
+    PlaceCount &Make(Place &place);
+
+    //our pages of counts, made as places are first called
+    PlaceCount * volatile pages[PLACE_COUNTER_PAGES];
+
+    //where places past the last page count, so they don't crash
+    PlaceCount overflow;
+
+    //the list of every thread's counters
+    PlaceCounters * volatile next;
 };
 
 #define HERE() static Place here__(__FUNCSIG__);
@@ -83,8 +203,10 @@ public:
     //clear the user error state
     inline void UserErrorClear();
 
-    //number of clock cycles spent in our last sub context
+#if __CONFIG_CONTEXT_INSTRUMENT != CONTEXT_INSTRUMENT_OFF
+    //number of clock cycles spent in our last sub context which was timed
     int64 lastCallNumCycles;
+#endif
 
 protected:
     inline Context();
@@ -98,9 +220,23 @@ protected:
     //the user error object available to this context, if any
     UserErrorStore *userError;
 
+#if __CONFIG_CONTEXT_INSTRUMENT != CONTEXT_INSTRUMENT_OFF
     //clock cycle when we entered this context
     int64 clockStart;
 
+    //the counters of our thread, and our place's count in them if this call is timed
+    PlaceCounters *counters;
+    PlaceCount *timedCount;
+#endif
+
+#if defined(__CONFIG_CALL_TREE)
+    //our call path in the thread's call tree
+    CallNode *node;
+#endif
+
+    //counts the call, and starts timing it if it's the place's turn
+    inline void Begin();
+
     //get clock cycle number right now.
     inline void GetClock(int64 &dest);
 };
@@ -125,8 +261,8 @@ public:
     inline ThreadRootContext(Context &threadCreator);
 
 private:
-    //call stack of our creator, in reverse order.
-    ArrayPointer<Place> stack;
+    //call stack of our creator, in reverse order.  Call stacks are rarely deeper than this.
+    ArrayPointerInline<Place, 16> stack;
 };
 
 //
@@ -160,13 +296,56 @@ ThreadRootContext::ThreadRootContext(Context &threadCreator)
 
 inline Place::Place(char const *functionSignature)
 {
-    //unmangle the function name and store it
-    //__unDName((char *)&this->description, decoratedFunctionName, (int)sizeof(this->description), UNDNAME_COMPLETE);
+    //the signature is a string literal, so we keep a pointer to it instead of a copy
     this->description = functionSignature;
 
-    //initialize
-    numCalls = 0;
-    numCycles = 0;
+    //we get our index when we are first called, and start with the build's instrumentation
+    index = 0;
+    interval = __CONFIG_CONTEXT_INSTRUMENT;
+
+#if __CONFIG_CONTEXT_INSTRUMENT != CONTEXT_INSTRUMENT_OFF
+    //let ContextInstrument find us
+    Made();
+#endif
+}
+
+inline char const *Place::Description() const
+{
+    return description;
+}
+
+inline void Place::Instrument(int32 interval)
+{
+    //each thread finishes the countdown it's on, then counts down the new interval
+    bound_min(interval, CONTEXT_INSTRUMENT_OFF);
+    this->interval = interval;
+}
+
+inline int32 Place::Instrumented() const
+{
+    return interval;
+}
+
+
+//
+//PlaceCounters inline functions
+//
+
+inline PlaceCounters *PlaceCounters::Next() const
+{
+    return next;
+}
+
+inline PlaceCount &PlaceCounters::Get(Place &place)
+{
+    //the page and the count in it.  Index 0 is never given out, so a place without one goes to Make.
+    int32 index = place.index;
+    PlaceCount *page = pages[uint32(index) >> PLACE_COUNTER_PAGE_BITS];
+    if (index == 0 || page == null)
+    {
+        return Make(place);
+    }
+    return page[index & (PLACE_COUNTER_PAGE_SIZE - 1)];
 }
 
 
@@ -189,24 +368,22 @@ inline Context::Context(Context *caller, Place &place)
     //save parameters
     this->caller = caller;
     this->place = &place;
-    this->lastCallNumCycles = 0;
 
     //get user error from caller context
     userError = (caller == null) ? null : caller->userError;
 
-    //get current clock cycle
-    GetClock(clockStart);
+    //count and time the call
+    Begin();
 }
 
 inline Context::Context(Context *caller, Place &place, UserErrorStore *userError)
 {
     this->caller = caller;
     this->place = &place;
-    this->lastCallNumCycles = 0;
     this->userError = userError;
 
-    //get current clock cycle
-    GetClock(clockStart);
+    //count and time the call
+    Begin();
 }
 
 inline Context::Context()
@@ -214,14 +391,68 @@ inline Context::Context()
     //save parameters
     caller = null;
     place = null;
+    userError = null;
+
+#if __CONFIG_CONTEXT_INSTRUMENT != CONTEXT_INSTRUMENT_OFF
+    //we have no place, so we count nothing, but the contexts under us get our counters
     lastCallNumCycles = 0;
+    counters = PlaceCounters::Thread();
+    timedCount = null;
+    clockStart = 0;
+#endif
+
+#if defined(__CONFIG_CALL_TREE)
+    //we have no place, so the contexts under us are at the root of the thread's tree
+    node = CallTree::Thread()->Root();
+#endif
+}
 
-    //get current clock cycle
-    GetClock(clockStart);
+inline void Context::Begin()
+{
+#if __CONFIG_CONTEXT_INSTRUMENT != CONTEXT_INSTRUMENT_OFF
+    lastCallNumCycles = 0;
+    timedCount = null;
+
+    //count on our thread's counters, which our caller already has unless we are the first
+    counters = (caller != null) ? caller->counters : PlaceCounters::Thread();
+
+#if defined(__CONFIG_CALL_TREE)
+    //our path is under our caller's, or under our thread's root if we are one
+    node = (caller != null) ? caller->node->Child(*place) : CallTree::Thread()->Root()->Child(*place);
+#endif
+
+    //places which are off cost only this
+    int32 interval = place->interval;
+    if (interval == CONTEXT_INSTRUMENT_OFF)
+    {
+        return;
+    }
+
+    //count the call
+    PlaceCount &count = counters->Get(*place);
+    count.numCalls++;
+
+    //time it if it's this place's turn on our thread
+    if (--count.countdown <= 0)
+    {
+        count.countdown = interval;
+        timedCount = &count;
+
+        //get current clock cycle
+        GetClock(clockStart);
+    }
+#endif
 }
 
 inline Context::~Context()
 {
+#if __CONFIG_CONTEXT_INSTRUMENT != CONTEXT_INSTRUMENT_OFF
+    //only timed calls have anything left to count
+    if (timedCount == null)
+    {
+        return;
+    }
+
     //current clock 
     int64 now;
 
@@ -231,11 +462,14 @@ inline Context::~Context()
     //get number of cycles that have elapsed
     int64 elapsedCycles = now - clockStart;
 
-    //add the cycles to the place's total
-    place->numCycles += elapsedCycles;
+    //add the cycles to our thread's count of the place
+    timedCount->numCycles += elapsedCycles;
+    timedCount->numTimed++;
 
-    //increment our place's call count
-    place->numCalls++;
+#if defined(__CONFIG_CALL_TREE)
+    //and our call path's
+    node->Called(elapsedCycles);
+#endif
 
     //check if we have a caller
     if (caller != null)
@@ -243,6 +477,7 @@ inline Context::~Context()
         //set our cycle count into our caller
         caller->lastCallNumCycles = elapsedCycles;
     }
+#endif
 }
 
 inline const Context *Context::Caller() const
@@ -29,6 +29,9 @@ class ManagerStatic;
 
 class ManagerObject;
 
+//the type of the function a DLL exports to move its items into the loading module's manager.
+typedef void (*ManagerTransferFunc)(ManagerObject *manager);
+
 //
 //ManagerStatic is the base class of the type which is responsible for allocating
 //the ManagerObject instances, keeping track of ManagerObject reference counts, and
@@ -102,6 +105,10 @@ public:
     static void RemoveObject(void *object);
     static void TransferTo(ObjectType *manager);
 
+    //moves the items of a loaded DLL into our manager, by calling the function the DLL exports
+    //with ManagerExportTransfer.
+    static void TransferFromDLL(void *dllHandle, const char *transferFuncName);
+
     //gets the full manager object instance in which this module's items currently reside.
     static ObjectType *GetManager();
 
@@ -203,6 +210,19 @@ void ManagerStaticImpl<StaticType, ObjectType>::TransferTo(ObjectType *manager)
     instance->ManagerStatic::TransferTo(manager);
 }
 
+template <class StaticType, class ObjectType>
+void ManagerStaticImpl<StaticType, ObjectType>::TransferFromDLL(void *dllHandle, const char *transferFuncName)
+{
+    IFASSERTRETURN(dllHandle == NULL || transferFuncName == NULL);
+
+    //get module instance (or create if its not already done)
+    ManagerStaticImpl<StaticType, ObjectType> *instance = GetInstance();
+    IFASSERTRETURN(instance == NULL);
+
+    //call transfer function in instance.
+    instance->ManagerStatic::TransferFromDLL(dllHandle, transferFuncName);
+}
+
 template <class StaticType, class ObjectType>
 ManagerObject *ManagerStaticImpl<StaticType, ObjectType>::CreateManager()
 {
@@ -210,3 +230,13 @@ ManagerObject *ManagerStaticImpl<StaticType, ObjectType>::CreateManager()
     return ((StaticType *)this)->Create();
 }
 
+
+//
+//Exports the function a DLL's manager uses to move its items into the manager of the module that
+//loads it.  Every module compiles it, so the loading module can find it by name with TransferFromDLL.
+//
+#define ManagerExportTransfer(StaticType, ObjectType, funcName) \
+    extern "C" __declspec(dllexport) void funcName(ManagerObject *manager) \
+    { \
+        StaticType::TransferTo((ObjectType *)manager); \
+    }
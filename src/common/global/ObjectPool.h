@@ -0,0 +1,401 @@
+//
+// v1 - Prototype character/item/tradeskill game.
+// Copyright (C) 2013 Adam Hayek (adam.hayek@gmail.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see [http://www.gnu.org/licenses/].
+//
+
+#pragma once
+
+#include <new>
+#include "common\global\global.h"
+#include "common\global\SpinLock.h"
+
+//
+//ObjectPool hands out objects of its template parameter type from slabs of memory which
+//are allocated objectsPerSlab at a time and never freed until the pool is destroyed.  Free slots
+//are kept in a linked list which is stored inside the free slots themselves, so Acquire and Release
+//are O(1) and only touch the heap when a new slab is needed.
+//
+//Objects are default constructed by Acquire and destroyed by Release, just like new and delete.
+//
+//The pool may be used from many threads.  Acquire and Release take a spin lock.  A thread which
+//acquires and releases many objects can use an ObjectPool::Cache, which keeps a private list of free
+//slots and only takes the lock to move a batch of slots to or from the pool.
+//
+template <class T>
+class ObjectPool
+{
+private:
+    ObjectPool(ObjectPool const &other);
+public:
+    class Cache;
+
+    ObjectPool(int32 objectsPerSlab = 64);
+    ~ObjectPool();
+
+    //constructs an object in a free slot and returns it.
+    T *Acquire();
+
+    //destroys an object which came from this pool and frees its slot.
+    void Release(T *object);
+
+    //
+    //statistics
+    //
+public:
+    //number of slots currently handed out, to callers or to caches.
+    int32 NumInUse() const;
+
+    //the most slots that have been handed out at once.
+    int32 HighWater() const;
+
+    //number of slabs allocated
+    int32 NumSlabs() const;
+
+    //total number of slots in all slabs
+    int32 NumSlots() const;
+
+    //total number of times a slot has been handed out
+    int64 NumAcquired() const;
+
+private:
+    //one slot in a slab
+    union Slot
+    {
+        //next free slot, while this slot is free
+        Slot *next;
+
+        //storage for the object, while this slot is in use
+        uint8 object[sizeof(T)];
+
+        //these make the slot aligned for any object
+        int64 alignInt;
+        double alignDouble;
+    };
+
+    //takes up to count slots from the free list and links them into a list.  Returns the number taken.
+    //must be called with the lock held.
+    int32 TakeSlots(Slot *&list, int32 count);
+
+    //puts a linked list of slots back on the free list.  Must be called with the lock held.
+    void GiveSlots(Slot *list, Slot *last, int32 count);
+
+    //allocates a new slab and adds all its slots to the free list.  Must be called with the lock held.
+    bool AddSlab();
+
+    //number of objects in each slab
+    int32 objectsPerSlab;
+
+    //first free slot
+    Slot *freeList;
+
+    //all the slabs we've allocated
+    ArrayPointer<Slot> slabs;
+
+    //statistics
+    int32 numInUse;
+    int32 highWater;
+    int64 numAcquired;
+
+    //protects all of the above
+    SpinLock lock;
+};
+
+//
+//A thread's private front end to an ObjectPool.  It must only be used by one thread at a time.
+//
+template <class T>
+class ObjectPool<T>::Cache
+{
+private:
+    Cache(Cache const &other);
+public:
+    Cache(ObjectPool<T> &pool, int32 batchSize = 32);
+    ~Cache();
+
+    //same as the ObjectPool functions, but only take the pool's lock once per batch.
+    T *Acquire();
+    void Release(T *object);
+
+private:
+    //the pool we get slots from
+    ObjectPool<T> *pool;
+
+    //our private free list
+    Slot *freeList;
+    int32 numFree;
+
+    //how many slots we move to or from the pool at once
+    int32 batchSize;
+};
+
+
+//
+//ObjectPool template functions
+//
+
+template <class T>
+ObjectPool<T>::ObjectPool(int32 objectsPerSlab)
+{
+    //save parameters
+    this->objectsPerSlab = max(objectsPerSlab, 1);
+
+    //we have no slots yet
+    freeList = NULL;
+
+    //no statistics yet
+    numInUse = 0;
+    highWater = 0;
+    numAcquired = 0;
+}
+
+template <class T>
+ObjectPool<T>::~ObjectPool()
+{
+    //every object should have been released
+    if (numInUse != 0)
+    {
+        BREAK1();
+    }
+
+    //free the slabs
+    while (slabs.Num() > 0)
+    {
+        //remove one
+        Slot *slab = slabs.Remove(slabs.Num() - 1);
+
+        //free it
+        delete [] slab;
+    }
+}
+
+template <class T>
+T *ObjectPool<T>::Acquire()
+{
+    //the slot we take
+    Slot *slot = NULL;
+
+    //take it from the free list while we have the lock
+    {
+        SpinLockScope scope(lock);
+        IFBREAKNULL(TakeSlots(slot, 1) != 1);
+    }
+
+    //construct the object in the slot
+    return new (slot->object) T();
+}
+
+template <class T>
+void ObjectPool<T>::Release(T *object)
+{
+    IFBREAKRETURN(object == NULL);
+
+    //destroy the object
+    object->~T();
+
+    //its slot is free
+    Slot *slot = (Slot *)object;
+
+    //put it back on the free list while we have the lock
+    SpinLockScope scope(lock);
+    GiveSlots(slot, slot, 1);
+}
+
+template <class T>
+int32 ObjectPool<T>::TakeSlots(Slot *&list, int32 count)
+{
+    //the number we took so far
+    int32 taken = 0;
+
+    //take slots from the front of the free list
+    list = NULL;
+    while (taken < count)
+    {
+        //check if we need a new slab
+        if (freeList == NULL)
+        {
+            IFBREAKBREAK(AddSlab() == false);
+        }
+
+        //move the first free slot to the list
+        Slot *slot = freeList;
+        freeList = slot->next;
+        slot->next = list;
+        list = slot;
+        taken++;
+    }
+
+    //update statistics
+    numInUse += taken;
+    numAcquired += taken;
+    bound_min(highWater, numInUse);
+
+    //return how many we took
+    return taken;
+}
+
+template <class T>
+void ObjectPool<T>::GiveSlots(Slot *list, Slot *last, int32 count)
+{
+    //put the list at the front of the free list, so the most recently used memory is used next
+    last->next = freeList;
+    freeList = list;
+
+    //update statistics
+    numInUse -= count;
+}
+
+template <class T>
+bool ObjectPool<T>::AddSlab()
+{
+    //allocate the slab
+    Slot *slab = new Slot[objectsPerSlab];
+    IFBREAKFALSE(slab == NULL);
+
+    //remember it so we can free it
+    slabs.Add(slab);
+
+    //link its slots onto the free list, in order so they are handed out in order
+    for (int32 i = objectsPerSlab - 1; i >= 0; i--)
+    {
+        slab[i].next = freeList;
+        freeList = &slab[i];
+    }
+
+    //success
+    return true;
+}
+
+template <class T>
+int32 ObjectPool<T>::NumInUse() const
+{
+    return numInUse;
+}
+
+template <class T>
+int32 ObjectPool<T>::HighWater() const
+{
+    return highWater;
+}
+
+template <class T>
+int32 ObjectPool<T>::NumSlabs() const
+{
+    return slabs.Num();
+}
+
+template <class T>
+int32 ObjectPool<T>::NumSlots() const
+{
+    return slabs.Num() * objectsPerSlab;
+}
+
+template <class T>
+int64 ObjectPool<T>::NumAcquired() const
+{
+    return numAcquired;
+}
+
+
+//
+//ObjectPool::Cache template functions
+//
+
+template <class T>
+ObjectPool<T>::Cache::Cache(ObjectPool<T> &pool, int32 batchSize)
+{
+    //save parameters
+    this->pool = &pool;
+    this->batchSize = max(batchSize, 1);
+
+    //we have no slots yet
+    freeList = NULL;
+    numFree = 0;
+}
+
+template <class T>
+ObjectPool<T>::Cache::~Cache()
+{
+    //check if we have any slots to give back
+    if (freeList == NULL)
+    {
+        return;
+    }
+
+    //find the end of our list
+    Slot *last = freeList;
+    while (last->next != NULL)
+    {
+        last = last->next;
+    }
+
+    //give them all back to the pool
+    SpinLockScope scope(pool->lock);
+    pool->GiveSlots(freeList, last, numFree);
+}
+
+template <class T>
+T *ObjectPool<T>::Cache::Acquire()
+{
+    //check if we need more slots
+    if (freeList == NULL)
+    {
+        //get a batch from the pool
+        SpinLockScope scope(pool->lock);
+        numFree = pool->TakeSlots(freeList, batchSize);
+        IFBREAKNULL(numFree < 1);
+    }
+
+    //take our first free slot
+    Slot *slot = freeList;
+    freeList = slot->next;
+    numFree--;
+
+    //construct the object in the slot
+    return new (slot->object) T();
+}
+
+template <class T>
+void ObjectPool<T>::Cache::Release(T *object)
+{
+    IFBREAKRETURN(object == NULL);
+
+    //destroy the object
+    object->~T();
+
+    //put its slot on our free list
+    Slot *slot = (Slot *)object;
+    slot->next = freeList;
+    freeList = slot;
+    numFree++;
+
+    //check if we are holding on to too many
+    if (numFree >= batchSize * 2)
+    {
+        //split off a batch to give back
+        Slot *list = freeList;
+        Slot *last = freeList;
+        for (int32 i = 1; i < batchSize; i++)
+        {
+            last = last->next;
+        }
+        freeList = last->next;
+        numFree -= batchSize;
+
+        //give it back to the pool
+        SpinLockScope scope(pool->lock);
+        pool->GiveSlots(list, last, batchSize);
+    }
+}
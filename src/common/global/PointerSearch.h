@@ -0,0 +1,59 @@
+//
+// v1 - Prototype character/item/tradeskill game.
+// Copyright (C) 2013 Adam Hayek (adam.hayek@gmail.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see [http://www.gnu.org/licenses/].
+//
+
+#pragma once
+
+#include "common\global\global.h"
+
+//
+//Linear search for a pointer in an array of pointers, used by the pointer arrays' IndexOf,
+//Contains and Remove.  Short arrays are searched with a plain loop.  Longer ones are compared 16
+//bytes of pointers per instruction with SSE2, which every PC we run on has.  Other platforms
+//always use the loop.
+//
+
+//arrays shorter than this are searched with the plain loop, where the call and setup cost more
+//than they save.  This is where the vector search started to win in TestPointerSearch, which
+//reports the crossover of the build it runs in.
+#define POINTER_SEARCH_MIN_VECTOR 16
+
+//searches with vector instructions, returns the index of the first match or -1.  Use PointerSearch instead.
+int32 PointerSearchVector(void const *const *pointers, int32 count, void const *value);
+
+//returns the index of the first pointer equal to value, or -1 if there is none.
+inline int32 PointerSearch(void const *const *pointers, int32 count, void const *value)
+{
+    //check if it's worth using the vector search
+    if (count >= POINTER_SEARCH_MIN_VECTOR)
+    {
+        return PointerSearchVector(pointers, count, value);
+    }
+
+    //search through the pointers
+    for (int32 i = 0; i < count; i++)
+    {
+        //check if it is here
+        if (pointers[i] == value)
+        {
+            return i;
+        }
+    }
+
+    //never found it
+    return -1;
+}
@@ -0,0 +1,393 @@
+//
+// v1 - Prototype character/item/tradeskill game.
+// Copyright (C) 2013 Adam Hayek (adam.hayek@gmail.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see [http://www.gnu.org/licenses/].
+//
+
+#pragma once
+
+#include "common\global\global.h"
+
+//
+//SlotMap stores objects of its template parameter type and hands out handles to them.
+//A handle stays valid until its object is removed, after which it will never find
+//anything again, even if the memory or the slot is reused.  Add, Remove and Get are O(1).
+//
+//The objects themselves are kept packed together in an ArrayValue, so walking every
+//object with Num and GetAt is as fast as walking an array.  Removing an object moves the
+//last object into its place, so the order of objects is not preserved, and addresses returned
+//by Get and GetAt are only valid until the map is next changed.  Hold on to handles instead.
+//
+//The handle type is uint32 or uint64.  The low bits of a handle are the index of its slot, and
+//the high bits are the generation of the slot, which goes up every time an object is put in the
+//slot and every time it's removed, so it's odd while the slot is in use and even while it's free.
+//A slot whose generations have run out is retired instead of reused, so an old handle can never
+//match again.
+//  - uint32 handles allow 1M objects at once, and a slot holds 2048 objects before it's retired.
+//  - uint64 handles allow 2G objects at once, and a slot holds 2G objects.
+//A handle of 0 is never handed out, so it can be used as a null handle.
+//
+template <class T, class H = uint32>
+class SlotMap
+{
+private:
+    SlotMap(SlotMap const &other);
+public:
+    typedef H Handle;
+
+    SlotMap();
+
+    //
+    //handle access
+    //
+public:
+    //adds a copy of an item and returns its handle, or 0 if the map is full.
+    Handle Add(T const &item);
+
+    //adds a default constructed item, sets its handle and returns its address.  Returns NULL if the map is full.
+    T *AddNew(Handle &handle);
+
+    //removes the item with the given handle, destroying it.  Returns false if there was no such item.
+    bool Remove(Handle handle);
+
+    //returns the item with the given handle, or NULL if it was removed.
+    inline T *Get(Handle handle);
+    inline T const *Get(Handle handle) const;
+
+    //returns true if the handle's item has not been removed.
+    inline bool Contains(Handle handle) const;
+
+    //
+    //dense access, for walking all the items.
+    //
+public:
+    //number of items in the map.
+    inline int32 Num() const;
+
+    //the item at the given index, from 0 to Num() - 1.
+    inline T *GetAt(int32 index);
+    inline T const *GetAt(int32 index) const;
+
+    //the handle of the item at the given index.
+    inline Handle HandleAt(int32 index) const;
+
+    //
+    //Functions to clear the map.  All handles handed out become invalid.
+    //
+public:
+    //destroy all items and free storage space.
+    void Reset();
+
+    //destroy all items without freeing storage space.
+    void Empty();
+
+private:
+    enum
+    {
+        //number of handle bits used for the slot index, the rest are the generation.
+        IndexBits = (sizeof(H) == 4 ? 20 : 31)
+    };
+
+    //one entry for each handle index that has ever been used
+    struct Slot
+    {
+        //generation of the item in this slot, odd, or even if the slot is free.
+        uint32 generation;
+
+        //index of our item in the items array, or the next free slot if we are free.
+        int32 index;
+    };
+
+    //helper functions to pack and unpack handles
+    static inline Handle MakeHandle(int32 slotIndex, uint32 generation);
+    static inline int32 HandleIndex(Handle handle);
+    static inline uint32 HandleGeneration(Handle handle);
+
+    //returns the slot for the handle if it is still valid.
+    inline Slot const *FindSlot(Handle handle) const;
+
+    //gets a free slot and points it at the end of the items array, returns the new item's handle, or 0 if we are full.
+    Handle TakeSlot();
+
+    //frees the given slot, so that handles to it will no longer match, and retires it if it has no generations left.
+    void FreeSlot(int32 slotIndex);
+
+    //our items, packed together
+    ArrayValue<T> items;
+
+    //slot index of each item in items
+    ArrayValue<int32> itemSlots;
+
+    //all the slots
+    ArrayValue<Slot> slots;
+
+    //first free slot, or -1 if there are none.
+    int32 firstFree;
+};
+
+
+//
+//SlotMap template functions
+//
+
+template <class T, class H>
+SlotMap<T, H>::SlotMap()
+{
+    //no free slots yet
+    firstFree = -1;
+}
+
+template <class T, class H>
+typename SlotMap<T, H>::Handle SlotMap<T, H>::Add(T const &item)
+{
+    //get a slot for it
+    Handle handle = TakeSlot();
+    IFBREAKRETURNVAL(handle == 0, 0);
+
+    //add the item and the index of its slot
+    items.Add(item);
+    itemSlots.Add(HandleIndex(handle));
+
+    //return the handle
+    return handle;
+}
+
+template <class T, class H>
+T *SlotMap<T, H>::AddNew(Handle &handle)
+{
+    //get a slot for it
+    handle = TakeSlot();
+    IFBREAKNULL(handle == 0);
+
+    //add the index of its slot
+    itemSlots.Add(HandleIndex(handle));
+
+    //add the item
+    return items.AddNew();
+}
+
+template <class T, class H>
+bool SlotMap<T, H>::Remove(Handle handle)
+{
+    //check the handle
+    Slot const *slot = FindSlot(handle);
+    if (slot == NULL)
+    {
+        return false;
+    }
+
+    //where the item is
+    int32 index = slot->index;
+
+    //remove it, and the last item is moved into its place
+    items.Remove(index);
+    itemSlots.Remove(index);
+
+    //check if an item was moved
+    if (index < items.Num())
+    {
+        //the moved item's slot needs to know where it went
+        slots.Get(*itemSlots.Get(index))->index = index;
+    }
+
+    //free its slot
+    FreeSlot(HandleIndex(handle));
+
+    //success
+    return true;
+}
+
+template <class T, class H>
+inline T *SlotMap<T, H>::Get(Handle handle)
+{
+    //check the handle
+    Slot const *slot = FindSlot(handle);
+    if (slot == NULL)
+    {
+        return NULL;
+    }
+
+    //return the item
+    return items.Get(slot->index);
+}
+
+template <class T, class H>
+inline T const *SlotMap<T, H>::Get(Handle handle) const
+{
+    //check the handle
+    Slot const *slot = FindSlot(handle);
+    if (slot == NULL)
+    {
+        return NULL;
+    }
+
+    //return the item
+    return items.Get(slot->index);
+}
+
+template <class T, class H>
+inline bool SlotMap<T, H>::Contains(Handle handle) const
+{
+    return FindSlot(handle) != NULL;
+}
+
+template <class T, class H>
+inline int32 SlotMap<T, H>::Num() const
+{
+    return items.Num();
+}
+
+template <class T, class H>
+inline T *SlotMap<T, H>::GetAt(int32 index)
+{
+    return items.Get(index);
+}
+
+template <class T, class H>
+inline T const *SlotMap<T, H>::GetAt(int32 index) const
+{
+    return items.Get(index);
+}
+
+template <class T, class H>
+inline typename SlotMap<T, H>::Handle SlotMap<T, H>::HandleAt(int32 index) const
+{
+    IFBREAKRETURNVAL(index < 0 || index >= itemSlots.Num(), 0);
+
+    //build the handle from the item's slot
+    int32 slotIndex = *itemSlots.Get(index);
+    return MakeHandle(slotIndex, slots.Get(slotIndex)->generation);
+}
+
+template <class T, class H>
+void SlotMap<T, H>::Reset()
+{
+    //destroy the items
+    Empty();
+
+    //free all storage.  The slots are kept so that old handles can never match again.
+    items.Reset();
+    itemSlots.Reset();
+}
+
+template <class T, class H>
+void SlotMap<T, H>::Empty()
+{
+    //free the slot of each item, so their handles no longer match
+    for (int32 index = 0; index < itemSlots.Num(); index++)
+    {
+        FreeSlot(*itemSlots.Get(index));
+    }
+
+    //destroy the items
+    items.Empty();
+    itemSlots.Empty();
+}
+
+template <class T, class H>
+inline typename SlotMap<T, H>::Handle SlotMap<T, H>::MakeHandle(int32 slotIndex, uint32 generation)
+{
+    return (Handle(generation) << IndexBits) | Handle(slotIndex);
+}
+
+template <class T, class H>
+inline int32 SlotMap<T, H>::HandleIndex(Handle handle)
+{
+    return int32(handle & ((Handle(1) << IndexBits) - 1));
+}
+
+template <class T, class H>
+inline uint32 SlotMap<T, H>::HandleGeneration(Handle handle)
+{
+    return uint32(handle >> IndexBits);
+}
+
+template <class T, class H>
+inline typename SlotMap<T, H>::Slot const *SlotMap<T, H>::FindSlot(Handle handle) const
+{
+    //check the index
+    int32 slotIndex = HandleIndex(handle);
+    if (slotIndex >= slots.Num())
+    {
+        return NULL;
+    }
+
+    //check the slot is in use, its index is a free list link otherwise, and that the generation matches
+    Slot const *slot = slots.Get(slotIndex);
+    if ((slot->generation & 1) == 0 || slot->generation != HandleGeneration(handle))
+    {
+        return NULL;
+    }
+
+    //found it
+    return slot;
+}
+
+template <class T, class H>
+typename SlotMap<T, H>::Handle SlotMap<T, H>::TakeSlot()
+{
+    //the slot we use
+    int32 slotIndex = firstFree;
+    Slot *slot = NULL;
+
+    //check if we have a free slot
+    if (slotIndex >= 0)
+    {
+        //take it off the free list, and move it to the next generation, which is odd while it's in use
+        slot = slots.Get(slotIndex);
+        firstFree = slot->index;
+        slot->generation++;
+    }
+    else
+    {
+        //make sure the index fits in a handle
+        slotIndex = slots.Num();
+        IFBREAKRETURNVAL(Handle(slotIndex) >= (Handle(1) << IndexBits) - 1, 0);
+
+        //add a new slot, generations start at 1 so no handle is 0
+        slot = slots.AddNew();
+        slot->generation = 1;
+    }
+
+    //the item will be added at the end
+    slot->index = items.Num();
+
+    //return its handle
+    return MakeHandle(slotIndex, slot->generation);
+}
+
+template <class T, class H>
+void SlotMap<T, H>::FreeSlot(int32 slotIndex)
+{
+    //the highest generation that fits in a handle, which is odd
+    uint32 const maxGeneration = uint32((~Handle(0)) >> IndexBits);
+
+    //a slot with no generations left is never used again, rather than starting over where old
+    //handles would match.  Its generation is left even, so it stays free.
+    Slot *slot = slots.Get(slotIndex);
+    if (slot->generation >= maxGeneration)
+    {
+        slot->generation = 0;
+        slot->index = -1;
+        return;
+    }
+
+    //move to the next generation, which is even while it's free, so old handles don't match
+    slot->generation++;
+
+    //add it to the free list
+    slot->index = firstFree;
+    firstFree = slotIndex;
+}
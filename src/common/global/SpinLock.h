@@ -0,0 +1,108 @@
+//
+// v1 - Prototype character/item/tradeskill game.
+// Copyright (C) 2013 Adam Hayek (adam.hayek@gmail.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see [http://www.gnu.org/licenses/].
+//
+
+#pragma once
+
+#include "common\global\global.h"
+
+//
+//A very small lock for protecting short sections of code that are rarely contended.
+//It never sleeps, so it must only be held for a few instructions.  Unlocked it is
+//a single interlocked instruction to take and a plain store to release.
+//
+//  SpinLock lock;
+//  {
+//      SpinLockScope scope(lock);
+//      ...
+//  }
+//
+class SpinLock
+{
+public:
+    inline SpinLock();
+
+    //waits until we own the lock.
+    inline void Lock();
+
+    //releases the lock.  Must be called by the thread which owns it.
+    inline void Unlock();
+
+private:
+    //1 while someone owns the lock
+    long volatile locked;
+};
+
+//Owns a SpinLock for the life of a stack variable.
+class SpinLockScope
+{
+public:
+    inline SpinLockScope(SpinLock &lock);
+    inline ~SpinLockScope();
+
+private:
+    SpinLock &lock;
+};
+
+
+//
+//SpinLock inline functions
+//
+
+inline SpinLock::SpinLock()
+{
+    //nobody owns us
+    locked = 0;
+}
+
+inline void SpinLock::Lock()
+{
+    //try to swap in a 1 until the old value was 0
+    while (_InterlockedExchange(&locked, 1) != 0)
+    {
+        //wait for it to look free before trying again, so we don't keep stealing the cache line
+        while (locked != 0)
+        {
+            _mm_pause();
+        }
+    }
+}
+
+inline void SpinLock::Unlock()
+{
+    //keep the compiler from moving stores from inside the lock to after it.
+    //x86 stores are never reordered with earlier stores, so a plain store releases the lock.
+    _ReadWriteBarrier();
+    locked = 0;
+}
+
+
+//
+//SpinLockScope inline functions
+//
+
+inline SpinLockScope::SpinLockScope(SpinLock &lock) : lock(lock)
+{
+    //take the lock
+    lock.Lock();
+}
+
+inline SpinLockScope::~SpinLockScope()
+{
+    //release the lock
+    lock.Unlock();
+}
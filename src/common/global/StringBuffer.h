@@ -21,6 +21,30 @@
 #include <string.h>
 #include <stdarg.h>
 #include "common\global\global.h"
+#include "common\global\Utf.h"
+
+//
+//Fixed size string buffers that live in place, on the stack or inside other objects.  They keep
+//their length, so Length and Append don't have to scan the string.
+//
+
+//
+//Number to text conversion for the typed appends, AppendInt and AppendFloat.  No printf, no
+//locale and no heap, so they are cheap enough to build text every frame.
+//
+
+//the most characters StringFormatInt or StringFormatFloat will write
+#define STRING_FORMAT_MAX 352
+
+//the most decimal places StringFormatFloat will write
+#define STRING_FORMAT_DECIMALS 9
+
+//writes an integer as text, without a null.  Returns the number of characters written.
+int32 StringFormatInt(int64 value, char *text);
+
+//writes a number as text with the given number of decimal places, rounded half away from zero,
+//without a null.  Returns the number of characters written.
+int32 StringFormatFloat(double value, int32 decimals, char *text);
 
 //
 //Single byte character string buffer
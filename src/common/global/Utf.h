@@ -0,0 +1,54 @@
+//
+// v1 - Prototype character/item/tradeskill game.
+// Copyright (C) 2013 Adam Hayek (adam.hayek@gmail.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see [http://www.gnu.org/licenses/].
+//
+
+#pragma once
+
+#include "common\global\global.h"
+
+//
+//Conversion between UTF-8 and wide strings.  A wchar is UTF-16 on Windows and UTF-32 elsewhere,
+//and both are handled.
+//
+//Input is validated.  Anything that isn't a character is written as U+FFFD, the replacement
+//character: bad UTF-8 bytes, overlong or truncated sequences, encoded surrogates, values past
+//U+10FFFF, and unpaired UTF-16 surrogates.  Bad UTF-8 is replaced the way Unicode recommends,
+//one U+FFFD for each maximal invalid subpart, the same as browsers and most libraries.
+//
+//Runs of ASCII, which is most game text, are converted 16 bytes at a time with SSE2.
+//
+//  char utf8[256];
+//  Utf8FromWide(utf8, sizeof(utf8), L"caf\x00E9");
+//
+//The source length is in units (chars or wchars), or -1 if the source is null terminated.
+//The destination length is in units and includes room for the null, which is always written.
+//A character which doesn't fit is not split; the conversion stops before it.  If dest is NULL,
+//nothing is written and the return value is the length the whole conversion needs, not
+//counting the null.
+//
+
+//converts a wide string to UTF-8.  Returns the number of chars written, not counting the null.
+int32 Utf8FromWide(char *dest, int32 destLen, wchar const *src, int32 srcLen = -1);
+
+//converts a UTF-8 string to a wide string.  Returns the number of wchars written, not counting the null.
+int32 WideFromUtf8(wchar *dest, int32 destLen, char const *src, int32 srcLen = -1);
+
+//returns true if the string is valid UTF-8, so it would convert without any replacement characters.
+bool Utf8Valid(char const *src, int32 srcLen = -1);
+
+//the replacement character written for anything that isn't a character
+#define UTF_REPLACEMENT 0xFFFD
@@ -72,6 +72,7 @@
 #pragma warning(disable: 4512) //'' : assignment operator could not be generated
 #pragma warning(disable: 4505) //'' : unreferenced local function has been removed
 #pragma warning(disable: 4748) ///GS can not protect parameters and local variables from local buffer overrun because optimizations are disabled in function
+#pragma warning(disable: 4481) //nonstandard extension used: override specifier 'sealed'
 
 #endif
 
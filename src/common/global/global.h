@@ -24,6 +24,7 @@
 
 #include <math.h>
 #include <intrin.h>
+#include <iterator>
 #include "common\global\compiler.h"
 
 //
@@ -35,6 +36,7 @@ typedef int int32;
 typedef short int16;
 typedef char int8;
 
+typedef unsigned __int64 uint64;
 typedef unsigned int uint32;
 typedef unsigned short uint16;
 typedef unsigned char uint8;
@@ -236,5 +238,7 @@ typedef wchar_t wchar;
 
 //everyone uses the context code, or at least they should
 #include "common\global\ArrayPointer.h"
+#include "common\global\ArrayValue.h"
+#include "common\global\ArrayHashed.h"
 #include "common\global\StringBuffer.h"
 #include "common\global\Context.h"
@@ -0,0 +1,535 @@
+//
+// v1 - Prototype character/item/tradeskill game.
+// Copyright (C) 2013 Adam Hayek (adam.hayek@gmail.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see [http://www.gnu.org/licenses/].
+//
+
+//We include this file multiple times in order to create different hashed array types.
+//
+//  Basic options set with #define:
+//  - ArrayHashedImpl_ClassName
+//      name of the array class we're implementing
+//  - ArrayHashedImpl_Owner
+//      present if we want our implementation to own the objects and be responsible for deleting them
+//      Changes destructor, Empty, Reset to O(n)
+//
+//The table is open addressed in the style of SwissTable.  Slots are split into groups of 16, and each
+//slot has one control byte which is either Empty, Deleted, or the low 7 bits of the hash of the key stored there.
+//A lookup probes one group at a time, comparing all 16 control bytes at once with SSE2, and only
+//compares keys of slots whose control byte matches.  The full hash of every key is cached next to
+//it, so growing the table never calls HashFunc again and most mismatches never call CompareFunc.
+//
+//This is implemented this way to achieve the highest level of code reuse (not creating the same function multiple times)
+//while creating classes which are easy to look at inside the debugger.  If a class heirarchy was used instead, data members
+//are buried at the base of the class tree and possibly multiple base classes must be opened in order to view them.
+//
+
+template <class K, class C>
+class ArrayHashedImpl_ClassName
+{
+private:
+    ArrayHashedImpl_ClassName(ArrayHashedImpl_ClassName const &other);
+public:
+    ArrayHashedImpl_ClassName();
+    ~ArrayHashedImpl_ClassName();
+
+    //
+    //member access functions
+    //
+public:
+    //number of items in the table.
+    int32 Num() const;
+
+    //number of slots in the table.  Use with GetSlot to walk all items.
+    int32 Slots() const;
+
+    //gets the item in the given slot, or NULL if the slot has no item.
+    C *GetSlot(int32 slot);
+
+    //makes sure the table can hold the given number of items without growing.
+    bool Reserve(int32 count);
+
+    //
+    //add, remove and find items
+    //
+public:
+    //adds an item with the given key.  Returns false if an item with an equal key is already in the table.
+    //The key is stored by value, so a key pointer must stay valid while the item is in the table.
+    bool Add(K const key, C *item);
+
+    //removes the item with the given key.  The object's lifetime must be then managed by the caller.
+    //returns NULL if no item has the key.
+    C *Remove(K const key);
+
+    //finds the item with the given key.  returns NULL if no item has the key.
+    C *Find(K const key);
+
+    //
+    //Functions to clear the table.
+    //
+    //remove all items from our table and free storage space.
+    void Reset();
+
+    //remove all items from our table without decreasing capacity.
+    void Empty();
+
+    #if defined(__CONFIG_ARRAY_STATS)
+    //tags our stats with the place that owns us, see ARRAY_STATS_PLACE.
+    inline void StatsPlace(Place &place);
+    #endif
+
+private:
+    //values of control bytes that aren't a hash.  Both have the high bit set, hashes never do.
+    enum
+    {
+        GroupSize = 16,
+        ControlEmpty = -128,
+        ControlDeleted = -2
+    };
+
+    //data for a used slot
+    class Entry
+    {
+    public:
+        //full hash of the key
+        uint32 hash;
+
+        //the key
+        K key;
+
+        //the item
+        C *item;
+    };
+
+    //the number of items in the table.
+    int32 num;
+
+    //the number of slots in the table, a power of 2 and a multiple of GroupSize.
+    int32 max;
+
+    //the number of slots marked Deleted.  They still make probe sequences longer.
+    int32 numDeleted;
+
+    //control byte of each slot
+    int8 *control;
+
+    //the entry of each slot, only valid if the slot's control byte is a hash.
+    Entry *entries;
+
+    #if defined(__CONFIG_ARRAY_STATS)
+    //resize and usage counts, see ArrayStats.h.  Each slot is an entry and a control byte.
+    ArrayStats stats;
+    #endif
+
+    //gets the slot of the given key, or -1 if it isn't in the table.
+    int32 FindSlot(K const key, uint32 hash) const;
+
+    //gets an empty or deleted slot to store the given hash in.
+    int32 FreeSlot(uint32 hash) const;
+
+    //moves all our items into a table with the given number of slots.
+    bool Rehash(int32 newMax);
+
+    //gets a bit mask of the slots in a group whose control byte is the given value.
+    static inline uint32 MatchGroup(int8 const *group, int8 value);
+
+    //gets a bit mask of the slots in a group which are empty or deleted.
+    static inline uint32 MatchGroupFree(int8 const *group);
+
+    //gets the index of the lowest bit set in a mask which isn't 0.
+    static inline int32 LowestBit(uint32 mask);
+};
+
+//
+//ArrayHashedImpl_ClassName template functions
+//
+
+template <class K, class C>
+ArrayHashedImpl_ClassName<K, C>::ArrayHashedImpl_ClassName() ARRAY_STATS_INIT(ArrayHashedImpl_ClassName, sizeof(Entry) + 1)
+{
+    num = max = numDeleted = 0;
+    control = NULL;
+    entries = NULL;
+}
+
+template <class K, class C>
+ArrayHashedImpl_ClassName<K, C>::~ArrayHashedImpl_ClassName()
+{
+    //reset table
+    Reset();
+}
+
+template <class K, class C>
+int32 ArrayHashedImpl_ClassName<K, C>::Num() const
+{
+    return num;
+}
+
+template <class K, class C>
+int32 ArrayHashedImpl_ClassName<K, C>::Slots() const
+{
+    return max;
+}
+
+template <class K, class C>
+C *ArrayHashedImpl_ClassName<K, C>::GetSlot(int32 slot)
+{
+    IFBREAKNULL(slot < 0 || slot >= max);
+
+    //empty and deleted slots have the high bit set
+    return (control[slot] < 0) ? NULL : entries[slot].item;
+}
+
+template <class K, class C>
+bool ArrayHashedImpl_ClassName<K, C>::Reserve(int32 count)
+{
+    //find the number of slots which keeps the table at most 7/8 full
+    int32 newMax = GroupSize;
+    while (newMax - newMax / 8 < count)
+    {
+        newMax *= 2;
+    }
+
+    //check if we already have that many
+    if (newMax <= max)
+    {
+        return true;
+    }
+
+    //grow the table
+    return Rehash(newMax);
+}
+
+template <class K, class C>
+bool ArrayHashedImpl_ClassName<K, C>::Add(K const key, C *item)
+{
+    IFBREAKFALSE(item == NULL);
+
+    //hash the key once
+    uint32 hash = HashFunc(key);
+
+    //check if the key is already here
+    if (max > 0 && FindSlot(key, hash) >= 0)
+    {
+        //bad news, one already here
+        BREAK1();
+        return false;
+    }
+
+    //check if we need to grow to stay at most 7/8 full, counting deleted slots
+    if (num + numDeleted + 1 > max - max / 8)
+    {
+        //start with one group.  If deleted slots are most of the load, clean them out without growing.
+        int32 newMax = (max == 0) ? GroupSize : ((numDeleted >= num) ? max : max * 2);
+
+        //rehash into the new table
+        IFBREAKFALSE(Rehash(newMax) == false);
+    }
+
+    //get a slot for it
+    int32 slot = FreeSlot(hash);
+    IFBREAKFALSE(slot < 0);
+
+    //check if we are reusing a deleted slot
+    if (control[slot] == ControlDeleted)
+    {
+        numDeleted--;
+    }
+
+    //fill the slot
+    control[slot] = int8(hash & 0x7F);
+    entries[slot].hash = hash;
+    entries[slot].key = key;
+    entries[slot].item = item;
+
+    //we have one more item now
+    num++;
+    ARRAY_STATS(Added(num));
+
+    //success
+    return true;
+}
+
+template <class K, class C>
+C *ArrayHashedImpl_ClassName<K, C>::Remove(K const key)
+{
+    //check if we have no items
+    if (num < 1)
+    {
+        //wont find anything
+        return NULL;
+    }
+
+    //find the slot it is in
+    int32 slot = FindSlot(key, HashFunc(key));
+    if (slot < 0)
+    {
+        //never found it
+        return NULL;
+    }
+
+    //get the item we are about to remove
+    C *item = entries[slot].item;
+
+    //lookups stop at a group with an empty slot, so if this group already has one,
+    //no probe sequence continues past it and the slot can be empty instead of deleted.
+    int8 *group = &control[slot & ~(GroupSize - 1)];
+    if (MatchGroup(group, ControlEmpty) != 0)
+    {
+        control[slot] = ControlEmpty;
+    }
+    else
+    {
+        control[slot] = ControlDeleted;
+        numDeleted++;
+    }
+
+    //we now have 1 less item.
+    num--;
+    ARRAY_STATS(Removed());
+
+    //return the item
+    return item;
+}
+
+template <class K, class C>
+C *ArrayHashedImpl_ClassName<K, C>::Find(K const key)
+{
+    //check if we have no items
+    if (num < 1)
+    {
+        //wont find anything
+        return NULL;
+    }
+
+    //find the slot it is in
+    int32 slot = FindSlot(key, HashFunc(key));
+
+    //return the item, if any
+    return (slot < 0) ? NULL : entries[slot].item;
+}
+
+template <class K, class C>
+void ArrayHashedImpl_ClassName<K, C>::Reset()
+{
+    //empty the table first
+    Empty();
+
+    //delete the storage
+    delca(control);
+    delca(entries);
+
+    //we have no storage anymore
+    max = 0;
+}
+
+#if defined(__CONFIG_ARRAY_STATS)
+template <class K, class C>
+void ArrayHashedImpl_ClassName<K, C>::StatsPlace(Place &place)
+{
+    stats.SetPlace(place);
+}
+#endif
+
+template <class K, class C>
+void ArrayHashedImpl_ClassName<K, C>::Empty()
+{
+    //go through all the slots
+    for (int32 i = 0; i < max; i++)
+    {
+        #ifdef ArrayHashedImpl_Owner
+        //check if there is an item here
+        if (control[i] >= 0)
+        {
+            //delete this item
+            delc(entries[i].item);
+        }
+        #endif
+
+        //the slot is empty
+        control[i] = ControlEmpty;
+    }
+
+    //we have no items
+    ARRAY_STATS(Removed(num));
+    num = 0;
+    numDeleted = 0;
+}
+
+template <class K, class C>
+int32 ArrayHashedImpl_ClassName<K, C>::FindSlot(K const key, uint32 hash) const
+{
+    //the low 7 bits go in the control byte, the rest pick the group to start probing
+    int8 h2 = int8(hash & 0x7F);
+    int32 groupMask = max / GroupSize - 1;
+    int32 group = int32(hash >> 7) & groupMask;
+
+    //probe groups in triangular order, which visits every group once
+    for (int32 probe = 0; probe <= groupMask; probe++)
+    {
+        //control bytes of this group
+        int8 const *groupControl = &control[group * GroupSize];
+
+        //check each slot whose control byte matches
+        for (uint32 matches = MatchGroup(groupControl, h2); matches != 0; matches &= matches - 1)
+        {
+            //get the slot
+            int32 slot = group * GroupSize + LowestBit(matches);
+
+            //check the full hash before the key
+            if (entries[slot].hash == hash && ::CompareFunc(entries[slot].key, key) == 0)
+            {
+                //found it
+                return slot;
+            }
+        }
+
+        //an empty slot ends the probe sequence
+        if (MatchGroup(groupControl, ControlEmpty) != 0)
+        {
+            break;
+        }
+
+        //go to the next group
+        group = (group + probe + 1) & groupMask;
+    }
+
+    //didnt find it anywhere
+    return -1;
+}
+
+template <class K, class C>
+int32 ArrayHashedImpl_ClassName<K, C>::FreeSlot(uint32 hash) const
+{
+    //follow the same probe sequence as FindSlot
+    int32 groupMask = max / GroupSize - 1;
+    int32 group = int32(hash >> 7) & groupMask;
+
+    //probe groups in triangular order
+    for (int32 probe = 0; probe <= groupMask; probe++)
+    {
+        //check for an empty or deleted slot in this group
+        uint32 free = MatchGroupFree(&control[group * GroupSize]);
+        if (free != 0)
+        {
+            //use the first one
+            return group * GroupSize + LowestBit(free);
+        }
+
+        //go to the next group
+        group = (group + probe + 1) & groupMask;
+    }
+
+    //the table is full, which should never happen
+    return -1;
+}
+
+template <class K, class C>
+bool ArrayHashedImpl_ClassName<K, C>::Rehash(int32 newMax)
+{
+    IFASSERTFALSE(newMax < GroupSize || (newMax & (newMax - 1)) != 0);
+
+    //make the new storage
+    int8 *newControl = new int8[newMax];
+    IFBREAKFALSE(newControl == NULL);
+    Entry *newEntries = new Entry[newMax];
+    IFBREAKFALSE(newEntries == NULL);
+
+    //swap in the new storage, keeping the old
+    int8 *oldControl = control;
+    Entry *oldEntries = entries;
+    int32 oldMax = max;
+    control = newControl;
+    entries = newEntries;
+    max = newMax;
+    ARRAY_STATS(Resized(newMax));
+    numDeleted = 0;
+
+    //all new slots start empty
+    memset(control, ControlEmpty, newMax);
+
+    //move each item over, using its cached hash
+    for (int32 i = 0; i < oldMax; i++)
+    {
+        //skip empty and deleted slots
+        if (oldControl[i] < 0)
+        {
+            continue;
+        }
+
+        //get a slot in the new table
+        int32 slot = FreeSlot(oldEntries[i].hash);
+        IFBREAKCONTINUE(slot < 0);
+
+        //move the entry
+        control[slot] = oldControl[i];
+        entries[slot] = oldEntries[i];
+    }
+
+    //delete the old storage
+    delca(oldControl);
+    delca(oldEntries);
+
+    //success
+    return true;
+}
+
+template <class K, class C>
+uint32 ArrayHashedImpl_ClassName<K, C>::MatchGroup(int8 const *group, int8 value)
+{
+    #if defined(__PLATFORM_WIN32_PC)
+    //compare all 16 bytes at once, and collect the high bit of each result
+    __m128i bytes = _mm_loadu_si128((__m128i const *)group);
+    return (uint32)_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(value)));
+    #else
+    //compare one byte at a time
+    uint32 mask = 0;
+    for (int32 i = 0; i < GroupSize; i++)
+    {
+        mask |= uint32(group[i] == value) << i;
+    }
+    return mask;
+    #endif
+}
+
+template <class K, class C>
+uint32 ArrayHashedImpl_ClassName<K, C>::MatchGroupFree(int8 const *group)
+{
+    #if defined(__PLATFORM_WIN32_PC)
+    //empty and deleted bytes are the only ones with the high bit set
+    return (uint32)_mm_movemask_epi8(_mm_loadu_si128((__m128i const *)group));
+    #else
+    //check one byte at a time
+    uint32 mask = 0;
+    for (int32 i = 0; i < GroupSize; i++)
+    {
+        mask |= uint32(group[i] < 0) << i;
+    }
+    return mask;
+    #endif
+}
+
+template <class K, class C>
+int32 ArrayHashedImpl_ClassName<K, C>::LowestBit(uint32 mask)
+{
+    //use the bit scan instruction
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (int32)index;
+}
+
+
+#undef ArrayHashedImpl_ClassName
+#undef ArrayHashedImpl_Owner
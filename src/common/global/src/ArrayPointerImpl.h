@@ -26,19 +26,45 @@
 //      Changes destructor, Empty, Reset to O(n)
 //  - ArrayPointerImpl_Queue
 //      Present if we want our implementation to preseve the order of items when items are removed.
-//      Changes Remove to be O(n)
-//      Adds O(1) Pop to remove the oldest item.
+//      The items are stored in a circular buffer, so the front of the array can move.
+//      Changes Remove to be O(n), but only the items on the shorter side of the removed one are moved,
+//      so removing the first or last item is O(1).
+//      Adds O(1) PushBack, PushFront and PopFront.
 //  - ArrayPointerImpl_Sorted
 //      Adds functions to support O(log(n)) searching for items.
-//      Implies ArrayPointerImpl_Queue
+//      Preserves the order of items when items are removed, like ArrayPointerImpl_Queue, but
+//      the items always start at index 0 of the storage.
+//      Adds Freeze, which lays out a copy of the items for faster searching until the array changes.
+//  - ArrayPointerImpl_Inline
+//      Adds a second template parameter, inlineMax.  The first inlineMax pointers are stored inside
+//      the array object, and the heap is only used once more items than that are added.
+//      Can not be combined with ArrayPointerImpl_Queue.
 //
 //This is implemented this way to achieve the highest level of code reuse (not creating the same function multiple times)
 //while creating classes which are easy to look at inside the debugger.  If a class heirarchy was used instead, data members
 //are buried at the base of the class tree and possibly multiple base classes must be opened in order to view them.
 //
 
+//internal option, present if Remove must keep the order of the remaining items.
+#if defined(ArrayPointerImpl_Queue) || defined(ArrayPointerImpl_Sorted)
+#define ArrayPointerImpl_Ordered
+#endif
+
+//the inline storage isn't a power of 2, so it can't be a circular buffer.
+#if defined(ArrayPointerImpl_Inline) && defined(ArrayPointerImpl_Queue)
+#error ArrayPointerImpl_Inline can not be combined with ArrayPointerImpl_Queue
+#endif
 
-template <class C>
+//internal template header and class type, which depend on whether we have inline storage.
+#if defined(ArrayPointerImpl_Inline)
+#define ArrayPointerImpl_Template template <class C, int32 inlineMax>
+#define ArrayPointerImpl_Type ArrayPointerImpl_ClassName<C, inlineMax>
+#else
+#define ArrayPointerImpl_Template template <class C>
+#define ArrayPointerImpl_Type ArrayPointerImpl_ClassName<C>
+#endif
+
+ArrayPointerImpl_Template
 class ArrayPointerImpl_ClassName
 {
 private:
@@ -72,23 +98,94 @@ public:
     inline C const *Get(int32 index) const;
 
     //get all of our elements
+    #if defined(ArrayPointerImpl_Queue)
+    //if the circular buffer has wrapped around, the items are first moved so they are contiguous, which is O(n).
+    C const *const *Array();
+    #else
     C const *const *Array() const;
+    #endif
 
     //remove all our items and add all items from the given array, removing them from it
     void TakeFrom(ArrayPointerImpl_ClassName &other);
 
+    //
+    //Unchecked access, see ArraySpan.h.  These don't check the index, so loops which already know
+    //their bounds don't pay for a check on every item, and the standard algorithms can be used.
+    //
+public:
+    #if defined(ArrayPointerImpl_Queue)
+    typedef ArrayRingIterator<C *> iterator;
+    typedef ArrayRingIterator<C *const> const_iterator;
+    typedef C *&reference;
+    typedef ArraySpan<C *> span;
+    #elif defined(ArrayPointerImpl_Sorted)
+    //the pointers of a sorted array can't be changed in place, that would break the sort order.
+    typedef C *const *iterator;
+    typedef C *const *const_iterator;
+    typedef C *const &reference;
+    typedef ArraySpan<C *const> span;
+    #else
+    typedef C **iterator;
+    typedef C *const *const_iterator;
+    typedef C *&reference;
+    typedef ArraySpan<C *> span;
+    #endif
+    typedef C *value_type;
+
+    inline iterator begin();
+    inline iterator end();
+    inline const_iterator begin() const;
+    inline const_iterator end() const;
+
+    inline reference operator[](int32 index);
+    inline C *const &operator[](int32 index) const;
+
+    //all our items as one contiguous span.
+    #if defined(ArrayPointerImpl_Queue)
+    //if the circular buffer has wrapped around, the items are first moved so they are contiguous, which is O(n).
+    span Span();
+    #else
+    inline span Span();
+    inline ArraySpan<C *const> Span() const;
+    #endif
+
     //
     //add a single item to the array
     //
 public:
     //adds an item to the array.
     #if defined(ArrayPointerImpl_Sorted)
-    void Add(C *item, CompareFunc compareFunc);
+    //returns false if an equal item is already in the array, in which case the item is not added.
+    bool Add(C *item, CompareFunc compareFunc);
+
+    //adds many items at once, which is O(n + m*log(m)) instead of O(n*m) for adding them one at a time.
+    //Items equal to one already in the array, or to another item in the batch, are not added and are put
+    //in the duplicates array if one is given.  Returns the number of items added.
+    //If parallelSort is true and the build has OpenMP, large batches are sorted on multiple threads.
+    int32 AddBatch(C *const *batch, int32 count, CompareFunc compareFunc, ArrayPointer<C> *duplicates = NULL, bool parallelSort = false);
 private:
     bool Insert(C *item, int32 index);
+
+    //sorts an array of items with the given compare function.
+    static void Sort(C **sortItems, int32 count, CompareFunc compareFunc, bool parallelSort);
     #endif
     void Add(C *item);
 
+    #if defined(ArrayPointerImpl_Queue)
+    //
+    //O(1) functions to use the array as a double ended queue.
+    //
+public:
+    //adds an item after the last item, same as Add.
+    inline void PushBack(C *item);
+
+    //adds an item before the first item.
+    void PushFront(C *item);
+
+    //removes the first item and returns it.  Returns NULL if the array is empty.
+    C *PopFront();
+    #endif
+
     //
     //Remove an item from the array.  The object's lifetime must be then managed by the caller.
     //
@@ -105,6 +202,13 @@ public:
     //Find an item in the array.
     //
 public:
+    //returns the index of the item with the given address, or -1 if it isn't in the array.
+    //compares several pointers per instruction, see PointerSearch.h.
+    int32 IndexOf(C const *item) const;
+
+    //returns true if the item with the given address is in the array.
+    inline bool Contains(C const *item) const;
+
     #if defined(ArrayPointerImpl_Sorted)
     //finds the item that matches the given identifier, given a find function
     template <class ID>
@@ -114,6 +218,35 @@ public:
     C *Find(C const *item, CompareFunc compareFunc);
     #endif
 
+    #if defined(ArrayPointerImpl_Sorted)
+    //
+    //Frozen mode, for large tables which are searched far more often than they change.
+    //
+public:
+    //makes a copy of the item pointers in Eytzinger order, the layout of a binary heap, where the
+    //children of the item at index k are at 2k and 2k+1.  The first steps of every search then share
+    //a few cache lines, and both Find functions use a search with no branches on the comparison,
+    //which prefetches the pointers four steps ahead and the items it compares next.
+    //Get, Num and the iterators still see the sorted items.  Any change to the array thaws it.
+    bool Freeze();
+
+    //frees the frozen copy, Find goes back to a binary search of the sorted items.
+    void Thaw();
+
+    //returns true if Freeze was called and the array hasn't changed since.
+    inline bool IsFrozen() const;
+private:
+    //fills the frozen subtree at frozenIndex from items, starting at itemIndex.  Returns the next item index.
+    int32 FillFrozen(int32 itemIndex, uint32 frozenIndex);
+
+    //prefetches what a frozen search will read after visiting index k.
+    inline void PrefetchFrozen(uint32 k) const;
+
+    //turns the index a frozen search fell off the tree at into the index of the first item
+    //which is not before the one searched for, or 0 if all items are before it.
+    static inline uint32 FrozenLowerBound(uint32 k);
+    #endif
+
     //
     //Functions to clear the array.
     //
@@ -123,6 +256,11 @@ public:
     //remove all elements from our array without decreasing max capacity.
     void Empty();
 
+    #if defined(__CONFIG_ARRAY_STATS)
+    //tags our stats with the place that owns us, see ARRAY_STATS_PLACE.
+    inline void StatsPlace(Place &place);
+    #endif
+
 private:
     //the number of elements in our array.
     int32 num;
@@ -131,11 +269,8 @@ private:
     int32 max;
 
     #if defined(ArrayPointerImpl_Queue)
-    //start index of first, second, and third blocks
-    int32 start[3];
-
-    //number of items in first, second, and third blocks
-    int32 count[3];
+    //index in the pointer array of our first item.
+    int32 first;
     #endif
 
     #ifdef __CONFIG_DEBUG
@@ -155,74 +290,260 @@ private:
     C **items;
     #endif
 
+    #if defined(ArrayPointerImpl_Sorted)
+    //the item pointers in Eytzinger order starting at index 1, or NULL if we aren't frozen.
+    C **frozen;
+    #endif
+
+    #if defined(ArrayPointerImpl_Inline)
+    //storage for our first object pointers, used until we need more than inlineMax of them.
+    C *inlineItems[inlineMax];
+    #endif
+
+    #if defined(__CONFIG_ARRAY_STATS)
+    //resize and usage counts, see ArrayStats.h
+    ArrayStats stats;
+    #endif
+
     //doubles the size of the array of pointers
     bool Lengthen();
+
+    //moves our items to a pointer array of the given length, starting at index 0.
+    bool Reallocate(int32 newMax);
+
+    //frees the pointer array, if it was allocated.
+    void FreeItems();
+
+    //gets the index in the pointer array of the item at the given index.
+    inline int32 Slot(int32 index) const;
 };
 
 //
 //ArrayPointerImpl_ClassName template functions
 //
 
-template <class C>
-ArrayPointerImpl_ClassName<C>::ArrayPointerImpl_ClassName()
+ArrayPointerImpl_Template
+ArrayPointerImpl_Type::ArrayPointerImpl_ClassName() ARRAY_STATS_INIT(ArrayPointerImpl_ClassName, sizeof(C *))
 {
     num = max = 0;
     items = NULL;
+
+    #if defined(ArrayPointerImpl_Queue)
+    first = 0;
+    #endif
+
+    #if defined(ArrayPointerImpl_Sorted)
+    //not frozen
+    frozen = NULL;
+    #endif
+
+    #if defined(ArrayPointerImpl_Inline)
+    //start out using our inline storage
+    items = inlineItems;
+    max = inlineMax;
+    #endif
 }
 
-template <class C>
-ArrayPointerImpl_ClassName<C>::~ArrayPointerImpl_ClassName()
+ArrayPointerImpl_Template
+ArrayPointerImpl_Type::~ArrayPointerImpl_ClassName()
 {
     //reset array
     Reset();
 }
 
-template <class C>
-C *ArrayPointerImpl_ClassName<C>::Get(int32 index)
+ArrayPointerImpl_Template
+C *ArrayPointerImpl_Type::Get(int32 index)
 {
     IFBREAKNULL(index < 0 || index >= num);
 
-    return items[index];
+    return items[Slot(index)];
 }
 
-template <class C>
-C const *ArrayPointerImpl_ClassName<C>::Get(int32 index) const
+ArrayPointerImpl_Template
+C const *ArrayPointerImpl_Type::Get(int32 index) const
 {
     IFBREAKNULL(index < 0 || index >= num);
 
-    return items[index];
+    return items[Slot(index)];
 }
 
-template <class C>
-int32 ArrayPointerImpl_ClassName<C>::Num() const
+ArrayPointerImpl_Template
+int32 ArrayPointerImpl_Type::Num() const
 {
     return num;
 }
 
-template <class C>
-C const *const *ArrayPointerImpl_ClassName<C>::Array() const
+ArrayPointerImpl_Template
+int32 ArrayPointerImpl_Type::Slot(int32 index) const
+{
+    #if defined(ArrayPointerImpl_Queue)
+    //wrap around the end of the pointer array.  max is always a power of 2.
+    return (first + index) & (max - 1);
+    #else
+    return index;
+    #endif
+}
+
+#if defined(ArrayPointerImpl_Queue)
+ArrayPointerImpl_Template
+C const *const *ArrayPointerImpl_Type::Array()
+{
+    //check if our items wrap around the end of the pointer array
+    if (first + num > max)
+    {
+        //move them to a new array so they are contiguous
+        IFBREAKNULL(Reallocate(max) == false);
+    }
+
+    //our items start at the first one
+    return (items == NULL) ? NULL : &items[first];
+}
+#else
+ArrayPointerImpl_Template
+C const *const *ArrayPointerImpl_Type::Array() const
 {
     return items;
 }
+#endif
+
+#if defined(ArrayPointerImpl_Queue)
+ArrayPointerImpl_Template
+typename ArrayPointerImpl_Type::iterator ArrayPointerImpl_Type::begin()
+{
+    return iterator(items, max, first, 0);
+}
+
+ArrayPointerImpl_Template
+typename ArrayPointerImpl_Type::iterator ArrayPointerImpl_Type::end()
+{
+    return iterator(items, max, first, num);
+}
 
-template <class C>
-void ArrayPointerImpl_ClassName<C>::TakeFrom(ArrayPointerImpl_ClassName &other)
+ArrayPointerImpl_Template
+typename ArrayPointerImpl_Type::const_iterator ArrayPointerImpl_Type::begin() const
+{
+    return const_iterator(items, max, first, 0);
+}
+
+ArrayPointerImpl_Template
+typename ArrayPointerImpl_Type::const_iterator ArrayPointerImpl_Type::end() const
+{
+    return const_iterator(items, max, first, num);
+}
+
+ArrayPointerImpl_Template
+typename ArrayPointerImpl_Type::span ArrayPointerImpl_Type::Span()
+{
+    //make our items contiguous
+    C const *const *array = Array();
+
+    //span over them
+    return span((array == NULL) ? NULL : &items[first], num);
+}
+#else
+ArrayPointerImpl_Template
+typename ArrayPointerImpl_Type::iterator ArrayPointerImpl_Type::begin()
+{
+    return items;
+}
+
+ArrayPointerImpl_Template
+typename ArrayPointerImpl_Type::iterator ArrayPointerImpl_Type::end()
+{
+    return items + num;
+}
+
+ArrayPointerImpl_Template
+typename ArrayPointerImpl_Type::const_iterator ArrayPointerImpl_Type::begin() const
+{
+    return items;
+}
+
+ArrayPointerImpl_Template
+typename ArrayPointerImpl_Type::const_iterator ArrayPointerImpl_Type::end() const
+{
+    return items + num;
+}
+
+ArrayPointerImpl_Template
+typename ArrayPointerImpl_Type::span ArrayPointerImpl_Type::Span()
+{
+    return span(items, num);
+}
+
+ArrayPointerImpl_Template
+ArraySpan<C *const> ArrayPointerImpl_Type::Span() const
+{
+    return ArraySpan<C *const>(items, num);
+}
+#endif
+
+ArrayPointerImpl_Template
+typename ArrayPointerImpl_Type::reference ArrayPointerImpl_Type::operator[](int32 index)
+{
+    #ifdef __CONFIG_DEBUG
+    if (index < 0 || index >= num) { BREAK1(); }
+    #endif
+    return items[Slot(index)];
+}
+
+ArrayPointerImpl_Template
+C *const &ArrayPointerImpl_Type::operator[](int32 index) const
+{
+    #ifdef __CONFIG_DEBUG
+    if (index < 0 || index >= num) { BREAK1(); }
+    #endif
+    return items[Slot(index)];
+}
+
+ArrayPointerImpl_Template
+void ArrayPointerImpl_Type::TakeFrom(ArrayPointerImpl_ClassName &other)
 {
     //clear out our items
     Reset();
 
+    #if defined(ArrayPointerImpl_Sorted)
+    //the other one is about to change
+    other.Thaw();
+    #endif
+
+    #if defined(ArrayPointerImpl_Inline)
+    //check if the other one is using its inline storage
+    if (other.items == other.inlineItems)
+    {
+        //copy the pointers to our inline storage, which Reset left us using
+        memcpy(inlineItems, other.inlineItems, sizeof(C *) * other.num);
+        num = other.num;
+
+        //remove from other list
+        other.num = 0;
+        return;
+    }
+    #endif
+
     //take data from other one
     items = other.items;
     num = other.num;
     max = other.max;
 
+    #if defined(ArrayPointerImpl_Queue)
+    first = other.first;
+    other.first = 0;
+    #endif
+
     //remove from other list
     other.items = null;
     other.num = other.max = 0;
+
+    #if defined(ArrayPointerImpl_Inline)
+    //the other one goes back to its inline storage
+    other.items = other.inlineItems;
+    other.max = inlineMax;
+    #endif
 }
 
-template <class C>
-void ArrayPointerImpl_ClassName<C>::Add(C *item)
+ArrayPointerImpl_Template
+void ArrayPointerImpl_Type::Add(C *item)
 {
     IFBREAKRETURN(item == NULL);
 
@@ -234,22 +555,107 @@ void ArrayPointerImpl_ClassName<C>::Add(C *item)
     }
 
     //insert the item in the last slot
-    items[num] = item;
+    items[Slot(num)] = item;
+
+    //we have one more item now
+    num++;
+    ARRAY_STATS(Added(num));
+}
+
+#if defined(ArrayPointerImpl_Queue)
+ArrayPointerImpl_Template
+void ArrayPointerImpl_Type::PushBack(C *item)
+{
+    //the end of the array is the back of the queue
+    Add(item);
+}
+
+ArrayPointerImpl_Template
+void ArrayPointerImpl_Type::PushFront(C *item)
+{
+    IFBREAKRETURN(item == NULL);
+
+    //check if we need to lengthen the array
+    if (num >= max)
+    {
+        //lengthen it.
+        IFBREAKRETURN(Lengthen() == false);
+    }
+
+    //the front moves back one slot, wrapping around the start of the pointer array
+    first = (first - 1) & (max - 1);
+
+    //insert the item in the new first slot
+    items[first] = item;
 
     //we have one more item now
     num++;
+    ARRAY_STATS(Added(num));
 }
 
-template <class C>
-C *ArrayPointerImpl_ClassName<C>::Remove(int32 index)
+ArrayPointerImpl_Template
+C *ArrayPointerImpl_Type::PopFront()
+{
+    //check if we have no items
+    if (num < 1)
+    {
+        //nothing to pop
+        return NULL;
+    }
+
+    //get the first item
+    C *item = items[first];
+
+    //the front moves up one slot
+    first = (first + 1) & (max - 1);
+
+    //we now have 1 less item.
+    num--;
+    ARRAY_STATS(Removed());
+
+    //return the item
+    return item;
+}
+#endif
+
+ArrayPointerImpl_Template
+C *ArrayPointerImpl_Type::Remove(int32 index)
 {
     //check the number.
     IFBREAKNULL(index < 0 || index >= num);
 
+    #if defined(ArrayPointerImpl_Sorted)
+    //our frozen copy will be out of date
+    Thaw();
+    #endif
+
     //get the item we are about to remove
-    C *item = items[index];
+    C *item = items[Slot(index)];
 
-    #ifdef ArrayPointerImpl_Queue
+    #if defined(ArrayPointerImpl_Queue)
+    //check if there are fewer elements before this one than after it
+    if (index < num / 2)
+    {
+        //move all elements before this one down one index
+        for (int32 i = index; i > 0; i--)
+        {
+            //move this element down
+            items[Slot(i)] = items[Slot(i - 1)];
+        }
+
+        //the front moves up one slot
+        first = (first + 1) & (max - 1);
+    }
+    else
+    {
+        //move all elements after this one up one index
+        for (int32 i = index + 1; i < num; i++)
+        {
+            //move this element up
+            items[Slot(i - 1)] = items[Slot(i)];
+        }
+    }
+    #elif defined(ArrayPointerImpl_Ordered)
     //move all elements after this one up one index
     for (int32 i = index + 1; i < num; i++)
     {
@@ -263,103 +669,198 @@ C *ArrayPointerImpl_ClassName<C>::Remove(int32 index)
 
     //we now have 1 less item.
     num--;
+    ARRAY_STATS(Removed());
 
     //return the item
     return item;
 }
 
-template <class C>
-C *ArrayPointerImpl_ClassName<C>::Remove(C *item)
+ArrayPointerImpl_Template
+C *ArrayPointerImpl_Type::Remove(C *item)
 {
     IFBREAKNULL(item == NULL);
 
     //search through the array
-    for (int32 i = 0; i < num; i++)
+    int32 index = IndexOf(item);
+    if (index < 0)
     {
-        //check if the item is here
-        if (items[i] == item)
-        {
-            //remove it
-            return Remove(i);
-        }
+        //never found it
+        return NULL;
     }
 
-    //never found it
-    return NULL;
+    //remove it
+    return Remove(index);
 }
 
-template <class C>
-void ArrayPointerImpl_ClassName<C>::Reset()
+ArrayPointerImpl_Template
+int32 ArrayPointerImpl_Type::IndexOf(C const *item) const
+{
+    #if defined(ArrayPointerImpl_Queue)
+    //number of items before the circular buffer wraps around the end of the pointer array
+    int32 firstNum = min(num, max - first);
+
+    //search those first
+    int32 index = PointerSearch((void const *const *)items + first, firstNum, item);
+    if (index >= 0)
+    {
+        return index;
+    }
+
+    //then the ones at the start of the pointer array
+    index = PointerSearch((void const *const *)items, num - firstNum, item);
+    return (index < 0) ? -1 : firstNum + index;
+    #else
+    //our items are contiguous
+    return PointerSearch((void const *const *)items, num, item);
+    #endif
+}
+
+ArrayPointerImpl_Template
+bool ArrayPointerImpl_Type::Contains(C const *item) const
+{
+    return IndexOf(item) >= 0;
+}
+
+ArrayPointerImpl_Template
+void ArrayPointerImpl_Type::Reset()
 {
     //empty the array first
     Empty();
 
-    //delete the array
-    delca(items);
-
-    //we have no array anymore
-    max = 0;
+    //free the array
+    FreeItems();
 }
 
-template <class C>
-void ArrayPointerImpl_ClassName<C>::Empty()
+ArrayPointerImpl_Template
+void ArrayPointerImpl_Type::Empty()
 {
+    #if defined(ArrayPointerImpl_Sorted)
+    //nothing left to search
+    Thaw();
+    #endif
+
     #ifdef ArrayPointerImpl_Owner
     //delete each item in the array
     for (int32 i = 0; i < num; i++)
     {
         //delete this item
-        delc(items[i]);
+        delc(items[Slot(i)]);
     }
     #endif
 
     //we have no items
+    ARRAY_STATS(Removed(num));
     num = 0;
+
+    #if defined(ArrayPointerImpl_Queue)
+    //start over at the beginning of the pointer array
+    first = 0;
+    #endif
 }
 
-template <class C>
-bool ArrayPointerImpl_ClassName<C>::Lengthen()
+#if defined(__CONFIG_ARRAY_STATS)
+ArrayPointerImpl_Template
+void ArrayPointerImpl_Type::StatsPlace(Place &place)
 {
-    //if we have no items, start with a length of 4
-    if (max == 0)
-    {
-        //make the new array
-        items = new C *[4];
-        max = 4;
+    stats.SetPlace(place);
+}
+#endif
 
-        //done
-        return true;
-    }
+ArrayPointerImpl_Template
+bool ArrayPointerImpl_Type::Lengthen()
+{
+    //if we have no items, start with a length of 4, otherwise double the length
+    return Reallocate((max == 0) ? 4 : max * 2);
+}
+
+ArrayPointerImpl_Template
+bool ArrayPointerImpl_Type::Reallocate(int32 newMax)
+{
+    IFASSERTFALSE(newMax < num);
 
-    //make a new array double the length
-    C **new_items = new C *[max * 2];
+    //the new array
+    C **new_items = NULL;
+
+    #if defined(ArrayPointerImpl_Queue)
+    //make a new array, since the items must be moved in order to unwrap the circular buffer
+    new_items = (C **)malloc(sizeof(C *) * newMax);
     IFBREAKFALSE(new_items == NULL);
 
-    //copy the old items
-    for (int32 i = 0; i < max; i++)
+    //number of items from the first one to the end of the old array
+    int32 firstPart = min(num, max - first);
+
+    //copy the items in order, in at most two pieces
+    if (firstPart > 0)
+    {
+        memcpy(new_items, &items[first], sizeof(C *) * firstPart);
+    }
+    if (num > firstPart)
     {
-        new_items[i] = items[i];
+        memcpy(&new_items[firstPart], items, sizeof(C *) * (num - firstPart));
     }
 
-    //we have 2 times max now
-    max *= 2;
+    //free the old array
+    freec(items);
 
-    //delete the old array
-    delca(items);
+    //our items start at the beginning again
+    first = 0;
+    #else
+    #if defined(ArrayPointerImpl_Inline)
+    //check if we are leaving our inline storage
+    if (items == inlineItems)
+    {
+        //make a new array and copy the inline pointers to it
+        new_items = (C **)malloc(sizeof(C *) * newMax);
+        IFBREAKFALSE(new_items == NULL);
+        memcpy(new_items, inlineItems, sizeof(C *) * num);
+    }
+    else
+    #endif
+    {
+        //let the heap grow the array in place if it can
+        new_items = (C **)realloc(items, sizeof(C *) * newMax);
+        IFBREAKFALSE(new_items == NULL);
+    }
+    #endif
 
     //swap in the new array
     items = new_items;
+    max = newMax;
+    ARRAY_STATS(Resized(newMax));
 
     //success
     return true;
 }
 
+ArrayPointerImpl_Template
+void ArrayPointerImpl_Type::FreeItems()
+{
+    #if defined(ArrayPointerImpl_Inline)
+    //check if we have an allocated array
+    if (items != inlineItems)
+    {
+        //free it
+        freec(items);
+    }
+
+    //go back to our inline storage
+    items = inlineItems;
+    max = inlineMax;
+    #else
+    //free the array
+    freec(items);
+
+    //we have no array anymore
+    max = 0;
+    #endif
+}
+
 #if defined(ArrayPointerImpl_Sorted)
-template <class C>
-void ArrayPointerImpl_ClassName<C>::Add(C *item, CompareFunc compareFunc)
+ArrayPointerImpl_Template
+bool ArrayPointerImpl_Type::Add(C *item, CompareFunc compareFunc)
 {
-    IFBREAKRETURN(item == NULL);
-    IFBREAKRETURN(compareFunc == NULL);
+    IFBREAKFALSE(item == NULL);
+    IFBREAKFALSE(compareFunc == NULL);
 
     //check if there are no items
     if (num < 1)
@@ -368,27 +869,21 @@ void ArrayPointerImpl_ClassName<C>::Add(C *item, CompareFunc compareFunc)
         Add(item);
 
         //done
-        return;
+        return true;
     }
 
     //check if it belongs before the first item
     if (compareFunc((C const **)&item, (C const **)&items[0]) < 0)
     {
         //it goes at the very beginning
-        Insert(item, (int32)0);
-        
-        //done
-        return;
+        return Insert(item, (int32)0);
     }
 
     //check if it belongs after the last one
     if (compareFunc((C const **)&item, (C const **)&items[num - 1]) > 0)
     {
         //it goes after end
-        Insert(item, num);
-
-        //done
-        return;
+        return Insert(item, num);
     }
 
     //it goes somewhere after index 0 and before index num
@@ -426,19 +921,193 @@ void ArrayPointerImpl_ClassName<C>::Add(C *item, CompareFunc compareFunc)
 
         //bad news, one already here
         BREAK1();
-        return;
+        return false;
     }
 
     //item goes between low and high index, insert at high to move it down
-    Insert(item, high);
+    return Insert(item, high);
+}
+
+ArrayPointerImpl_Template
+int32 ArrayPointerImpl_Type::AddBatch(C *const *batch, int32 count, CompareFunc compareFunc, ArrayPointer<C> *duplicates, bool parallelSort)
+{
+    IFBREAKRETURNVAL(batch == NULL && count > 0, 0);
+    IFBREAKRETURNVAL(compareFunc == NULL, 0);
+
+    //check if there is nothing to add
+    if (count < 1)
+    {
+        return 0;
+    }
+
+    //our frozen copy will be out of date
+    Thaw();
+
+    //copy the batch so we can sort it, skipping NULLs
+    C **sorted = new C *[count];
+    IFBREAKRETURNVAL(sorted == NULL, 0);
+    int32 numSorted = 0;
+    for (int32 i = 0; i < count; i++)
+    {
+        IFBREAKCONTINUE(batch[i] == NULL);
+        sorted[numSorted++] = batch[i];
+    }
+
+    //sort the batch
+    Sort(sorted, numSorted, compareFunc, parallelSort);
+
+    //find the length we need, keeping the doubling policy of Lengthen
+    int32 newMax = (max < 4) ? 4 : max;
+    while (newMax < num + numSorted)
+    {
+        newMax *= 2;
+    }
+
+    //make the array we merge into
+    C **merged = (C **)malloc(sizeof(C *) * newMax);
+    if (merged == NULL)
+    {
+        BREAK1();
+        delete [] sorted;
+        return 0;
+    }
+
+    //merge our items and the batch in one pass
+    int32 numMerged = 0;
+    int32 numAdded = 0;
+    int32 i = 0;
+    int32 j = 0;
+    while (j < numSorted)
+    {
+        //compare with the last item already merged, to catch duplicates inside the batch
+        if (numMerged > 0 && compareFunc((C const **)&sorted[j], (C const **)&merged[numMerged - 1]) == 0)
+        {
+            //report the duplicate
+            if (duplicates != NULL)
+            {
+                duplicates->Add(sorted[j]);
+            }
+            j++;
+            continue;
+        }
+
+        //check if the next item comes from our array
+        if (i < num && compareFunc((C const **)&items[i], (C const **)&sorted[j]) <= 0)
+        {
+            //take our item.  If it is equal, the batch item is caught as a duplicate next time around.
+            merged[numMerged++] = items[i++];
+            continue;
+        }
+
+        //take the batch item
+        merged[numMerged++] = sorted[j++];
+        numAdded++;
+    }
+
+    //the rest of our items go at the end
+    while (i < num)
+    {
+        merged[numMerged++] = items[i++];
+    }
+
+    //swap in the merged array
+    FreeItems();
+    delete [] sorted;
+    items = merged;
+    num = numMerged;
+    max = newMax;
+    ARRAY_STATS(Resized(newMax));
+    ARRAY_STATS(Added(num, numAdded));
+
+    //return how many were added
+    return numAdded;
 }
 
-template <class C>
-bool ArrayPointerImpl_ClassName<C>::Insert(C *item, int32 index)
+ArrayPointerImpl_Template
+void ArrayPointerImpl_Type::Sort(C **sortItems, int32 count, CompareFunc compareFunc, bool parallelSort)
+{
+    //batches smaller than this are always sorted on one thread
+    const int32 parallelMinimum = 4096;
+
+    //the number of runs we sort separately before merging them.
+    const int32 numRuns = (parallelSort == true && count >= parallelMinimum) ? 8 : 1;
+    int32 runLength = (count + numRuns - 1) / numRuns;
+
+    //sort each run.  OpenMP builds do this in parallel, others ignore the pragma.
+    #pragma omp parallel for if (numRuns > 1)
+    for (int32 run = 0; run < numRuns; run++)
+    {
+        //get the part of the array in this run
+        int32 start = run * runLength;
+        int32 length = min(runLength, count - start);
+
+        //our compare function takes pointers to the items, just like qsort
+        if (length > 1)
+        {
+            qsort(&sortItems[start], length, sizeof(C *), (int (*)(void const *, void const *))compareFunc);
+        }
+    }
+
+    //check if there is only one run
+    if (runLength >= count)
+    {
+        return;
+    }
+
+    //merge pairs of runs until there is one run left
+    C **scratch = new C *[count];
+    IFBREAKRETURN(scratch == NULL);
+    C **from = sortItems;
+    C **to = scratch;
+    for (; runLength < count; runLength *= 2)
+    {
+        //merge each pair of runs
+        #pragma omp parallel for if (count / runLength > 2)
+        for (int32 start = 0; start < count; start += runLength * 2)
+        {
+            //the two runs are [start, middle) and [middle, end)
+            int32 middle = min(start + runLength, count);
+            int32 end = min(start + runLength * 2, count);
+            int32 left = start;
+            int32 right = middle;
+
+            //take the smaller item from the front of either run
+            for (int32 out = start; out < end; out++)
+            {
+                if (right >= end || (left < middle && compareFunc((C const **)&from[left], (C const **)&from[right]) <= 0))
+                {
+                    to[out] = from[left++];
+                }
+                else
+                {
+                    to[out] = from[right++];
+                }
+            }
+        }
+
+        //the merged runs are the input to the next pass
+        C **swap = from;
+        from = to;
+        to = swap;
+    }
+
+    //make sure the result ends up in the given array
+    if (from != sortItems)
+    {
+        memcpy(sortItems, from, sizeof(C *) * count);
+    }
+    delete [] scratch;
+}
+
+ArrayPointerImpl_Template
+bool ArrayPointerImpl_Type::Insert(C *item, int32 index)
 {
     IFASSERTFALSE(item == NULL);
     IFASSERTFALSE(index < 0 || index > num);
 
+    //our frozen copy will be out of date
+    Thaw();
+
     //add the element at the end, which extends the array if necessary
     Add(item);
 
@@ -464,8 +1133,86 @@ bool ArrayPointerImpl_ClassName<C>::Insert(C *item, int32 index)
 }
 
 
-template <class C> template <class ID>
-C *ArrayPointerImpl_ClassName<C>::Find(ID const id, typename FindFunc<ID>::Func findFunc)
+ArrayPointerImpl_Template
+bool ArrayPointerImpl_Type::Freeze()
+{
+    //throw away any old copy
+    Thaw();
+
+    //check if there is nothing to search
+    if (num < 1)
+    {
+        return true;
+    }
+
+    //index 0 is unused, so the children of k are always at 2k and 2k+1
+    frozen = (C **)malloc(sizeof(C *) * (num + 1));
+    IFBREAKFALSE(frozen == NULL);
+    frozen[0] = NULL;
+
+    //an in order walk of the tree visits the items in sorted order
+    FillFrozen(0, 1);
+
+    //success
+    return true;
+}
+
+ArrayPointerImpl_Template
+void ArrayPointerImpl_Type::Thaw()
+{
+    //free the copy
+    freec(frozen);
+}
+
+ArrayPointerImpl_Template
+bool ArrayPointerImpl_Type::IsFrozen() const
+{
+    return frozen != NULL;
+}
+
+ArrayPointerImpl_Template
+int32 ArrayPointerImpl_Type::FillFrozen(int32 itemIndex, uint32 frozenIndex)
+{
+    //check if we are past the bottom of the tree
+    if (frozenIndex > uint32(num))
+    {
+        return itemIndex;
+    }
+
+    //left subtree has the items before us, then us, then the right subtree
+    itemIndex = FillFrozen(itemIndex, frozenIndex * 2);
+    frozen[frozenIndex] = items[itemIndex++];
+    return FillFrozen(itemIndex, frozenIndex * 2 + 1);
+}
+
+ArrayPointerImpl_Template
+void ArrayPointerImpl_Type::PrefetchFrozen(uint32 k) const
+{
+    #if defined(__PLATFORM_WIN32_PC)
+    //the 16 descendants four levels down are next to each other.  Prefetching past the end is harmless.
+    _mm_prefetch((char const *)&frozen[k * 16], _MM_HINT_T0);
+
+    //one of the children is compared next, so fetch both items
+    if (k * 2 + 1 <= uint32(num))
+    {
+        _mm_prefetch((char const *)frozen[k * 2], _MM_HINT_T0);
+        _mm_prefetch((char const *)frozen[k * 2 + 1], _MM_HINT_T0);
+    }
+    #endif
+}
+
+ArrayPointerImpl_Template
+uint32 ArrayPointerImpl_Type::FrozenLowerBound(uint32 k)
+{
+    //we went right (a 1 bit) every time the item was before the one we want.  Undo those steps and
+    //the last left step, which takes us back to the last item that was not before it.
+    unsigned long trailingOnes = 0;
+    _BitScanForward(&trailingOnes, ~k);
+    return k >> (trailingOnes + 1);
+}
+
+ArrayPointerImpl_Template template <class ID>
+C *ArrayPointerImpl_Type::Find(ID const id, typename FindFunc<ID>::Func findFunc)
 {
     IFBREAKNULL(id == NULL || findFunc == NULL);
 
@@ -476,6 +1223,22 @@ C *ArrayPointerImpl_ClassName<C>::Find(ID const id, typename FindFunc<ID>::Func
         return NULL;
     }
 
+    //check if we can search the frozen copy
+    if (frozen != NULL)
+    {
+        //walk down the tree, going right whenever the item is before the one we want
+        uint32 k = 1;
+        while (k <= uint32(num))
+        {
+            PrefetchFrozen(k);
+            k = 2 * k + uint32(findFunc(id, frozen[k]) > 0);
+        }
+
+        //the first item not before the one we want, check if it's the one
+        k = FrozenLowerBound(k);
+        return (k != 0 && findFunc(id, frozen[k]) == 0) ? frozen[k] : NULL;
+    }
+
     //the item is in some index between low and high, includsive
     int32 low = 0;
     int32 high = num - 1;
@@ -513,8 +1276,8 @@ C *ArrayPointerImpl_ClassName<C>::Find(ID const id, typename FindFunc<ID>::Func
     return NULL;
 }
 
-template <class C>
-C *ArrayPointerImpl_ClassName<C>::Find(C const *item, CompareFunc compareFunc)
+ArrayPointerImpl_Template
+C *ArrayPointerImpl_Type::Find(C const *item, CompareFunc compareFunc)
 {
     IFBREAKNULL(item == NULL || compareFunc == NULL);
 
@@ -525,6 +1288,22 @@ C *ArrayPointerImpl_ClassName<C>::Find(C const *item, CompareFunc compareFunc)
         return NULL;
     }
 
+    //check if we can search the frozen copy
+    if (frozen != NULL)
+    {
+        //walk down the tree, going right whenever the item is before the one we want
+        uint32 k = 1;
+        while (k <= uint32(num))
+        {
+            PrefetchFrozen(k);
+            k = 2 * k + uint32(compareFunc((C const **)&item, (C const **)&frozen[k]) > 0);
+        }
+
+        //the first item not before the one we want, check if it's the one
+        k = FrozenLowerBound(k);
+        return (k != 0 && compareFunc((C const **)&item, (C const **)&frozen[k]) == 0) ? frozen[k] : NULL;
+    }
+
     //the item is in some index between low and high, includsive
     int32 low = 0;
     int32 high = num - 1;
@@ -562,8 +1341,8 @@ C *ArrayPointerImpl_ClassName<C>::Find(C const *item, CompareFunc compareFunc)
     return NULL;
 }
 
-template <class C> template <class ID>
-C *ArrayPointerImpl_ClassName<C>::Remove(ID const id, typename FindFunc<ID>::Func findFunc)
+ArrayPointerImpl_Template template <class ID>
+C *ArrayPointerImpl_Type::Remove(ID const id, typename FindFunc<ID>::Func findFunc)
 {
     IFBREAKNULL(id == NULL || findFunc == NULL);
 
@@ -585,7 +1364,7 @@ C *ArrayPointerImpl_ClassName<C>::Remove(ID const id, typename FindFunc<ID>::Fun
         int32 middle = (low + high) / 2;
 
         //check relation of the id we're looking for and the middle item
-        int32 relation = findFunc(id, (C const **)&items[middle]);
+        int32 relation = findFunc(id, items[middle]);
 
         //check if item with that id is before middle
         if (relation < 0)
@@ -603,14 +1382,8 @@ C *ArrayPointerImpl_ClassName<C>::Remove(ID const id, typename FindFunc<ID>::Fun
             continue;
         }
 
-        //the item we want is right here at middle index
-        C *item = items[middle];
-
-        //remove it from the array
-        ((Super *)this)->Remove(middle);
-
-        //return the item
-        return item;
+        //the item we want is right here at middle index, remove it from the array
+        return Remove(middle);
     }
 
     //didnt find it anywhere
@@ -623,3 +1396,7 @@ C *ArrayPointerImpl_ClassName<C>::Remove(ID const id, typename FindFunc<ID>::Fun
 #undef ArrayPointerImpl_Owner
 #undef ArrayPointerImpl_Queue
 #undef ArrayPointerImpl_Sorted
+#undef ArrayPointerImpl_Inline
+#undef ArrayPointerImpl_Ordered
+#undef ArrayPointerImpl_Template
+#undef ArrayPointerImpl_Type
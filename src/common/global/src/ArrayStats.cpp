@@ -0,0 +1,230 @@
+//
+// v1 - Prototype character/item/tradeskill game.
+// Copyright (C) 2013 Adam Hayek (adam.hayek@gmail.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see [http://www.gnu.org/licenses/].
+//
+
+#include <windows.h>
+#include <stdlib.h>
+#include "common\global\global.h"
+#include "common\global\ArrayStats.h"
+#include "common\global\SpinLock.h"
+
+#if defined(__CONFIG_ARRAY_STATS)
+
+//how many records of each kind the report lists
+#define ARRAY_STATS_REPORT_NUM 16
+
+//
+//local data
+//
+
+//protects the lists below, arrays are made and destroyed on every thread
+static SpinLock arrayStatsLock;
+
+//the live arrays
+static ArrayStats *arrayStatsFirst = NULL;
+
+//the counts of destroyed arrays, one record per place and type
+static ArrayStatsCounts *arrayStatsRetired = NULL;
+static int32 arrayStatsNumRetired = 0;
+static int32 arrayStatsMaxRetired = 0;
+
+
+//
+//local functions
+//
+
+//adds counts into the record with the same place and type, or a new record at the end.
+//The records must have room for one more.
+static void ArrayStatsMerge(ArrayStatsCounts *records, int32 &num, ArrayStatsCounts const &counts)
+{
+    //look for a record of the same place and type
+    for (int32 i = 0; i < num; i++)
+    {
+        //check if this is it
+        ArrayStatsCounts &record = records[i];
+        if (record.place == counts.place && record.typeName == counts.typeName)
+        {
+            //add the counts to it
+            record.instances += counts.instances;
+            record.resizes += counts.resizes;
+            record.bytesAllocated += counts.bytesAllocated;
+            record.adds += counts.adds;
+            record.removes += counts.removes;
+            bound_min(record.peakNum, counts.peakNum);
+            bound_min(record.peakMax, counts.peakMax);
+            return;
+        }
+    }
+
+    //first one, add a record
+    records[num++] = counts;
+}
+
+//bytes reserved but never used at the peak
+static int64 ArrayStatsWasted(ArrayStatsCounts const &counts)
+{
+    //inline arrays which never allocated have no peak capacity
+    int64 wasted = int64(counts.peakMax - counts.peakNum) * counts.itemSize;
+    return (wasted > 0) ? wasted : 0;
+}
+
+//qsort function, most resizes first
+static int ArrayStatsCompareResizes(void const *left, void const *right)
+{
+    return ((ArrayStatsCounts const *)right)->resizes - ((ArrayStatsCounts const *)left)->resizes;
+}
+
+//qsort function, most wasted bytes first
+static int ArrayStatsCompareWasted(void const *left, void const *right)
+{
+    int64 leftWasted = ArrayStatsWasted(*(ArrayStatsCounts const *)left);
+    int64 rightWasted = ArrayStatsWasted(*(ArrayStatsCounts const *)right);
+    return (rightWasted > leftWasted) ? 1 : ((rightWasted < leftWasted) ? -1 : 0);
+}
+
+//writes a line for each of the first records
+static void ArrayStatsWrite(char const *title, ArrayStatsCounts const *records, int32 num)
+{
+    //heading
+    OutputDebugStringA(title);
+
+    //the worst ones
+    for (int32 i = 0; i < num && i < ARRAY_STATS_REPORT_NUM; i++)
+    {
+        ArrayStatsCounts const &record = records[i];
+        buffer512 line;
+        line.Set("  %s x%d at %s: %d resizes, %I64d bytes allocated, peak %d of %d, %I64d wasted bytes, %I64d adds, %I64d removes\n",
+            record.typeName, record.instances, (record.place != NULL) ? record.place->Description() : "(untagged)",
+            record.resizes, record.bytesAllocated, record.peakNum, record.peakMax, ArrayStatsWasted(record), record.adds, record.removes);
+        OutputDebugStringA(line);
+    }
+}
+
+//report when the program ends
+TERM(ArrayStats)
+{
+    ArrayStats::Report();
+}
+
+
+//
+//ArrayStats functions
+//
+
+ArrayStats::ArrayStats(char const *typeName, int32 itemSize)
+{
+    //nothing counted yet
+    memset(&counts, 0, sizeof(counts));
+    counts.typeName = typeName;
+    counts.itemSize = itemSize;
+    counts.instances = 1;
+
+    //add us to the front of the live list
+    SpinLockScope scope(arrayStatsLock);
+    prev = NULL;
+    next = arrayStatsFirst;
+    if (next != NULL)
+    {
+        next->prev = this;
+    }
+    arrayStatsFirst = this;
+}
+
+ArrayStats::~ArrayStats()
+{
+    SpinLockScope scope(arrayStatsLock);
+
+    //take us out of the live list
+    if (prev != NULL)
+    {
+        prev->next = next;
+    }
+    else
+    {
+        arrayStatsFirst = next;
+    }
+    if (next != NULL)
+    {
+        next->prev = prev;
+    }
+
+    //check if we were never used, those aren't worth keeping
+    if (counts.adds == 0 && counts.resizes == 0)
+    {
+        return;
+    }
+
+    //make sure there is room for another record
+    if (arrayStatsNumRetired >= arrayStatsMaxRetired)
+    {
+        int32 newMax = (arrayStatsMaxRetired < 64) ? 64 : arrayStatsMaxRetired * 2;
+        ArrayStatsCounts *newRetired = (ArrayStatsCounts *)realloc(arrayStatsRetired, sizeof(ArrayStatsCounts) * newMax);
+        IFBREAKRETURN(newRetired == NULL);
+        arrayStatsRetired = newRetired;
+        arrayStatsMaxRetired = newMax;
+    }
+
+    //keep our counts
+    ArrayStatsMerge(arrayStatsRetired, arrayStatsNumRetired, counts);
+}
+
+void ArrayStats::Report()
+{
+    //copy the records, so we don't hold the lock while writing
+    ArrayStatsCounts *records = NULL;
+    int32 num = 0;
+    {
+        SpinLockScope scope(arrayStatsLock);
+
+        //count the live arrays
+        int32 numLive = 0;
+        for (ArrayStats *stats = arrayStatsFirst; stats != NULL; stats = stats->next)
+        {
+            numLive++;
+        }
+
+        //room for everything
+        records = (ArrayStatsCounts *)malloc(sizeof(ArrayStatsCounts) * (arrayStatsNumRetired + numLive + 1));
+        IFBREAKRETURN(records == NULL);
+
+        //the destroyed arrays are already merged
+        memcpy(records, arrayStatsRetired, sizeof(ArrayStatsCounts) * arrayStatsNumRetired);
+        num = arrayStatsNumRetired;
+
+        //merge in the live ones that were used
+        for (ArrayStats *stats = arrayStatsFirst; stats != NULL; stats = stats->next)
+        {
+            if (stats->counts.adds != 0 || stats->counts.resizes != 0)
+            {
+                ArrayStatsMerge(records, num, stats->counts);
+            }
+        }
+    }
+
+    //the arrays that reallocate the most
+    qsort(records, num, sizeof(ArrayStatsCounts), ArrayStatsCompareResizes);
+    ArrayStatsWrite("Arrays with the most resizes:\n", records, num);
+
+    //the arrays that reserve the most they never use
+    qsort(records, num, sizeof(ArrayStatsCounts), ArrayStatsCompareWasted);
+    ArrayStatsWrite("Arrays with the most unused capacity:\n", records, num);
+
+    //done with the copy
+    free(records);
+}
+
+#endif
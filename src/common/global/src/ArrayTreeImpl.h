@@ -0,0 +1,987 @@
+//
+// v1 - Prototype character/item/tradeskill game.
+// Copyright (C) 2013 Adam Hayek (adam.hayek@gmail.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see [http://www.gnu.org/licenses/].
+//
+
+//We include this file multiple times in order to create different tree array types.
+//
+//  Basic options set with #define:
+//  - ArrayTreeImpl_ClassName
+//      name of the array class we're implementing
+//  - ArrayTreeImpl_Owner
+//      present if we want our implementation to own the objects and be responsible for deleting them
+//      Changes destructor, Empty, Reset to O(n)
+//
+//The tree is a B+tree.  Leaves hold up to LeafMax item pointers and are linked to the next leaf, so
+//walking the items in order only reads leaves.  Inner nodes hold, for each child, the child's first item
+//and the number of items under it.  The first items steer searches, and the counts let us find the
+//item at an index, or the index of an item, by adding up counts on the way down.
+//
+//Every node except the root is kept at least half full.  Adding or removing an item only changes the
+//nodes on the path from the root to its leaf, plus at most one neighbour of each of them.
+//
+//This is implemented this way to achieve the highest level of code reuse (not creating the same function multiple times)
+//while creating classes which are easy to look at inside the debugger.  If a class heirarchy was used instead, data members
+//are buried at the base of the class tree and possibly multiple base classes must be opened in order to view them.
+//
+
+template <class C>
+class ArrayTreeImpl_ClassName
+{
+private:
+    ArrayTreeImpl_ClassName(ArrayTreeImpl_ClassName const &other);
+public:
+    ArrayTreeImpl_ClassName();
+    ~ArrayTreeImpl_ClassName();
+
+    //
+    //Sorted array function pointer types, the same as ArraySorted's.
+    //
+
+    //compare function type.  The parameters are double pointers so the same functions work with ArraySorted.
+    typedef int32 (*CompareFunc)(C const **item1, C const **item2);
+
+    //similar to the CompareFunc, but passes an identifier instead of the first item.
+    template <class ID>
+    class FindFunc { public:
+        typedef int32 (*Func)(ID const id, C const *item);
+    };
+
+    class iterator;
+
+    //
+    //member access functions
+    //
+public:
+    //number of items in the tree.
+    int32 Num() const;
+
+    //gets the item at the given index in sorted order.  O(log(n)).
+    C *Get(int32 index);
+
+    //
+    //Add, remove and find items.  All are O(log(n)).
+    //
+public:
+    //adds an item in sorted order.  Returns false if an equal item is already in the tree, in which case the item is not added.
+    bool Add(C *item, CompareFunc compareFunc);
+
+    //removes an item given its index, identifier, or an equal item.  The object's lifetime must be then managed by the caller.
+    //returns NULL if there is no such item.
+    C *Remove(int32 index);
+    template <class ID>
+    C *Remove(ID const id, typename FindFunc<ID>::Func findFunc);
+    C *Remove(C const *item, CompareFunc compareFunc);
+
+    //finds the item that matches the given identifier, or the given item.  returns NULL if no item matches.
+    template <class ID>
+    C *Find(ID const id, typename FindFunc<ID>::Func findFunc);
+    C *Find(C const *item, CompareFunc compareFunc);
+
+    //returns the number of items before the given identifier or item, which is the index it has or would have.
+    template <class ID>
+    int32 Rank(ID const id, typename FindFunc<ID>::Func findFunc) const;
+    int32 Rank(C const *item, CompareFunc compareFunc) const;
+
+    //
+    //In order iteration.  Iterators are only valid until the tree is next changed.
+    //
+public:
+    //the first item, and past the last item.
+    iterator begin();
+    iterator end();
+
+    //the item at the given index.  O(log(n)).
+    iterator At(int32 index);
+
+    //the first item which is not before the given identifier or item, for walking a range of items.
+    template <class ID>
+    iterator LowerBound(ID const id, typename FindFunc<ID>::Func findFunc);
+    iterator LowerBound(C const *item, CompareFunc compareFunc);
+
+    //
+    //Functions to clear the tree.
+    //
+public:
+    //remove all items from the tree and free all nodes.
+    void Reset();
+
+    //same as Reset, the tree keeps no spare nodes.
+    void Empty();
+
+private:
+    enum
+    {
+        //most item pointers in a leaf, and children of an inner node.  Nodes may go one over while they are being split.
+        LeafMax = 64,
+        InnerMax = 32
+    };
+
+    //parts common to both node types
+    struct Node
+    {
+        //number of items or children
+        int32 num;
+
+        //true for leaves
+        bool leaf;
+    };
+
+    //bottom level node, which holds the items
+    struct Leaf : public Node
+    {
+        //next leaf in order, or NULL for the last
+        Leaf *next;
+
+        //our items in sorted order
+        C *items[LeafMax + 1];
+    };
+
+    //node above the leaves
+    struct Inner : public Node
+    {
+        //first item under each child
+        C *firsts[InnerMax + 1];
+
+        //number of items under each child
+        int32 counts[InnerMax + 1];
+
+        //our children
+        Node *children[InnerMax + 1];
+    };
+
+    //compares items with a FindFunc, returns more than 0 if the item is before the identifier.
+    template <class ID>
+    class CompareID { public:
+        CompareID(ID const id, typename FindFunc<ID>::Func findFunc) : id(id), findFunc(findFunc) {}
+        inline int32 operator()(C const *item) const { return findFunc(id, item); }
+        ID const id;
+        typename FindFunc<ID>::Func findFunc;
+    };
+
+    //compares items with a CompareFunc, returns more than 0 if the item is before the given one.
+    class CompareItem { public:
+        CompareItem(C const *item, CompareFunc compareFunc) : item(item), compareFunc(compareFunc) {}
+        inline int32 operator()(C const *other) const { C const *left = item; return compareFunc(&left, &other); }
+        C const *item;
+        CompareFunc compareFunc;
+    };
+
+    //finds the leaf and position of the first item which is not before the one compare looks for, and its index.
+    //position may be the leaf's num if the item would be at the start of the next leaf.
+    template <class Compare>
+    Leaf *Search(Compare const &compare, int32 &position, int32 &index) const;
+
+    //index of the child of an inner node that the first item not before the one compare looks for is under.
+    //If orEqual is true, a child starting with an equal item is picked instead of the one before it, which
+    //is where a new item goes.
+    template <class Compare>
+    static int32 SearchInner(Inner const *inner, Compare const &compare, bool orEqual);
+
+    //index in a leaf of the first item which is not before the one compare looks for.
+    template <class Compare>
+    static int32 SearchLeaf(Leaf const *leaf, Compare const &compare);
+
+    //finds the item compare looks for, and its index.
+    template <class Compare>
+    C *FindItem(Compare const &compare, int32 &index) const;
+
+    //adds an item under the node.  Returns the new node to its right if the node had to split.
+    Node *AddTo(Node *node, C *item, CompareItem const &compare, bool &added);
+
+    //removes the item at the given index under the node.
+    C *RemoveFrom(Node *node, int32 index);
+
+    //fixes a child of an inner node which has fallen under half full, by borrowing from or merging with a neighbour.
+    void Rebalance(Inner *inner, int32 childIndex);
+
+    //the first item under a node
+    static inline C *First(Node const *node);
+
+    //total items under a node
+    static int32 Count(Node const *node);
+
+    //deletes a node and everything under it
+    void FreeNode(Node *node);
+
+    //top of the tree, or NULL if we have no items
+    Node *root;
+
+    //number of items in the tree
+    int32 num;
+};
+
+//
+//ArrayTreeImpl_ClassName::iterator walks the items in order, leaf by leaf.
+//
+template <class C>
+class ArrayTreeImpl_ClassName<C>::iterator
+{
+public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef C *value_type;
+    typedef ptrdiff_t difference_type;
+    typedef C *const *pointer;
+    typedef C *const &reference;
+
+    inline iterator() : leaf(NULL), position(0) {}
+    inline iterator(Leaf *leaf, int32 position) : leaf(leaf), position(position) { Normalize(); }
+
+    //item access
+    inline C *const &operator*() const { return leaf->items[position]; }
+
+    //movement
+    inline iterator &operator++() { position++; Normalize(); return *this; }
+    inline iterator operator++(int) { iterator old = *this; ++*this; return old; }
+
+    //comparisons
+    inline bool operator==(iterator const &other) const { return leaf == other.leaf && position == other.position; }
+    inline bool operator!=(iterator const &other) const { return !(*this == other); }
+
+private:
+    //moves to the next leaf if we are past the end of this one.
+    inline void Normalize()
+    {
+        if (leaf != NULL && position >= leaf->num)
+        {
+            leaf = leaf->next;
+            position = 0;
+        }
+    }
+
+    //where we are
+    Leaf *leaf;
+    int32 position;
+};
+
+
+//
+//ArrayTreeImpl_ClassName template functions
+//
+
+template <class C>
+ArrayTreeImpl_ClassName<C>::ArrayTreeImpl_ClassName()
+{
+    //no items
+    root = NULL;
+    num = 0;
+}
+
+template <class C>
+ArrayTreeImpl_ClassName<C>::~ArrayTreeImpl_ClassName()
+{
+    //free everything
+    Reset();
+}
+
+template <class C>
+int32 ArrayTreeImpl_ClassName<C>::Num() const
+{
+    return num;
+}
+
+template <class C>
+C *ArrayTreeImpl_ClassName<C>::Get(int32 index)
+{
+    IFBREAKNULL(index < 0 || index >= num);
+
+    //find it
+    iterator it = At(index);
+    return *it;
+}
+
+template <class C>
+bool ArrayTreeImpl_ClassName<C>::Add(C *item, CompareFunc compareFunc)
+{
+    IFBREAKFALSE(item == NULL);
+    IFBREAKFALSE(compareFunc == NULL);
+
+    //check if this is our first item
+    if (root == NULL)
+    {
+        //start with a single leaf
+        Leaf *leaf = new Leaf();
+        IFBREAKFALSE(leaf == NULL);
+        leaf->num = 0;
+        leaf->leaf = true;
+        leaf->next = NULL;
+        root = leaf;
+    }
+
+    //add it
+    bool added = false;
+    Node *right = AddTo(root, item, CompareItem(item, compareFunc), added);
+
+    //check if the root split
+    if (right != NULL)
+    {
+        //make a new root above the two halves
+        Inner *inner = new Inner();
+        IFBREAKFALSE(inner == NULL);
+        inner->leaf = false;
+        inner->num = 2;
+        inner->children[0] = root;
+        inner->children[1] = right;
+        inner->firsts[0] = First(root);
+        inner->firsts[1] = First(right);
+        inner->counts[0] = Count(root);
+        inner->counts[1] = Count(right);
+        root = inner;
+    }
+
+    //check if it was already here
+    if (added == false)
+    {
+        BREAK1();
+        return false;
+    }
+
+    //one more item
+    num++;
+    return true;
+}
+
+template <class C>
+C *ArrayTreeImpl_ClassName<C>::Remove(int32 index)
+{
+    IFBREAKNULL(index < 0 || index >= num);
+
+    //remove it
+    C *item = RemoveFrom(root, index);
+    num--;
+
+    //check if the root has a single child left
+    while (root->leaf == false && root->num == 1)
+    {
+        //the child becomes the root
+        Inner *inner = (Inner *)root;
+        root = inner->children[0];
+        delete inner;
+    }
+
+    //check if we are empty
+    if (num == 0)
+    {
+        //free the last leaf
+        delete (Leaf *)root;
+        root = NULL;
+    }
+
+    //return the item
+    return item;
+}
+
+template <class C> template <class ID>
+C *ArrayTreeImpl_ClassName<C>::Remove(ID const id, typename FindFunc<ID>::Func findFunc)
+{
+    IFBREAKNULL(findFunc == NULL);
+
+    //find its index
+    int32 index = 0;
+    if (FindItem(CompareID<ID>(id, findFunc), index) == NULL)
+    {
+        return NULL;
+    }
+
+    //remove it
+    return Remove(index);
+}
+
+template <class C>
+C *ArrayTreeImpl_ClassName<C>::Remove(C const *item, CompareFunc compareFunc)
+{
+    IFBREAKNULL(item == NULL || compareFunc == NULL);
+
+    //find its index
+    int32 index = 0;
+    if (FindItem(CompareItem(item, compareFunc), index) == NULL)
+    {
+        return NULL;
+    }
+
+    //remove it
+    return Remove(index);
+}
+
+template <class C> template <class ID>
+C *ArrayTreeImpl_ClassName<C>::Find(ID const id, typename FindFunc<ID>::Func findFunc)
+{
+    IFBREAKNULL(findFunc == NULL);
+
+    //search for it
+    int32 index = 0;
+    return FindItem(CompareID<ID>(id, findFunc), index);
+}
+
+template <class C>
+C *ArrayTreeImpl_ClassName<C>::Find(C const *item, CompareFunc compareFunc)
+{
+    IFBREAKNULL(item == NULL || compareFunc == NULL);
+
+    //search for it
+    int32 index = 0;
+    return FindItem(CompareItem(item, compareFunc), index);
+}
+
+template <class C> template <class ID>
+int32 ArrayTreeImpl_ClassName<C>::Rank(ID const id, typename FindFunc<ID>::Func findFunc) const
+{
+    IFBREAKRETURNVAL(findFunc == NULL, 0);
+
+    //the index of the first item not before it
+    int32 position = 0, index = 0;
+    Search(CompareID<ID>(id, findFunc), position, index);
+    return index;
+}
+
+template <class C>
+int32 ArrayTreeImpl_ClassName<C>::Rank(C const *item, CompareFunc compareFunc) const
+{
+    IFBREAKRETURNVAL(item == NULL || compareFunc == NULL, 0);
+
+    //the index of the first item not before it
+    int32 position = 0, index = 0;
+    Search(CompareItem(item, compareFunc), position, index);
+    return index;
+}
+
+template <class C>
+typename ArrayTreeImpl_ClassName<C>::iterator ArrayTreeImpl_ClassName<C>::begin()
+{
+    //check if we have no items
+    if (root == NULL)
+    {
+        return end();
+    }
+
+    //go down the left side
+    Node *node = root;
+    while (node->leaf == false)
+    {
+        node = ((Inner *)node)->children[0];
+    }
+    return iterator((Leaf *)node, 0);
+}
+
+template <class C>
+typename ArrayTreeImpl_ClassName<C>::iterator ArrayTreeImpl_ClassName<C>::end()
+{
+    return iterator();
+}
+
+template <class C>
+typename ArrayTreeImpl_ClassName<C>::iterator ArrayTreeImpl_ClassName<C>::At(int32 index)
+{
+    //check if it's past the end
+    if (index < 0 || index >= num)
+    {
+        return end();
+    }
+
+    //go down, skipping the children which are entirely before the index
+    Node *node = root;
+    while (node->leaf == false)
+    {
+        Inner *inner = (Inner *)node;
+        int32 child = 0;
+        while (index >= inner->counts[child])
+        {
+            index -= inner->counts[child];
+            child++;
+        }
+        node = inner->children[child];
+    }
+
+    //it's in this leaf
+    return iterator((Leaf *)node, index);
+}
+
+template <class C> template <class ID>
+typename ArrayTreeImpl_ClassName<C>::iterator ArrayTreeImpl_ClassName<C>::LowerBound(ID const id, typename FindFunc<ID>::Func findFunc)
+{
+    IFBREAKRETURNVAL(findFunc == NULL, end());
+
+    //find the first item not before it
+    int32 position = 0, index = 0;
+    Leaf *leaf = Search(CompareID<ID>(id, findFunc), position, index);
+    return iterator(leaf, position);
+}
+
+template <class C>
+typename ArrayTreeImpl_ClassName<C>::iterator ArrayTreeImpl_ClassName<C>::LowerBound(C const *item, CompareFunc compareFunc)
+{
+    IFBREAKRETURNVAL(item == NULL || compareFunc == NULL, end());
+
+    //find the first item not before it
+    int32 position = 0, index = 0;
+    Leaf *leaf = Search(CompareItem(item, compareFunc), position, index);
+    return iterator(leaf, position);
+}
+
+template <class C>
+void ArrayTreeImpl_ClassName<C>::Reset()
+{
+    //free all nodes, and items if we own them
+    if (root != NULL)
+    {
+        FreeNode(root);
+        root = NULL;
+    }
+    num = 0;
+}
+
+template <class C>
+void ArrayTreeImpl_ClassName<C>::Empty()
+{
+    //we don't keep spare nodes
+    Reset();
+}
+
+template <class C> template <class Compare>
+typename ArrayTreeImpl_ClassName<C>::Leaf *ArrayTreeImpl_ClassName<C>::Search(Compare const &compare, int32 &position, int32 &index) const
+{
+    //start at the top
+    position = 0;
+    index = 0;
+    if (root == NULL)
+    {
+        return NULL;
+    }
+
+    //go down the inner nodes
+    Node *node = root;
+    while (node->leaf == false)
+    {
+        Inner *inner = (Inner *)node;
+
+        //pick the child
+        int32 child = SearchInner(inner, compare, false);
+
+        //count the items in the children before it
+        for (int32 i = 0; i < child; i++)
+        {
+            index += inner->counts[i];
+        }
+
+        //go down
+        node = inner->children[child];
+    }
+
+    //find the position in the leaf
+    Leaf *leaf = (Leaf *)node;
+    position = SearchLeaf(leaf, compare);
+    index += position;
+    return leaf;
+}
+
+template <class C> template <class Compare>
+int32 ArrayTreeImpl_ClassName<C>::SearchInner(Inner const *inner, Compare const &compare, bool orEqual)
+{
+    //find the first child after 0 whose first item is after the one we want, or not before it if not orEqual
+    int32 low = 1;
+    int32 high = inner->num;
+    int32 lowest = orEqual ? 0 : 1;
+    while (low < high)
+    {
+        int32 middle = (low + high) / 2;
+        if (compare(inner->firsts[middle]) >= lowest)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    //the one we want is under the child before that one
+    return low - 1;
+}
+
+template <class C> template <class Compare>
+int32 ArrayTreeImpl_ClassName<C>::SearchLeaf(Leaf const *leaf, Compare const &compare)
+{
+    //find the first item which is not before the one we want
+    int32 low = 0;
+    int32 high = leaf->num;
+    while (low < high)
+    {
+        int32 middle = (low + high) / 2;
+        if (compare(leaf->items[middle]) > 0)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+template <class C> template <class Compare>
+C *ArrayTreeImpl_ClassName<C>::FindItem(Compare const &compare, int32 &index) const
+{
+    //find the first item not before it
+    int32 position = 0;
+    Leaf *leaf = Search(compare, position, index);
+    if (leaf == NULL)
+    {
+        return NULL;
+    }
+
+    //it may be at the start of the next leaf
+    if (position >= leaf->num)
+    {
+        leaf = leaf->next;
+        position = 0;
+        if (leaf == NULL)
+        {
+            return NULL;
+        }
+    }
+
+    //check if it's the one
+    C *item = leaf->items[position];
+    return (compare(item) == 0) ? item : NULL;
+}
+
+template <class C>
+typename ArrayTreeImpl_ClassName<C>::Node *ArrayTreeImpl_ClassName<C>::AddTo(Node *node, C *item, CompareItem const &compare, bool &added)
+{
+    //check if this is a leaf
+    if (node->leaf)
+    {
+        Leaf *leaf = (Leaf *)node;
+
+        //find where it goes
+        int32 position = SearchLeaf(leaf, compare);
+
+        //check if an equal item is already here
+        if (position < leaf->num && compare(leaf->items[position]) == 0)
+        {
+            added = false;
+            return NULL;
+        }
+
+        //move the later items over and put it in
+        memmove(&leaf->items[position + 1], &leaf->items[position], sizeof(C *) * (leaf->num - position));
+        leaf->items[position] = item;
+        leaf->num++;
+        added = true;
+
+        //check if we are still small enough
+        if (leaf->num <= LeafMax)
+        {
+            return NULL;
+        }
+
+        //split off the top half to a new leaf after us
+        Leaf *right = new Leaf();
+        IFBREAKNULL(right == NULL);
+        right->leaf = true;
+        right->num = leaf->num / 2;
+        leaf->num -= right->num;
+        memcpy(right->items, &leaf->items[leaf->num], sizeof(C *) * right->num);
+        right->next = leaf->next;
+        leaf->next = right;
+        return right;
+    }
+
+    //find the child it goes under
+    Inner *inner = (Inner *)node;
+    int32 child = SearchInner(inner, compare, true);
+
+    //add it there
+    Node *right = AddTo(inner->children[child], item, compare, added);
+    if (added == false)
+    {
+        return NULL;
+    }
+
+    //the child has one more item, and may have a new first
+    inner->counts[child]++;
+    inner->firsts[child] = First(inner->children[child]);
+
+    //check if the child split
+    if (right == NULL)
+    {
+        return NULL;
+    }
+
+    //put the new node after the child
+    int32 moveNum = inner->num - child - 1;
+    memmove(&inner->children[child + 2], &inner->children[child + 1], sizeof(Node *) * moveNum);
+    memmove(&inner->firsts[child + 2], &inner->firsts[child + 1], sizeof(C *) * moveNum);
+    memmove(&inner->counts[child + 2], &inner->counts[child + 1], sizeof(int32) * moveNum);
+    inner->children[child + 1] = right;
+    inner->firsts[child + 1] = First(right);
+    inner->counts[child + 1] = Count(right);
+    inner->counts[child] -= inner->counts[child + 1];
+    inner->num++;
+
+    //check if we are still small enough
+    if (inner->num <= InnerMax)
+    {
+        return NULL;
+    }
+
+    //split off the top half to a new inner node
+    Inner *newInner = new Inner();
+    IFBREAKNULL(newInner == NULL);
+    newInner->leaf = false;
+    newInner->num = inner->num / 2;
+    inner->num -= newInner->num;
+    memcpy(newInner->children, &inner->children[inner->num], sizeof(Node *) * newInner->num);
+    memcpy(newInner->firsts, &inner->firsts[inner->num], sizeof(C *) * newInner->num);
+    memcpy(newInner->counts, &inner->counts[inner->num], sizeof(int32) * newInner->num);
+    return newInner;
+}
+
+template <class C>
+C *ArrayTreeImpl_ClassName<C>::RemoveFrom(Node *node, int32 index)
+{
+    //check if this is a leaf
+    if (node->leaf)
+    {
+        Leaf *leaf = (Leaf *)node;
+
+        //take the item out and close the gap
+        C *item = leaf->items[index];
+        leaf->num--;
+        memmove(&leaf->items[index], &leaf->items[index + 1], sizeof(C *) * (leaf->num - index));
+        return item;
+    }
+
+    //find the child it is under
+    Inner *inner = (Inner *)node;
+    int32 child = 0;
+    while (index >= inner->counts[child])
+    {
+        index -= inner->counts[child];
+        child++;
+    }
+
+    //remove it from there
+    C *item = RemoveFrom(inner->children[child], index);
+    inner->counts[child]--;
+
+    //check if the child is too small now
+    Node *childNode = inner->children[child];
+    if (childNode->num < (childNode->leaf ? LeafMax / 2 : InnerMax / 2) && inner->num > 1)
+    {
+        Rebalance(inner, child);
+    }
+    else if (childNode->num > 0)
+    {
+        //its first item may have changed
+        inner->firsts[child] = First(childNode);
+    }
+
+    //return the item
+    return item;
+}
+
+template <class C>
+void ArrayTreeImpl_ClassName<C>::Rebalance(Inner *inner, int32 childIndex)
+{
+    //use the neighbour on the left, unless we are the first child
+    int32 leftIndex = (childIndex > 0) ? childIndex - 1 : childIndex;
+    int32 rightIndex = leftIndex + 1;
+    Node *left = inner->children[leftIndex];
+    Node *right = inner->children[rightIndex];
+
+    //the number of items or children each node must have
+    int32 minNum = left->leaf ? LeafMax / 2 : InnerMax / 2;
+
+    //check if the neighbour can spare one
+    bool borrow = (left->num + right->num) > minNum * 2;
+
+    if (left->leaf)
+    {
+        Leaf *leftLeaf = (Leaf *)left;
+        Leaf *rightLeaf = (Leaf *)right;
+
+        if (borrow)
+        {
+            //check which way to move one
+            if (leftLeaf->num > rightLeaf->num)
+            {
+                //move the last of the left to the front of the right
+                memmove(&rightLeaf->items[1], &rightLeaf->items[0], sizeof(C *) * rightLeaf->num);
+                rightLeaf->items[0] = leftLeaf->items[--leftLeaf->num];
+                rightLeaf->num++;
+                inner->counts[leftIndex]--;
+                inner->counts[rightIndex]++;
+            }
+            else
+            {
+                //move the first of the right to the end of the left
+                leftLeaf->items[leftLeaf->num++] = rightLeaf->items[0];
+                rightLeaf->num--;
+                memmove(&rightLeaf->items[0], &rightLeaf->items[1], sizeof(C *) * rightLeaf->num);
+                inner->counts[leftIndex]++;
+                inner->counts[rightIndex]--;
+            }
+        }
+        else
+        {
+            //move everything from the right into the left
+            memcpy(&leftLeaf->items[leftLeaf->num], rightLeaf->items, sizeof(C *) * rightLeaf->num);
+            leftLeaf->num += rightLeaf->num;
+            leftLeaf->next = rightLeaf->next;
+            rightLeaf->num = 0;
+        }
+    }
+    else
+    {
+        Inner *leftInner = (Inner *)left;
+        Inner *rightInner = (Inner *)right;
+
+        if (borrow)
+        {
+            //check which way to move one
+            if (leftInner->num > rightInner->num)
+            {
+                //move the last child of the left to the front of the right
+                int32 last = --leftInner->num;
+                memmove(&rightInner->children[1], &rightInner->children[0], sizeof(Node *) * rightInner->num);
+                memmove(&rightInner->firsts[1], &rightInner->firsts[0], sizeof(C *) * rightInner->num);
+                memmove(&rightInner->counts[1], &rightInner->counts[0], sizeof(int32) * rightInner->num);
+                rightInner->children[0] = leftInner->children[last];
+                rightInner->firsts[0] = leftInner->firsts[last];
+                rightInner->counts[0] = leftInner->counts[last];
+                rightInner->num++;
+                inner->counts[leftIndex] -= rightInner->counts[0];
+                inner->counts[rightIndex] += rightInner->counts[0];
+            }
+            else
+            {
+                //move the first child of the right to the end of the left
+                int32 last = leftInner->num++;
+                leftInner->children[last] = rightInner->children[0];
+                leftInner->firsts[last] = rightInner->firsts[0];
+                leftInner->counts[last] = rightInner->counts[0];
+                rightInner->num--;
+                memmove(&rightInner->children[0], &rightInner->children[1], sizeof(Node *) * rightInner->num);
+                memmove(&rightInner->firsts[0], &rightInner->firsts[1], sizeof(C *) * rightInner->num);
+                memmove(&rightInner->counts[0], &rightInner->counts[1], sizeof(int32) * rightInner->num);
+                inner->counts[leftIndex] += leftInner->counts[last];
+                inner->counts[rightIndex] -= leftInner->counts[last];
+            }
+        }
+        else
+        {
+            //move every child from the right into the left
+            memcpy(&leftInner->children[leftInner->num], rightInner->children, sizeof(Node *) * rightInner->num);
+            memcpy(&leftInner->firsts[leftInner->num], rightInner->firsts, sizeof(C *) * rightInner->num);
+            memcpy(&leftInner->counts[leftInner->num], rightInner->counts, sizeof(int32) * rightInner->num);
+            leftInner->num += rightInner->num;
+            rightInner->num = 0;
+        }
+    }
+
+    //check if we merged
+    if (borrow == false)
+    {
+        //the left has everything now
+        inner->counts[leftIndex] += inner->counts[rightIndex];
+
+        //remove the right from our children
+        int32 moveNum = inner->num - rightIndex - 1;
+        memmove(&inner->children[rightIndex], &inner->children[rightIndex + 1], sizeof(Node *) * moveNum);
+        memmove(&inner->firsts[rightIndex], &inner->firsts[rightIndex + 1], sizeof(C *) * moveNum);
+        memmove(&inner->counts[rightIndex], &inner->counts[rightIndex + 1], sizeof(int32) * moveNum);
+        inner->num--;
+
+        //free it, it has nothing under it now
+        if (right->leaf)
+        {
+            delete (Leaf *)right;
+        }
+        else
+        {
+            delete (Inner *)right;
+        }
+    }
+    else
+    {
+        //the right's first item changed
+        inner->firsts[rightIndex] = First(right);
+    }
+
+    //the left's first item may have changed if the removed item was its first
+    inner->firsts[leftIndex] = First(left);
+}
+
+template <class C>
+C *ArrayTreeImpl_ClassName<C>::First(Node const *node)
+{
+    return node->leaf ? ((Leaf const *)node)->items[0] : ((Inner const *)node)->firsts[0];
+}
+
+template <class C>
+int32 ArrayTreeImpl_ClassName<C>::Count(Node const *node)
+{
+    //a leaf has its items
+    if (node->leaf)
+    {
+        return node->num;
+    }
+
+    //add up the children
+    Inner const *inner = (Inner const *)node;
+    int32 count = 0;
+    for (int32 i = 0; i < inner->num; i++)
+    {
+        count += inner->counts[i];
+    }
+    return count;
+}
+
+template <class C>
+void ArrayTreeImpl_ClassName<C>::FreeNode(Node *node)
+{
+    //check if this is a leaf
+    if (node->leaf)
+    {
+        Leaf *leaf = (Leaf *)node;
+
+        #ifdef ArrayTreeImpl_Owner
+        //delete our items
+        for (int32 i = 0; i < leaf->num; i++)
+        {
+            delc(leaf->items[i]);
+        }
+        #endif
+
+        //free it
+        delete leaf;
+        return;
+    }
+
+    //free the children, then us
+    Inner *inner = (Inner *)node;
+    for (int32 i = 0; i < inner->num; i++)
+    {
+        FreeNode(inner->children[i]);
+    }
+    delete inner;
+}
+
+
+#undef ArrayTreeImpl_ClassName
+#undef ArrayTreeImpl_Owner
@@ -0,0 +1,977 @@
+//
+// v1 - Prototype character/item/tradeskill game.
+// Copyright (C) 2013 Adam Hayek (adam.hayek@gmail.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see [http://www.gnu.org/licenses/].
+//
+
+//We include this file multiple times in order to create different array types.
+//
+//  Basic options set with #define:
+//  - ArrayValueImpl_ClassName
+//      name of the array class we're implementing
+//  - ArrayValueImpl_Queue
+//      Present if we want our implementation to preseve the order of items when items are removed.
+//      The items are stored in a circular buffer, so the front of the array can move.
+//      Changes Remove to be O(n), but only the items on the shorter side of the removed one are moved,
+//      so removing the first or last item is O(1).
+//      Adds O(1) PushBack, PushFront and PopFront.
+//  - ArrayValueImpl_Sorted
+//      Adds functions to support O(log(n)) searching for items.
+//      Preserves the order of items when items are removed, but the items always start at index 0 of the storage.
+//
+//Items are stored inside the array's storage, not as pointers to separately allocated objects.
+//When the storage grows or items are removed, items are moved in memory with memcpy instead of being
+//copied, so an item type must not hold pointers to itself or its own members.  Items are never copied
+//by the array itself, so types without a copy constructor can be used with AddNew and Emplace.
+//
+//This is implemented this way to achieve the highest level of code reuse (not creating the same function multiple times)
+//while creating classes which are easy to look at inside the debugger.  If a class heirarchy was used instead, data members
+//are buried at the base of the class tree and possibly multiple base classes must be opened in order to view them.
+//
+
+//internal option, present if Remove must keep the order of the remaining items.
+#if defined(ArrayValueImpl_Queue) || defined(ArrayValueImpl_Sorted)
+#define ArrayValueImpl_Ordered
+#endif
+
+template <class C>
+class ArrayValueImpl_ClassName
+{
+private:
+    ArrayValueImpl_ClassName(ArrayValueImpl_ClassName const &other);
+public:
+    ArrayValueImpl_ClassName();
+    ~ArrayValueImpl_ClassName();
+
+    #ifdef ArrayValueImpl_Sorted
+    //
+    //Sorted array function pointer types.
+    //
+
+    //compare function type.  The parameters are pointers to the items so that we can
+    //use this function directly in the CRT qsort routine.
+    typedef int32 (*CompareFunc)(C const *item1, C const *item2);
+
+    //similar to the CompareFunc, but passes an identifier instead of the first item.
+    template <class ID>
+    class FindFunc { public:
+        typedef int32 (*Func)(ID const id, C const *item);
+    };
+    #endif
+
+    //
+    //member access functions
+    //
+public:
+    int32 Num() const;
+    C *Get(int32 index);
+    inline C const *Get(int32 index) const;
+
+    //get all of our elements
+    #if defined(ArrayValueImpl_Queue)
+    //if the circular buffer has wrapped around, the items are first moved so they are contiguous, which is O(n).
+    C const *Array();
+    #else
+    C const *Array() const;
+    #endif
+
+    //remove all our items and add all items from the given array, removing them from it
+    void TakeFrom(ArrayValueImpl_ClassName &other);
+
+    //
+    //Unchecked access, see ArraySpan.h.  These don't check the index, so loops which already know
+    //their bounds don't pay for a check on every item, and the standard algorithms can be used.
+    //
+public:
+    #if defined(ArrayValueImpl_Queue)
+    typedef ArrayRingIterator<C> iterator;
+    typedef ArrayRingIterator<C const> const_iterator;
+    #else
+    typedef C *iterator;
+    typedef C const *const_iterator;
+    #endif
+    typedef C value_type;
+
+    inline iterator begin();
+    inline iterator end();
+    inline const_iterator begin() const;
+    inline const_iterator end() const;
+
+    inline C &operator[](int32 index);
+    inline C const &operator[](int32 index) const;
+
+    //all our items as one contiguous span.
+    #if defined(ArrayValueImpl_Queue)
+    //if the circular buffer has wrapped around, the items are first moved so they are contiguous, which is O(n).
+    ArraySpan<C> Span();
+    #else
+    inline ArraySpan<C> Span();
+    inline ArraySpan<C const> Span() const;
+    #endif
+
+    //
+    //add a single item to the array.  All functions return the address of the item inside the array,
+    //which is valid until the array is changed again.
+    //
+public:
+    #if defined(ArrayValueImpl_Sorted)
+    //adds a copy of an item in sorted order.  Returns NULL if an equal item is already in the array.
+    C *Add(C const &item, CompareFunc compareFunc);
+    #else
+    //adds a copy of an item to the end of the array.
+    C *Add(C const &item);
+
+    //adds a default constructed item to the end of the array.
+    C *AddNew();
+
+    //adds an item to the end of the array, constructed in place with the given constructor parameters.
+    template <class P1>
+    C *Emplace(P1 const &p1);
+    template <class P1, class P2>
+    C *Emplace(P1 const &p1, P2 const &p2);
+    template <class P1, class P2, class P3>
+    C *Emplace(P1 const &p1, P2 const &p2, P3 const &p3);
+    #endif
+
+    #if defined(ArrayValueImpl_Queue)
+    //
+    //O(1) functions to use the array as a double ended queue.
+    //
+public:
+    //adds a copy of an item after the last item, same as Add.
+    inline C *PushBack(C const &item);
+
+    //adds a copy of an item before the first item.
+    C *PushFront(C const &item);
+
+    //destroys the first item.  Returns false if the array is empty.
+    bool PopFront();
+    #endif
+
+    //
+    //Remove an item from the array, destroying it.
+    //
+public:
+    //removes an item given its index or its address inside the array.  Returns false if there was no such item.
+    bool Remove(int32 index);
+    bool Remove(C const *item);
+    #if defined(ArrayValueImpl_Sorted)
+    template <class ID>
+    bool Remove(ID const id, typename FindFunc<ID>::Func findFunc);
+    #endif
+
+    //
+    //Find an item in the array.
+    //
+public:
+    #if defined(ArrayValueImpl_Sorted)
+    //finds the item that matches the given identifier, given a find function
+    template <class ID>
+    C *Find(ID const id, typename FindFunc<ID>::Func findFunc);
+    //finds an item that matches the given item according to the given Compare function
+    //returns NULL if no item matches.
+    C *Find(C const &item, CompareFunc compareFunc);
+    #endif
+
+    //
+    //Functions to clear the array.
+    //
+    //destroy all elements in our array and free storage space.
+    void Reset();
+
+    //destroy all elements in our array without decreasing max capacity.
+    void Empty();
+
+    #if defined(__CONFIG_ARRAY_STATS)
+    //tags our stats with the place that owns us, see ARRAY_STATS_PLACE.
+    inline void StatsPlace(Place &place);
+    #endif
+
+private:
+    //the number of elements in our array.
+    int32 num;
+
+    //the number of elements our storage can hold.
+    int32 max;
+
+    #if defined(ArrayValueImpl_Queue)
+    //index in the storage of our first item.
+    int32 first;
+    #endif
+
+    #ifdef __CONFIG_DEBUG
+    //In DEBUG, we use this to easier look at the
+    //first items in the array.
+    typedef C sixteenOfEm[16];
+    union
+    {
+        //normal array of objects.
+        C *items;
+
+        //pointer to array of 16 objects.
+        sixteenOfEm *items16;
+    };
+    #else
+    //our array of objects.
+    C *items;
+    #endif
+
+    #if defined(__CONFIG_ARRAY_STATS)
+    //resize and usage counts, see ArrayStats.h
+    ArrayStats stats;
+    #endif
+
+    //makes room for one more item at the end of the array, and returns the storage for it.  If
+    //the storage grows, the old storage is returned in oldItems for the caller to free once the
+    //item is made, because the item may be copied from one of ours.
+    void *Extend(C **oldItems);
+
+    #if defined(ArrayValueImpl_Sorted)
+    //makes room for one more item at the given index, and returns the storage for it.
+    void *Open(int32 index);
+    #endif
+
+    //doubles the size of the storage, see Reallocate for oldItems
+    bool Lengthen(C **oldItems = NULL);
+
+    //moves our items to new storage of the given length, starting at index 0.  The old storage
+    //is freed, unless oldItems isn't NULL, when it is returned there instead.
+    bool Reallocate(int32 newMax, C **oldItems = NULL);
+
+    //gets the index in the storage of the item at the given index.
+    inline int32 Slot(int32 index) const;
+};
+
+//
+//ArrayValueImpl_ClassName template functions
+//
+
+template <class C>
+ArrayValueImpl_ClassName<C>::ArrayValueImpl_ClassName() ARRAY_STATS_INIT(ArrayValueImpl_ClassName, sizeof(C))
+{
+    num = max = 0;
+    items = NULL;
+
+    #if defined(ArrayValueImpl_Queue)
+    first = 0;
+    #endif
+}
+
+template <class C>
+ArrayValueImpl_ClassName<C>::~ArrayValueImpl_ClassName()
+{
+    //reset array
+    Reset();
+}
+
+template <class C>
+C *ArrayValueImpl_ClassName<C>::Get(int32 index)
+{
+    IFBREAKNULL(index < 0 || index >= num);
+
+    return &items[Slot(index)];
+}
+
+template <class C>
+C const *ArrayValueImpl_ClassName<C>::Get(int32 index) const
+{
+    IFBREAKNULL(index < 0 || index >= num);
+
+    return &items[Slot(index)];
+}
+
+template <class C>
+int32 ArrayValueImpl_ClassName<C>::Num() const
+{
+    return num;
+}
+
+template <class C>
+int32 ArrayValueImpl_ClassName<C>::Slot(int32 index) const
+{
+    #if defined(ArrayValueImpl_Queue)
+    //wrap around the end of the storage.  max is always a power of 2.
+    return (first + index) & (max - 1);
+    #else
+    return index;
+    #endif
+}
+
+#if defined(ArrayValueImpl_Queue)
+template <class C>
+C const *ArrayValueImpl_ClassName<C>::Array()
+{
+    //check if our items wrap around the end of the storage
+    if (first + num > max)
+    {
+        //move them to new storage so they are contiguous
+        IFBREAKNULL(Reallocate(max) == false);
+    }
+
+    //our items start at the first one
+    return (items == NULL) ? NULL : &items[first];
+}
+#else
+template <class C>
+C const *ArrayValueImpl_ClassName<C>::Array() const
+{
+    return items;
+}
+#endif
+
+#if defined(ArrayValueImpl_Queue)
+template <class C>
+typename ArrayValueImpl_ClassName<C>::iterator ArrayValueImpl_ClassName<C>::begin()
+{
+    return iterator(items, max, first, 0);
+}
+
+template <class C>
+typename ArrayValueImpl_ClassName<C>::iterator ArrayValueImpl_ClassName<C>::end()
+{
+    return iterator(items, max, first, num);
+}
+
+template <class C>
+typename ArrayValueImpl_ClassName<C>::const_iterator ArrayValueImpl_ClassName<C>::begin() const
+{
+    return const_iterator(items, max, first, 0);
+}
+
+template <class C>
+typename ArrayValueImpl_ClassName<C>::const_iterator ArrayValueImpl_ClassName<C>::end() const
+{
+    return const_iterator(items, max, first, num);
+}
+
+template <class C>
+ArraySpan<C> ArrayValueImpl_ClassName<C>::Span()
+{
+    //make our items contiguous
+    C const *array = Array();
+
+    //span over them
+    return ArraySpan<C>((array == NULL) ? NULL : &items[first], num);
+}
+#else
+template <class C>
+typename ArrayValueImpl_ClassName<C>::iterator ArrayValueImpl_ClassName<C>::begin()
+{
+    return items;
+}
+
+template <class C>
+typename ArrayValueImpl_ClassName<C>::iterator ArrayValueImpl_ClassName<C>::end()
+{
+    return items + num;
+}
+
+template <class C>
+typename ArrayValueImpl_ClassName<C>::const_iterator ArrayValueImpl_ClassName<C>::begin() const
+{
+    return items;
+}
+
+template <class C>
+typename ArrayValueImpl_ClassName<C>::const_iterator ArrayValueImpl_ClassName<C>::end() const
+{
+    return items + num;
+}
+
+template <class C>
+ArraySpan<C> ArrayValueImpl_ClassName<C>::Span()
+{
+    return ArraySpan<C>(items, num);
+}
+
+template <class C>
+ArraySpan<C const> ArrayValueImpl_ClassName<C>::Span() const
+{
+    return ArraySpan<C const>(items, num);
+}
+#endif
+
+template <class C>
+C &ArrayValueImpl_ClassName<C>::operator[](int32 index)
+{
+    #ifdef __CONFIG_DEBUG
+    if (index < 0 || index >= num) { BREAK1(); }
+    #endif
+    return items[Slot(index)];
+}
+
+template <class C>
+C const &ArrayValueImpl_ClassName<C>::operator[](int32 index) const
+{
+    #ifdef __CONFIG_DEBUG
+    if (index < 0 || index >= num) { BREAK1(); }
+    #endif
+    return items[Slot(index)];
+}
+
+template <class C>
+void ArrayValueImpl_ClassName<C>::TakeFrom(ArrayValueImpl_ClassName &other)
+{
+    //clear out our items
+    Reset();
+
+    //take data from other one
+    items = other.items;
+    num = other.num;
+    max = other.max;
+
+    #if defined(ArrayValueImpl_Queue)
+    first = other.first;
+    other.first = 0;
+    #endif
+
+    //remove from other list
+    other.items = null;
+    other.num = other.max = 0;
+}
+
+template <class C>
+void *ArrayValueImpl_ClassName<C>::Extend(C **oldItems)
+{
+    //check if we need to lengthen the array
+    if (num >= max)
+    {
+        //lengthen it.
+        IFBREAKNULL(Lengthen(oldItems) == false);
+    }
+
+    //the storage after our last item
+    return &items[Slot(num)];
+}
+
+#if !defined(ArrayValueImpl_Sorted)
+template <class C>
+C *ArrayValueImpl_ClassName<C>::Add(C const &item)
+{
+    //get storage for the item, keeping the old storage while the item is made from its parameters
+    C *oldItems = NULL;
+    void *spot = Extend(&oldItems);
+    IFBREAKNULL(spot == NULL);
+
+    //copy the item into the last slot, then free the old storage
+    C *added = new (spot) C(item);
+    freec(oldItems);
+
+    //we have one more item now
+    num++;
+    ARRAY_STATS(Added(num));
+
+    //return where it is
+    return added;
+}
+
+template <class C>
+C *ArrayValueImpl_ClassName<C>::AddNew()
+{
+    //get storage for the item, keeping the old storage while the item is made from its parameters
+    C *oldItems = NULL;
+    void *spot = Extend(&oldItems);
+    IFBREAKNULL(spot == NULL);
+
+    //construct the item in the last slot, then free the old storage
+    C *added = new (spot) C();
+    freec(oldItems);
+
+    //we have one more item now
+    num++;
+    ARRAY_STATS(Added(num));
+
+    //return where it is
+    return added;
+}
+
+template <class C> template <class P1>
+C *ArrayValueImpl_ClassName<C>::Emplace(P1 const &p1)
+{
+    //get storage for the item, keeping the old storage while the item is made from its parameters
+    C *oldItems = NULL;
+    void *spot = Extend(&oldItems);
+    IFBREAKNULL(spot == NULL);
+
+    //construct the item in the last slot, then free the old storage
+    C *added = new (spot) C(p1);
+    freec(oldItems);
+
+    //we have one more item now
+    num++;
+    ARRAY_STATS(Added(num));
+
+    //return where it is
+    return added;
+}
+
+template <class C> template <class P1, class P2>
+C *ArrayValueImpl_ClassName<C>::Emplace(P1 const &p1, P2 const &p2)
+{
+    //get storage for the item, keeping the old storage while the item is made from its parameters
+    C *oldItems = NULL;
+    void *spot = Extend(&oldItems);
+    IFBREAKNULL(spot == NULL);
+
+    //construct the item in the last slot, then free the old storage
+    C *added = new (spot) C(p1, p2);
+    freec(oldItems);
+
+    //we have one more item now
+    num++;
+    ARRAY_STATS(Added(num));
+
+    //return where it is
+    return added;
+}
+
+template <class C> template <class P1, class P2, class P3>
+C *ArrayValueImpl_ClassName<C>::Emplace(P1 const &p1, P2 const &p2, P3 const &p3)
+{
+    //get storage for the item, keeping the old storage while the item is made from its parameters
+    C *oldItems = NULL;
+    void *spot = Extend(&oldItems);
+    IFBREAKNULL(spot == NULL);
+
+    //construct the item in the last slot, then free the old storage
+    C *added = new (spot) C(p1, p2, p3);
+    freec(oldItems);
+
+    //we have one more item now
+    num++;
+    ARRAY_STATS(Added(num));
+
+    //return where it is
+    return added;
+}
+#endif
+
+#if defined(ArrayValueImpl_Queue)
+template <class C>
+C *ArrayValueImpl_ClassName<C>::PushBack(C const &item)
+{
+    //the end of the array is the back of the queue
+    return Add(item);
+}
+
+template <class C>
+C *ArrayValueImpl_ClassName<C>::PushFront(C const &item)
+{
+    //check if we need to lengthen the array, keeping the old storage in case the item is one of ours
+    C *oldItems = NULL;
+    if (num >= max)
+    {
+        //lengthen it.
+        IFBREAKNULL(Lengthen(&oldItems) == false);
+    }
+
+    //the front moves back one slot, wrapping around the start of the storage
+    first = (first - 1) & (max - 1);
+
+    //copy the item into the new first slot, then free the old storage
+    C *added = new (&items[first]) C(item);
+    freec(oldItems);
+
+    //we have one more item now
+    num++;
+    ARRAY_STATS(Added(num));
+
+    //return where it is
+    return added;
+}
+
+template <class C>
+bool ArrayValueImpl_ClassName<C>::PopFront()
+{
+    //check if we have no items
+    if (num < 1)
+    {
+        //nothing to pop
+        return false;
+    }
+
+    //destroy the first item
+    items[first].~C();
+
+    //the front moves up one slot
+    first = (first + 1) & (max - 1);
+
+    //we now have 1 less item.
+    num--;
+    ARRAY_STATS(Removed());
+
+    //success
+    return true;
+}
+#endif
+
+template <class C>
+bool ArrayValueImpl_ClassName<C>::Remove(int32 index)
+{
+    //check the number.
+    IFBREAKFALSE(index < 0 || index >= num);
+
+    //destroy the item, which leaves a hole in the storage
+    items[Slot(index)].~C();
+
+    #if defined(ArrayValueImpl_Queue)
+    //check if there are fewer elements before this one than after it
+    if (index < num / 2)
+    {
+        //move all elements before this one down one index
+        for (int32 i = index; i > 0; i--)
+        {
+            //move this element down
+            memcpy((void *)&items[Slot(i)], &items[Slot(i - 1)], sizeof(C));
+        }
+
+        //the front moves up one slot
+        first = (first + 1) & (max - 1);
+    }
+    else
+    {
+        //move all elements after this one up one index
+        for (int32 i = index + 1; i < num; i++)
+        {
+            //move this element up
+            memcpy((void *)&items[Slot(i - 1)], &items[Slot(i)], sizeof(C));
+        }
+    }
+    #elif defined(ArrayValueImpl_Ordered)
+    //move all elements after this one up one index
+    memmove((void *)&items[index], &items[index + 1], sizeof(C) * (num - index - 1));
+    #else
+    //move the last element to this slot
+    if (index != num - 1)
+    {
+        memcpy((void *)&items[index], &items[num - 1], sizeof(C));
+    }
+    #endif
+
+    //we now have 1 less item.
+    num--;
+    ARRAY_STATS(Removed());
+
+    //success
+    return true;
+}
+
+template <class C>
+bool ArrayValueImpl_ClassName<C>::Remove(C const *item)
+{
+    IFBREAKFALSE(item == NULL);
+
+    //check if the address is inside our storage
+    if (items == NULL || item < items || item >= items + max)
+    {
+        //not one of ours
+        return false;
+    }
+
+    //get the index of the item from its slot in the storage
+    #if defined(ArrayValueImpl_Queue)
+    int32 index = (int32(item - items) - first) & (max - 1);
+    #else
+    int32 index = int32(item - items);
+    #endif
+
+    //remove it
+    return Remove(index);
+}
+
+template <class C>
+void ArrayValueImpl_ClassName<C>::Reset()
+{
+    //empty the array first
+    Empty();
+
+    //free the storage
+    freec(items);
+
+    //we have no storage anymore
+    max = 0;
+}
+
+template <class C>
+void ArrayValueImpl_ClassName<C>::Empty()
+{
+    //destroy each item in the array
+    for (int32 i = 0; i < num; i++)
+    {
+        //destroy this item
+        items[Slot(i)].~C();
+    }
+
+    //we have no items
+    ARRAY_STATS(Removed(num));
+    num = 0;
+
+    #if defined(ArrayValueImpl_Queue)
+    //start over at the beginning of the storage
+    first = 0;
+    #endif
+}
+
+#if defined(__CONFIG_ARRAY_STATS)
+template <class C>
+void ArrayValueImpl_ClassName<C>::StatsPlace(Place &place)
+{
+    stats.SetPlace(place);
+}
+#endif
+
+template <class C>
+bool ArrayValueImpl_ClassName<C>::Lengthen(C **oldItems)
+{
+    //if we have no items, start with a length of 4, otherwise double the length
+    return Reallocate((max == 0) ? 4 : max * 2, oldItems);
+}
+
+template <class C>
+bool ArrayValueImpl_ClassName<C>::Reallocate(int32 newMax, C **oldItems)
+{
+    IFASSERTFALSE(newMax < num);
+
+    //make the new storage
+    C *new_items = (C *)malloc(sizeof(C) * newMax);
+    IFBREAKFALSE(new_items == NULL);
+
+    #if defined(ArrayValueImpl_Queue)
+    //number of items from the first one to the end of the old storage
+    int32 firstPart = min(num, max - first);
+
+    //move the items in order, which unwraps the circular buffer
+    if (firstPart > 0)
+    {
+        memcpy((void *)new_items, &items[first], sizeof(C) * firstPart);
+    }
+    if (num > firstPart)
+    {
+        memcpy((void *)&new_items[firstPart], items, sizeof(C) * (num - firstPart));
+    }
+
+    //our items start at the beginning again
+    first = 0;
+    #else
+    //move the old items
+    if (num > 0)
+    {
+        memcpy((void *)new_items, items, sizeof(C) * num);
+    }
+    #endif
+
+    //free the old storage, the items have already been moved out of it.  Our caller may still
+    //need to copy from it, then it frees it.
+    if (oldItems != NULL)
+    {
+        *oldItems = items;
+    }
+    else
+    {
+        freec(items);
+    }
+
+    //swap in the new storage
+    items = new_items;
+    max = newMax;
+    ARRAY_STATS(Resized(newMax));
+
+    //success
+    return true;
+}
+
+#if defined(ArrayValueImpl_Sorted)
+template <class C>
+C *ArrayValueImpl_ClassName<C>::Add(C const &item, CompareFunc compareFunc)
+{
+    IFBREAKNULL(compareFunc == NULL);
+
+    //Open moves our items, so an item of ours is copied out first
+    if (&item >= items && &item < items + num)
+    {
+        C copy(item);
+        return Add(copy, compareFunc);
+    }
+
+    //the item goes somewhere between index low and high, inclusive
+    int32 low = 0;
+    int32 high = num;
+
+    //bring bounds together
+    while (low < high)
+    {
+        //find index between them
+        int32 middle = (high + low) / 2;
+
+        //compare our item to the middle item
+        int32 relation = compareFunc(&item, &items[middle]);
+
+        //check if it is before
+        if (relation < 0)
+        {
+            //the item goes in first half
+            high = middle;
+            continue;
+        }
+
+        //check if it is after
+        if (relation > 0)
+        {
+            //the item goes in last half
+            low = middle + 1;
+            continue;
+        }
+
+        //bad news, one already here
+        BREAK1();
+        return NULL;
+    }
+
+    //make room at the spot
+    void *spot = Open(low);
+    IFBREAKNULL(spot == NULL);
+
+    //copy the item into it
+    C *added = new (spot) C(item);
+
+    //we have one more item now
+    num++;
+    ARRAY_STATS(Added(num));
+
+    //return where it is
+    return added;
+}
+
+template <class C>
+void *ArrayValueImpl_ClassName<C>::Open(int32 index)
+{
+    IFASSERTNULL(index < 0 || index > num);
+
+    //get storage at the end, which extends the array if necessary.  Add has already copied
+    //the item if it was one of ours, so the old storage can be freed now.
+    IFBREAKNULL(Extend(NULL) == NULL);
+
+    //move all items from the given index down one spot
+    memmove((void *)&items[index + 1], &items[index], sizeof(C) * (num - index));
+
+    //the hole is where we want the item
+    return &items[index];
+}
+
+template <class C> template <class ID>
+C *ArrayValueImpl_ClassName<C>::Find(ID const id, typename FindFunc<ID>::Func findFunc)
+{
+    IFBREAKNULL(findFunc == NULL);
+
+    //the item is in some index between low and high, inclusive
+    int32 low = 0;
+    int32 high = num - 1;
+
+    //search until we're down to no items
+    while (low <= high)
+    {
+        //get the index in the middle
+        int32 middle = (low + high) / 2;
+
+        //check relation of the id we're looking for and the middle item
+        int32 relation = findFunc(id, &items[middle]);
+
+        //check if item with that id is before middle
+        if (relation < 0)
+        {
+            //its in first half
+            high = middle - 1;
+            continue;
+        }
+
+        //check if item with that id is after middle
+        if (relation > 0)
+        {
+            //its in last half
+            low = middle + 1;
+            continue;
+        }
+
+        //the item we want is right here at middle index
+        return &items[middle];
+    }
+
+    //didnt find it anywhere
+    return NULL;
+}
+
+template <class C>
+C *ArrayValueImpl_ClassName<C>::Find(C const &item, CompareFunc compareFunc)
+{
+    IFBREAKNULL(compareFunc == NULL);
+
+    //the item is in some index between low and high, inclusive
+    int32 low = 0;
+    int32 high = num - 1;
+
+    //search until we're down to no items
+    while (low <= high)
+    {
+        //get the index in the middle
+        int32 middle = (low + high) / 2;
+
+        //check relation of the item we're looking for and the middle item
+        int32 relation = compareFunc(&item, &items[middle]);
+
+        //check if the given item is before the middle
+        if (relation < 0)
+        {
+            //its in first half
+            high = middle - 1;
+            continue;
+        }
+
+        //check if the given item is after the middle
+        if (relation > 0)
+        {
+            //its in last half
+            low = middle + 1;
+            continue;
+        }
+
+        //the item we want is right here at middle index
+        return &items[middle];
+    }
+
+    //didnt find it anywhere
+    return NULL;
+}
+
+template <class C> template <class ID>
+bool ArrayValueImpl_ClassName<C>::Remove(ID const id, typename FindFunc<ID>::Func findFunc)
+{
+    //find the item
+    C *item = Find(id, findFunc);
+    if (item == NULL)
+    {
+        //nothing to remove
+        return false;
+    }
+
+    //remove it from the array
+    return Remove(int32(item - items));
+}
+#endif
+
+
+#undef ArrayValueImpl_ClassName
+#undef ArrayValueImpl_Queue
+#undef ArrayValueImpl_Sorted
+#undef ArrayValueImpl_Ordered
@@ -0,0 +1,185 @@
+//
+// v1 - Prototype character/item/tradeskill game.
+// Copyright (C) 2013 Adam Hayek (adam.hayek@gmail.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see [http://www.gnu.org/licenses/].
+//
+
+#include <stddef.h>
+#include "common\global\global.h"
+#include "common\global\Atom.h"
+#include "common\global\SpinLock.h"
+
+//strings are packed into chunks of this many bytes.  Longer strings get their own allocation.
+#define ATOM_CHUNK_SIZE 16384
+
+//
+//The table behind Atom.  The strings are packed into chunks which are never freed, and indexed
+//by a hash table keyed by the strings themselves.
+//
+class AtomTable
+{
+public:
+    AtomTable();
+
+    //finds the entry of a string, or NULL.  The lock must be held.
+    inline Atom::Entry const *Find(char const *str);
+
+    //adds a string which isn't in the table yet.  The lock must be held.
+    Atom::Entry const *Add(char const *str);
+
+    //protects everything below
+    SpinLock lock;
+
+    //the entries, keyed by their text
+    ArrayHashed<char const *, Atom::Entry> entries;
+
+    //the chunk we are packing strings into, and how much of it is used
+    char *chunk;
+    int32 chunkUsed;
+
+    //bytes used by all the entries
+    int32 numBytes;
+};
+
+//returns the table, making it the first time.  Atoms are interned by other static objects, so the
+//table can't be a plain static object which may be constructed after them.
+static AtomTable &AtomGetTable()
+{
+    static AtomTable table;
+    return table;
+}
+
+//make the table during static construction at the latest, while there is only one thread.
+INIT(AtomTable)
+{
+    AtomGetTable();
+}
+
+
+//
+//AtomTable functions
+//
+
+AtomTable::AtomTable()
+{
+    //no chunk yet
+    chunk = NULL;
+    chunkUsed = 0;
+    numBytes = 0;
+}
+
+Atom::Entry const *AtomTable::Find(char const *str)
+{
+    return entries.Find(str);
+}
+
+Atom::Entry const *AtomTable::Add(char const *str)
+{
+    //size of the entry, keeping the next entry aligned for its header
+    int32 length = (int32)strlen(str);
+    int32 size = (int32)offsetof(Atom::Entry, text) + length + 1;
+    size = (size + 3) & ~3;
+
+    //find room for it
+    char *spot = NULL;
+    if (size > ATOM_CHUNK_SIZE / 4)
+    {
+        //big ones get their own allocation, so they don't waste the rest of a chunk
+        spot = (char *)malloc(size);
+        IFBREAKNULL(spot == NULL);
+    }
+    else
+    {
+        //check if the chunk is full
+        if (chunk == NULL || chunkUsed + size > ATOM_CHUNK_SIZE)
+        {
+            //start a new one.  The old one is never freed, its strings are still in use.
+            chunk = (char *)malloc(ATOM_CHUNK_SIZE);
+            IFBREAKNULL(chunk == NULL);
+            chunkUsed = 0;
+        }
+
+        //take the space
+        spot = &chunk[chunkUsed];
+        chunkUsed += size;
+    }
+
+    //fill in the entry
+    Atom::Entry *entry = (Atom::Entry *)spot;
+    entry->hash = HashFunc(str);
+    entry->length = length;
+    memcpy(entry->text, str, length + 1);
+    numBytes += size;
+
+    //index it by its own copy of the text
+    IFBREAKNULL(entries.Add(entry->text, entry) == false);
+    return entry;
+}
+
+
+//
+//Atom functions
+//
+
+Atom Atom::Intern(char const *str)
+{
+    //no string, no atom
+    if (str == NULL)
+    {
+        return Atom();
+    }
+
+    AtomTable &table = AtomGetTable();
+    SpinLockScope scope(table.lock);
+
+    //check if we already have it
+    Entry const *entry = table.Find(str);
+    if (entry == NULL)
+    {
+        //add it
+        entry = table.Add(str);
+    }
+
+    return Atom(entry);
+}
+
+Atom Atom::Find(char const *str)
+{
+    //no string, no atom
+    if (str == NULL)
+    {
+        return Atom();
+    }
+
+    AtomTable &table = AtomGetTable();
+    SpinLockScope scope(table.lock);
+
+    //look for it
+    return Atom(table.Find(str));
+}
+
+int32 Atom::NumAtoms()
+{
+    AtomTable &table = AtomGetTable();
+    SpinLockScope scope(table.lock);
+    return table.entries.Num();
+}
+
+int32 Atom::NumBytes()
+{
+    AtomTable &table = AtomGetTable();
+    SpinLockScope scope(table.lock);
+    return table.numBytes;
+}
@@ -0,0 +1,146 @@
+//
+// v1 - Prototype character/item/tradeskill game.
+// Copyright (C) 2013 Adam Hayek (adam.hayek@gmail.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see [http://www.gnu.org/licenses/].
+//
+
+#include <windows.h>
+#include "common\global\global.h"
+#include "common\global\CallTree.h"
+#include "common\global\SpinLock.h"
+
+#if defined(__CONFIG_CALL_TREE)
+
+//
+//local data
+//
+
+//protects the list of trees and the making of the TLS slot
+static SpinLock callTreeLock;
+
+//the TLS slot which holds each thread's tree, once callTreeSlotMade is set.  Contexts are made
+//during static construction, so the slot is made on first use instead of by a constructor.
+static DWORD callTreeSlot;
+static bool volatile callTreeSlotMade = false;
+
+//the tree of every thread, newest first
+static CallTree * volatile callTreeFirst = NULL;
+
+
+//
+//CallNode functions
+//
+
+CallNode::CallNode(CallNode *parent, Place *place)
+{
+    //save where we are
+    this->parent = parent;
+    this->place = place;
+
+    //no calls yet
+    firstChild = NULL;
+    lastChild = NULL;
+    nextSibling = NULL;
+    lastUsed = NULL;
+    numCalls = 0;
+    numCycles = 0;
+}
+
+CallNode *CallNode::FindChild(Place &place)
+{
+    //look for the child, it has been called before unless this is the first time
+    for (CallNode *child = firstChild; child != NULL; child = child->nextSibling)
+    {
+        if (child->place == &place)
+        {
+            lastUsed = child;
+            return child;
+        }
+    }
+
+    //first call to this place from here
+    CallNode *child = new CallNode(this, &place);
+
+    //add it to the end of the list.  The barrier keeps the compiler from linking it in before it's
+    //filled in, and x86 doesn't reorder stores, so readers always see it whole.
+    _ReadWriteBarrier();
+    if (lastChild != NULL)
+    {
+        lastChild->nextSibling = child;
+    }
+    else
+    {
+        firstChild = child;
+    }
+    lastChild = child;
+
+    lastUsed = child;
+    return child;
+}
+
+
+//
+//CallTree functions
+//
+
+CallTree::CallTree(uint32 threadId)
+    : root(NULL, NULL)
+{
+    //save our thread
+    this->threadId = threadId;
+    next = NULL;
+}
+
+CallTree *CallTree::Thread()
+{
+    //make the TLS slot the first time any thread gets here
+    if (callTreeSlotMade == false)
+    {
+        SpinLockScope scope(callTreeLock);
+        if (callTreeSlotMade == false)
+        {
+            callTreeSlot = TlsAlloc();
+            IFBREAKNULL(callTreeSlot == TLS_OUT_OF_INDEXES);
+            _ReadWriteBarrier();
+            callTreeSlotMade = true;
+        }
+    }
+
+    //check if this thread has one already
+    CallTree *tree = (CallTree *)TlsGetValue(callTreeSlot);
+    if (tree != NULL)
+    {
+        return tree;
+    }
+
+    //first context on this thread, make its tree.  It's never freed, so the tree of a thread which
+    //has finished can still be reported.
+    tree = new CallTree(GetCurrentThreadId());
+    TlsSetValue(callTreeSlot, tree);
+
+    //add it to the front of the list, readers walk it without the lock
+    SpinLockScope scope(callTreeLock);
+    tree->next = callTreeFirst;
+    _ReadWriteBarrier();
+    callTreeFirst = tree;
+    return tree;
+}
+
+CallTree *CallTree::First()
+{
+    return callTreeFirst;
+}
+
+#endif
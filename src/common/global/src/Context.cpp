@@ -0,0 +1,274 @@
+//
+// v1 - Prototype character/item/tradeskill game.
+// Copyright (C) 2013 Adam Hayek (adam.hayek@gmail.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see [http://www.gnu.org/licenses/].
+//
+
+#include <windows.h>
+#include <malloc.h>
+#include <string.h>
+#include "common\global\global.h"
+#include "common\global\SpinLock.h"
+
+//pages of counts are aligned to cache lines, so no two threads' counts share one
+#define PLACE_COUNTER_ALIGN 64
+
+//
+//local data
+//
+
+//protects the list of counters, the making of the TLS slot, and the giving out of indexes
+static SpinLock placeCountersLock;
+
+//the TLS slot which holds each thread's counters, once placeCountersSlotMade is set.  Contexts are
+//made during static construction, so the slot is made on first use instead of by a constructor.
+static DWORD placeCountersSlot;
+static bool volatile placeCountersSlotMade = false;
+
+//the counters of every thread, newest first
+static PlaceCounters * volatile placeCountersFirst = NULL;
+
+//the last index given to a place.  0 is never given out, it means a place doesn't have one yet.
+static long placeCountersLastIndex = 0;
+
+//every place that has been made, so ContextInstrument can find them
+static Place **contextInstrumentPlaces = NULL;
+static int32 contextInstrumentNumPlaces = 0;
+static int32 contextInstrumentMaxPlaces = 0;
+
+//a call to ContextInstrument, kept for the places which haven't been called yet
+class ContextInstrumentRule
+{
+public:
+    char const *match;
+    int32 interval;
+};
+
+//every ContextInstrument rule, in the order they were made
+static ContextInstrumentRule *contextInstrumentRules = NULL;
+static int32 contextInstrumentNumRules = 0;
+static int32 contextInstrumentMaxRules = 0;
+
+
+//
+//local functions
+//
+
+//sets the interval of the place if its signature matches the rule
+static void ContextInstrumentApply(Place &place, ContextInstrumentRule const &rule)
+{
+    if (strstr(place.Description(), rule.match) != NULL)
+    {
+        place.Instrument(rule.interval);
+    }
+}
+
+
+//
+//global functions
+//
+
+void ContextInstrument(char const *match, int32 interval)
+{
+    IFBREAKRETURN(match == NULL);
+    SpinLockScope scope(placeCountersLock);
+
+    //make sure there is room for another rule
+    if (contextInstrumentNumRules >= contextInstrumentMaxRules)
+    {
+        int32 newMax = (contextInstrumentMaxRules < 16) ? 16 : contextInstrumentMaxRules * 2;
+        ContextInstrumentRule *newRules = (ContextInstrumentRule *)realloc(contextInstrumentRules, sizeof(ContextInstrumentRule) * newMax);
+        IFBREAKRETURN(newRules == NULL);
+        contextInstrumentRules = newRules;
+        contextInstrumentMaxRules = newMax;
+    }
+
+    //keep it for the places called later
+    ContextInstrumentRule &rule = contextInstrumentRules[contextInstrumentNumRules++];
+    rule.match = match;
+    rule.interval = interval;
+
+    //and change the ones which have been called
+    for (int32 i = 0; i < contextInstrumentNumPlaces; i++)
+    {
+        ContextInstrumentApply(*contextInstrumentPlaces[i], rule);
+    }
+}
+
+
+//
+//Place functions
+//
+
+void Place::Made()
+{
+    SpinLockScope scope(placeCountersLock);
+
+    //make sure there is room to list us
+    if (contextInstrumentNumPlaces >= contextInstrumentMaxPlaces)
+    {
+        int32 newMax = (contextInstrumentMaxPlaces < 1024) ? 1024 : contextInstrumentMaxPlaces * 2;
+        Place **newPlaces = (Place **)realloc(contextInstrumentPlaces, sizeof(Place *) * newMax);
+        IFBREAKRETURN(newPlaces == NULL);
+        contextInstrumentPlaces = newPlaces;
+        contextInstrumentMaxPlaces = newMax;
+    }
+    contextInstrumentPlaces[contextInstrumentNumPlaces++] = this;
+
+    //and take the interval of the rules which match us
+    for (int32 i = 0; i < contextInstrumentNumRules; i++)
+    {
+        ContextInstrumentApply(*this, contextInstrumentRules[i]);
+    }
+}
+
+int64 Place::NumCalls() const
+{
+    //add up every thread's
+    int64 total = 0;
+    for (PlaceCounters *counters = PlaceCounters::First(); counters != NULL; counters = counters->Next())
+    {
+        PlaceCount const *count = counters->Find(*this);
+        if (count != NULL)
+        {
+            total += count->numCalls;
+        }
+    }
+    return total;
+}
+
+int64 Place::NumCycles() const
+{
+    //add up every thread's, scaling up the cycles of the timed calls to all of them.  Each
+    //thread times its own share of the calls, so the threads are scaled separately.
+    double total = 0.0;
+    for (PlaceCounters *counters = PlaceCounters::First(); counters != NULL; counters = counters->Next())
+    {
+        PlaceCount const *count = counters->Find(*this);
+        if (count != NULL && count->numTimed > 0)
+        {
+            total += double(count->numCycles) * double(count->numCalls) / double(count->numTimed);
+        }
+    }
+    return int64(total);
+}
+
+
+//
+//PlaceCounters functions
+//
+
+PlaceCounters::PlaceCounters()
+{
+    //no pages until places are called
+    memset((void *)pages, 0, sizeof(pages));
+    overflow.numCalls = 0;
+    overflow.numTimed = 0;
+    overflow.numCycles = 0;
+    overflow.countdown = 0;
+    next = NULL;
+}
+
+PlaceCounters *PlaceCounters::Thread()
+{
+    //make the TLS slot the first time any thread gets here
+    if (placeCountersSlotMade == false)
+    {
+        SpinLockScope scope(placeCountersLock);
+        if (placeCountersSlotMade == false)
+        {
+            placeCountersSlot = TlsAlloc();
+            IFBREAKNULL(placeCountersSlot == TLS_OUT_OF_INDEXES);
+            _ReadWriteBarrier();
+            placeCountersSlotMade = true;
+        }
+    }
+
+    //check if this thread has them already
+    PlaceCounters *counters = (PlaceCounters *)TlsGetValue(placeCountersSlot);
+    if (counters != NULL)
+    {
+        return counters;
+    }
+
+    //first context on this thread, make its counters.  They're never freed, so the counts of a
+    //thread which has finished are still added up.
+    counters = new PlaceCounters();
+    TlsSetValue(placeCountersSlot, counters);
+
+    //add them to the front of the list, readers walk it without the lock
+    SpinLockScope scope(placeCountersLock);
+    counters->next = placeCountersFirst;
+    _ReadWriteBarrier();
+    placeCountersFirst = counters;
+    return counters;
+}
+
+PlaceCounters *PlaceCounters::First()
+{
+    return placeCountersFirst;
+}
+
+PlaceCount const *PlaceCounters::Find(Place const &place) const
+{
+    //check if the place has been called anywhere
+    int32 index = place.index;
+    if (index == 0)
+    {
+        return NULL;
+    }
+
+    //check if it has been called on our thread
+    PlaceCount const *page = pages[uint32(index) >> PLACE_COUNTER_PAGE_BITS];
+    if (page == NULL)
+    {
+        return NULL;
+    }
+    return &page[index & (PLACE_COUNTER_PAGE_SIZE - 1)];
+}
+
+PlaceCount &PlaceCounters::Make(Place &place)
+{
+    //give the place an index if this is its first call on any thread
+    if (place.index == 0)
+    {
+        SpinLockScope scope(placeCountersLock);
+
+        //another thread may have given it one while we waited.  When they are all used up, the
+        //place keeps 0 and is counted in our overflow.
+        if (place.index == 0 && placeCountersLastIndex < PLACE_COUNTER_PAGES * PLACE_COUNTER_PAGE_SIZE - 1)
+        {
+            place.index = ++placeCountersLastIndex;
+        }
+    }
+    int32 index = place.index;
+    if (index == 0)
+    {
+        return overflow;
+    }
+
+    //make the page if this is the first place in it called on our thread.  The barrier keeps the
+    //compiler from storing the page before it's cleared, so readers always see zeros or counts.
+    PlaceCount * volatile &page = pages[uint32(index) >> PLACE_COUNTER_PAGE_BITS];
+    if (page == NULL)
+    {
+        PlaceCount *newPage = (PlaceCount *)_aligned_malloc(sizeof(PlaceCount) * PLACE_COUNTER_PAGE_SIZE, PLACE_COUNTER_ALIGN);
+        IFBREAKRETURNVAL(newPage == NULL, overflow);
+        memset(newPage, 0, sizeof(PlaceCount) * PLACE_COUNTER_PAGE_SIZE);
+        _ReadWriteBarrier();
+        page = newPage;
+    }
+    return page[index & (PLACE_COUNTER_PAGE_SIZE - 1)];
+}
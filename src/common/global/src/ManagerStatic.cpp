@@ -16,6 +16,7 @@
 //  along with this program.  If not, see [http://www.gnu.org/licenses/].
 //
 
+#include <windows.h>
 #include "common\global\ManagerStatic.h"
 #include "common\global\ManagerObject.h"
 
@@ -93,6 +94,12 @@ bool ManagerStatic::RemoveObject(void *object)
 
 void ManagerStatic::TransferTo(ManagerObject *newManager)
 {
+    //a DLL loaded twice is asked to transfer twice, and the second time it's already done
+    if (manager == newManager)
+    {
+        return;
+    }
+
     //check if we have created a manager.
     if (manager == NULL)
     {
@@ -132,6 +139,22 @@ void ManagerStatic::TransferTo(ManagerObject *newManager)
     delc(currentManager);
 }
 
+void ManagerStatic::TransferFromDLL(void *dllHandle, const char *transferFuncName)
+{
+    IFASSERTRETURN(dllHandle == NULL || transferFuncName == NULL);
+
+    //find the function the DLL exports to transfer its items
+    ManagerTransferFunc transfer = (ManagerTransferFunc)GetProcAddress((HMODULE)dllHandle, transferFuncName);
+    IFBREAKRETURN(transfer == NULL);
+
+    //get our manager (or create it if we dont have one yet)
+    ManagerObject *manager = GetManager();
+    IFASSERTRETURN(manager == NULL);
+
+    //the DLL moves its items into our manager, and its module joins our manager's references.
+    transfer(manager);
+}
+
 ManagerObject *ManagerStatic::GetManager()
 {
     //check if we have it
@@ -0,0 +1,117 @@
+//
+// v1 - Prototype character/item/tradeskill game.
+// Copyright (C) 2013 Adam Hayek (adam.hayek@gmail.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see [http://www.gnu.org/licenses/].
+//
+
+#include "common\global\PointerSearch.h"
+
+//
+//local functions
+//
+
+//searches the pointers one at a time, from index start on.
+static int32 PointerSearchScalar(void const *const *pointers, int32 start, int32 count, void const *value)
+{
+    //search through the rest of the pointers
+    for (int32 i = start; i < count; i++)
+    {
+        //check if it is here
+        if (pointers[i] == value)
+        {
+            return i;
+        }
+    }
+
+    //never found it
+    return -1;
+}
+
+//turns the mask from a byte compare into the index of the first matching pointer in the block.
+static inline int32 PointerSearchFirst(uint32 mask)
+{
+    //lowest set bit is the first matching byte
+    unsigned long bit = 0;
+    _BitScanForward(&bit, mask);
+
+    //each pointer is sizeof(void *) bytes
+    return int32(bit / sizeof(void *));
+}
+
+#if defined(__PLATFORM_WIN32_PC)
+//compares 16 bytes of pointers with the needle, returns a mask with all the bytes of each matching pointer set.
+static inline uint32 PointerSearchCompareSSE2(void const *const *pointers, __m128i needle)
+{
+    //compare 32 bits at a time
+    __m128i equal = _mm_cmpeq_epi32(_mm_loadu_si128((__m128i const *)pointers), needle);
+
+    //with 64 bit pointers, both halves must match.  SSE2 has no 64 bit compare.
+    if (sizeof(void *) == 8)
+    {
+        equal = _mm_and_si128(equal, _mm_shuffle_epi32(equal, _MM_SHUFFLE(2, 3, 0, 1)));
+    }
+
+    //one bit per byte
+    return uint32(_mm_movemask_epi8(equal));
+}
+
+//searches 32 bytes of pointers per loop with SSE2.
+static int32 PointerSearchSSE2(void const *const *pointers, int32 count, void const *value)
+{
+    //pointers per 16 bytes
+    int32 const lanes = int32(16 / sizeof(void *));
+
+    //fill a register with copies of the value
+    void const *fill[16 / sizeof(void *)];
+    for (int32 i = 0; i < lanes; i++)
+    {
+        fill[i] = value;
+    }
+    __m128i needle = _mm_loadu_si128((__m128i const *)fill);
+
+    //two registers at a time
+    int32 i = 0;
+    for (; i + lanes * 2 <= count; i += lanes * 2)
+    {
+        //compare both halves
+        uint32 mask = PointerSearchCompareSSE2(&pointers[i], needle) | (PointerSearchCompareSSE2(&pointers[i + lanes], needle) << 16);
+
+        //check if anything matched
+        if (mask != 0)
+        {
+            return i + PointerSearchFirst(mask);
+        }
+    }
+
+    //search the rest one at a time
+    return PointerSearchScalar(pointers, i, count, value);
+}
+#endif
+
+
+//
+//global functions
+//
+
+int32 PointerSearchVector(void const *const *pointers, int32 count, void const *value)
+{
+    #if defined(__PLATFORM_WIN32_PC)
+    //every PC we run on has SSE2
+    return PointerSearchSSE2(pointers, count, value);
+    #else
+    //no vector search
+    return PointerSearchScalar(pointers, 0, count, value);
+    #endif
+}
@@ -0,0 +1,201 @@
+//
+// v1 - Prototype character/item/tradeskill game.
+// Copyright (C) 2013 Adam Hayek (adam.hayek@gmail.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see [http://www.gnu.org/licenses/].
+//
+
+#include "common\global\global.h"
+
+//
+//local data
+//
+
+//the text of every number from 00 to 99, so digits can be written two at a time.
+static char const stringFormatPairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+//powers of 10 for the decimal places we support
+static double const stringFormatPowers[STRING_FORMAT_DECIMALS + 1] =
+{
+    1.0, 10.0, 100.0, 1000.0, 10000.0, 100000.0, 1000000.0, 10000000.0, 100000000.0, 1000000000.0
+};
+
+//doubles at least this big don't fit in an int64
+#define STRING_FORMAT_INT64_LIMIT 9.2e18
+
+
+//
+//local functions
+//
+
+//writes the digits of value backwards, ending just before end.  Returns the first digit written.
+static char *StringFormatDigits(uint64 value, char *end)
+{
+    //most values fit in 32 bits, where division is much cheaper
+    while (value > 0xFFFFFFFF)
+    {
+        uint64 rest = value / 100;
+        uint32 pair = uint32(value - rest * 100);
+        end -= 2;
+        end[0] = stringFormatPairs[pair * 2];
+        end[1] = stringFormatPairs[pair * 2 + 1];
+        value = rest;
+    }
+
+    //two digits at a time
+    uint32 small = uint32(value);
+    while (small >= 100)
+    {
+        uint32 pair = small % 100;
+        small /= 100;
+        end -= 2;
+        end[0] = stringFormatPairs[pair * 2];
+        end[1] = stringFormatPairs[pair * 2 + 1];
+    }
+
+    //the last one or two
+    if (small >= 10)
+    {
+        end -= 2;
+        end[0] = stringFormatPairs[small * 2];
+        end[1] = stringFormatPairs[small * 2 + 1];
+    }
+    else
+    {
+        *--end = char('0' + small);
+    }
+
+    return end;
+}
+
+//writes the digits of value forwards at text.  Returns the number written.
+static int32 StringFormatForwards(uint64 value, char *text)
+{
+    //write them backwards into a scratch space, then copy them
+    char digits[24];
+    char *first = StringFormatDigits(value, digits + sizeof(digits));
+    int32 count = int32(digits + sizeof(digits) - first);
+    memcpy(text, first, count);
+    return count;
+}
+
+
+//
+//global functions
+//
+
+int32 StringFormatInt(int64 value, char *text)
+{
+    //check for a sign
+    if (value < 0)
+    {
+        //the most negative value has no positive, so negate it unsigned
+        text[0] = '-';
+        return 1 + StringFormatForwards(uint64(0) - uint64(value), text + 1);
+    }
+
+    return StringFormatForwards(uint64(value), text);
+}
+
+int32 StringFormatFloat(double value, int32 decimals, char *text)
+{
+    //we don't do more decimal places than an int32 can scale
+    bound_var(decimals, 0, STRING_FORMAT_DECIMALS);
+
+    //not a number is the only value that isn't equal to itself
+    if (value != value)
+    {
+        memcpy(text, "nan", 3);
+        return 3;
+    }
+
+    //the sign
+    int32 count = 0;
+    if (value < 0.0)
+    {
+        text[count++] = '-';
+        value = -value;
+    }
+
+    //infinity is bigger than every number
+    if (value > 1.7976931348623157e308)
+    {
+        memcpy(&text[count], "inf", 3);
+        return count + 3;
+    }
+
+    //split off the integer part.  The subtraction is exact, so only the decimal places are rounded.
+    double integerPart = floor(value);
+    if (integerPart < STRING_FORMAT_INT64_LIMIT)
+    {
+        //round the decimal places
+        uint64 integer = uint64(int64(integerPart));
+        uint32 scale = uint32(stringFormatPowers[decimals]);
+        uint32 fraction = uint32((value - integerPart) * stringFormatPowers[decimals] + 0.5);
+
+        //rounding up can carry into the integer part
+        if (fraction >= scale)
+        {
+            fraction -= scale;
+            integer++;
+        }
+
+        //the integer part
+        count += StringFormatForwards(integer, &text[count]);
+
+        //the decimal places, with their leading zeros
+        if (decimals > 0)
+        {
+            text[count++] = '.';
+            char *end = &text[count + decimals];
+            char *first = (fraction > 0) ? StringFormatDigits(fraction, end) : end;
+            while (first > &text[count])
+            {
+                *--first = '0';
+            }
+            count += decimals;
+        }
+        return count;
+    }
+
+    //too big for an int64.  A double only holds about 17 digits, so write the leading ones and then zeros.
+    int32 zeros = 0;
+    while (value >= STRING_FORMAT_INT64_LIMIT)
+    {
+        value /= 10.0;
+        zeros++;
+    }
+    count += StringFormatForwards(uint64(int64(value)), &text[count]);
+    memset(&text[count], '0', zeros);
+    count += zeros;
+
+    //there are no digits left for decimal places
+    if (decimals > 0)
+    {
+        text[count++] = '.';
+        memset(&text[count], '0', decimals);
+        count += decimals;
+    }
+    return count;
+}
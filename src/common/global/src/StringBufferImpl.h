@@ -48,38 +48,73 @@ public:
         BufferLength = bufferLen
     };
 
-    //sets the string.  pass parameters like printf.
-    void Set(StringBufferImpl_CharType const *formatString, ...);
+    //sets the string.  pass parameters like printf.  Returns the new length.
+    int32 Set(StringBufferImpl_CharType const *formatString, ...);
 
-    //sets the string with explicit var args
-    void Sprintf(StringBufferImpl_CharType const *formatString, va_list args);
+    //sets the string with explicit var args.  Returns the new length.
+    int32 Sprintf(StringBufferImpl_CharType const *formatString, va_list args);
 
-    //copies a given number of characters from a string.
-    void Strncpy(StringBufferImpl_CharType const *str, int32 len);
+    //copies a given number of characters from a string.  Returns the new length.
+    int32 Strncpy(StringBufferImpl_CharType const *str, int32 len);
 
-    //appends a string onto what we already contain.
-    void Append(StringBufferImpl_CharType const *str);
-    void Append(StringBufferImpl_CharType c);
+    //appends a string onto what we already contain.  Only the appended characters are scanned.
+    StringBufferImpl_ClassName &Append(StringBufferImpl_CharType const *str);
+    StringBufferImpl_ClassName &Append(StringBufferImpl_CharType const *str, int32 len);
+    StringBufferImpl_ClassName &Append(StringBufferImpl_CharType c);
+
+    //typed appends, which replace printf for text built every frame.  The format is the order of the
+    //calls, so nothing is parsed at runtime.  Numbers narrower than width are padded with spaces on the
+    //left, like printf's "%3d".  They return us, so calls can be chained:
+    //
+    //  text.AppendFloat(fps, 0, 3).Append(L" FPS");      //same as text.Set(L"%3.0f FPS", fps)
+    //
+    StringBufferImpl_ClassName &AppendInt(int64 value, int32 width = 0);
+    StringBufferImpl_ClassName &AppendFloat(double value, int32 decimals = 2, int32 width = 0);
 
     //returns the name as a null terminated string.
     inline operator StringBufferImpl_CharType const *() const;
 
     //copies the given null-terminated string.  NULL or empty strings set the buffer to ""
-    StringBufferImpl_CharType const *operator=(StringBufferImpl_CharType const *str);
+    StringBufferImpl_ClassName &operator=(StringBufferImpl_CharType const *str);
 
     //returns true if the string has no characters.
-    bool Empty();
+    inline bool Empty() const;
 
     //get the string
     StringBufferImpl_CharType const *Str() const;
 
+    //number of characters in the string, not counting the null.
+    inline int32 Length() const;
+
+    //the most characters the buffer can hold, not counting the null.
+    inline int32 Capacity() const;
+
+    //returns true if the buffer can hold a string of the given length.  The storage is fixed, so
+    //this never allocates; use it to check for room before building a long string.
+    inline bool Reserve(int32 len) const;
+
+    //shortens the string to the given length.  Longer lengths leave the string alone.
+    inline void Truncate(int32 len);
+
     #if StringBufferImpl_CharSize == 1
-    //convert to utf-8... maybe?
-    char const *operator=(wchar const *wcs);
+    //converts a wide string to UTF-8, see Utf.h.
+    StringBufferImpl_ClassName &operator=(wchar const *wcs);
+    #else
+    //converts a UTF-8 string to a wide string, see Utf.h.
+    StringBufferImpl_ClassName &operator=(char const *utf8);
     #endif
 
 protected:
     StringBufferImpl_CharType buffer[bufferLen];
+
+    //number of characters before the null
+    int32 length;
+
+    //takes the length after a printf, which reports an error or the length it wanted when it didn't fit.
+    inline int32 Printed(int32 result);
+
+    //appends the text of a number, padded on the left to the given width.
+    StringBufferImpl_ClassName &AppendNumber(char const *text, int32 count, int32 width);
 private:
     StringBufferImpl_ClassName(StringBufferImpl_ClassName const &other);
 };
@@ -88,6 +123,7 @@ template <int32 bufferLen>
 StringBufferImpl_ClassName<bufferLen>::StringBufferImpl_ClassName()
 {
     buffer[0] = '\0';
+    length = 0;
 }
 
 template <int32 bufferLen>
@@ -98,31 +134,55 @@ StringBufferImpl_ClassName<bufferLen>::StringBufferImpl_ClassName(StringBufferIm
 }
 
 template <int32 bufferLen>
-void StringBufferImpl_ClassName<bufferLen>::Set(StringBufferImpl_CharType const *formatString, ...)
+int32 StringBufferImpl_ClassName<bufferLen>::Set(StringBufferImpl_CharType const *formatString, ...)
 {
     //get our parameter list.
     va_list args;
     va_start(args, formatString);
 
     //call sprintf
-    StringBufferImpl_Sprintf(buffer, bufferLen, formatString, args);
+    int32 result = (int32)StringBufferImpl_Sprintf(buffer, bufferLen, formatString, args);
+    va_end(args);
 
     //put a null at the end.
     buffer[bufferLen - 1] = '\0';
+
+    //remember how much we wrote
+    return Printed(result);
 }
 
 template <int32 bufferLen>
-void StringBufferImpl_ClassName<bufferLen>::Sprintf(StringBufferImpl_CharType const *formatString, va_list args)
+int32 StringBufferImpl_ClassName<bufferLen>::Sprintf(StringBufferImpl_CharType const *formatString, va_list args)
 {
     //call sprintf
-    StringBufferImpl_Sprintf(buffer, bufferLen, formatString, args);
+    int32 result = (int32)StringBufferImpl_Sprintf(buffer, bufferLen, formatString, args);
 
     //put a null at the end.
     buffer[bufferLen - 1] = '\0';
+
+    //remember how much we wrote
+    return Printed(result);
+}
+
+template <int32 bufferLen>
+int32 StringBufferImpl_ClassName<bufferLen>::Printed(int32 result)
+{
+    //check if the whole string fit
+    if (result >= 0 && result < bufferLen)
+    {
+        length = result;
+    }
+    else
+    {
+        //it was cut off or failed, so count what is there
+        length = (int32)StringBufferImpl_Strlen(buffer);
+    }
+
+    return length;
 }
 
 template <int32 bufferLen>
-void StringBufferImpl_ClassName<bufferLen>::Strncpy(StringBufferImpl_CharType const *str, int32 len)
+int32 StringBufferImpl_ClassName<bufferLen>::Strncpy(StringBufferImpl_CharType const *str, int32 len)
 {
     //make sure we dont copy more characters than we can
     bound_max(len, bufferLen - 1);
@@ -132,36 +192,105 @@ void StringBufferImpl_ClassName<bufferLen>::Strncpy(StringBufferImpl_CharType co
 
     //null terminate
     buffer[len] = '\0';
+
+    //the copy stops early at a null in the string
+    length = (int32)StringBufferImpl_Strlen(buffer);
+    return length;
 }
 
 template <int32 bufferLen>
-void StringBufferImpl_ClassName<bufferLen>::Append(StringBufferImpl_CharType const *str)
+StringBufferImpl_ClassName<bufferLen> &StringBufferImpl_ClassName<bufferLen>::Append(StringBufferImpl_CharType const *str)
 {
-    //get our current length.
-    int32 len = (int32)StringBufferImpl_Strlen(buffer);
-    
-    //copy characters from the given string.
-    ::StringBufferImpl_Strncpy(&buffer[len], str, bufferLen - len - 1);
+    IFBREAKRETURNVAL(str == NULL, *this);
+
+    //copy characters until the string ends or we run out of room
+    while (*str != '\0' && length < bufferLen - 1)
+    {
+        buffer[length++] = *str++;
+    }
 
     //null terminate
-    buffer[bufferLen - 1] = '\0';
+    buffer[length] = '\0';
+    return *this;
 }
 
 template <int32 bufferLen>
-void StringBufferImpl_ClassName<bufferLen>::Append(StringBufferImpl_CharType c)
+StringBufferImpl_ClassName<bufferLen> &StringBufferImpl_ClassName<bufferLen>::Append(StringBufferImpl_CharType const *str, int32 len)
 {
-    //get our current length.
-    int32 len = (int32)StringBufferImpl_Strlen(buffer);
+    IFBREAKRETURNVAL(str == NULL && len > 0, *this);
 
+    //make sure we dont copy more characters than we have room for
+    bound_max(len, bufferLen - 1 - length);
+
+    //copy the characters after ours
+    if (len > 0)
+    {
+        memcpy(&buffer[length], str, sizeof(StringBufferImpl_CharType) * len);
+        length += len;
+    }
+
+    //null terminate
+    buffer[length] = '\0';
+    return *this;
+}
+
+template <int32 bufferLen>
+StringBufferImpl_ClassName<bufferLen> &StringBufferImpl_ClassName<bufferLen>::Append(StringBufferImpl_CharType c)
+{
     //check if we have room
-    if (len < bufferLen - 1)
+    if (length < bufferLen - 1)
     {
         //add the character
-        buffer[len] = c;
+        buffer[length++] = c;
 
         //null terminate
-        buffer[len + 1] = 0;
+        buffer[length] = 0;
+    }
+    return *this;
+}
+
+template <int32 bufferLen>
+StringBufferImpl_ClassName<bufferLen> &StringBufferImpl_ClassName<bufferLen>::AppendInt(int64 value, int32 width)
+{
+    //convert it
+    char text[STRING_FORMAT_MAX];
+    int32 count = ::StringFormatInt(value, text);
+
+    //add it
+    return AppendNumber(text, count, width);
+}
+
+template <int32 bufferLen>
+StringBufferImpl_ClassName<bufferLen> &StringBufferImpl_ClassName<bufferLen>::AppendFloat(double value, int32 decimals, int32 width)
+{
+    //convert it
+    char text[STRING_FORMAT_MAX];
+    int32 count = ::StringFormatFloat(value, decimals, text);
+
+    //add it
+    return AppendNumber(text, count, width);
+}
+
+template <int32 bufferLen>
+StringBufferImpl_ClassName<bufferLen> &StringBufferImpl_ClassName<bufferLen>::AppendNumber(char const *text, int32 count, int32 width)
+{
+    //pad on the left
+    for (int32 i = count; i < width && length < bufferLen - 1; i++)
+    {
+        buffer[length++] = ' ';
     }
+
+    //copy as much of the number as fits, widening the characters if we need to
+    int32 room = bufferLen - 1 - length;
+    bound_max(count, room);
+    for (int32 i = 0; i < count; i++)
+    {
+        buffer[length++] = StringBufferImpl_CharType(text[i]);
+    }
+
+    //null terminate
+    buffer[length] = '\0';
+    return *this;
 }
 
 template <int32 bufferLen>
@@ -171,12 +300,13 @@ StringBufferImpl_ClassName<bufferLen>::operator StringBufferImpl_CharType const
 }
 
 template <int32 bufferLen>
-StringBufferImpl_CharType const *StringBufferImpl_ClassName<bufferLen>::operator=(StringBufferImpl_CharType const *str)
+StringBufferImpl_ClassName<bufferLen> &StringBufferImpl_ClassName<bufferLen>::operator=(StringBufferImpl_CharType const *str)
 {
     if (str == NULL || str[0] == '\0')
     {
         buffer[0] = '\0';
-        return buffer;
+        length = 0;
+        return *this;
     }
 
     //copy the string, converting to lower case.
@@ -185,13 +315,15 @@ StringBufferImpl_CharType const *StringBufferImpl_ClassName<bufferLen>::operator
     //make the last character null.
     buffer[bufferLen - 1] = '\0';
 
-    return buffer;
+    //count what we got
+    length = (int32)StringBufferImpl_Strlen(buffer);
+    return *this;
 }
 
 template <int32 bufferLen>
-bool StringBufferImpl_ClassName<bufferLen>::Empty()
+bool StringBufferImpl_ClassName<bufferLen>::Empty() const
 {
-    return buffer[0] == '\0';
+    return length == 0;
 }
 
 template <int32 bufferLen>
@@ -201,98 +333,55 @@ StringBufferImpl_CharType const *StringBufferImpl_ClassName<bufferLen>::Str() co
     return buffer;
 }
 
-#if StringBufferImpl_CharSize == 1
 template <int32 bufferLen>
-char const *StringBufferImpl_ClassName<bufferLen>::operator=(wchar const *wcs)
+int32 StringBufferImpl_ClassName<bufferLen>::Length() const
+{
+    return length;
+}
+
+template <int32 bufferLen>
+int32 StringBufferImpl_ClassName<bufferLen>::Capacity() const
+{
+    return bufferLen - 1;
+}
+
+template <int32 bufferLen>
+bool StringBufferImpl_ClassName<bufferLen>::Reserve(int32 len) const
 {
-    //position we write to
-    int32 pos = 0;
+    return len <= bufferLen - 1;
+}
 
-    //write characters until we run out of space
-    while (*wcs != 0)
+template <int32 bufferLen>
+void StringBufferImpl_ClassName<bufferLen>::Truncate(int32 len)
+{
+    //check if we are longer
+    if (len >= 0 && len < length)
     {
-        //value of this character
-        int32 value = *wcs;
-
-        //check the value
-        if (value < 0x7f && pos < bufferLen - 2)
-        {
-            //this converts to a single character
-            buffer[pos] = (char)(uint8)value;
-            pos += 1;
-        }
-        else if (value < 0x7ff && pos < bufferLen - 3)
-        {
-            //convert to two characters
-            buffer[1] = (char)(uint8)(value & 0x3F | 0x80);
-            value >>= 6;
-            buffer[0] = (char)(uint8)(value & 0x1F | 0xC0);
-            pos += 2;
-        }
-        else if (pos < bufferLen - 4) //else if( value <= 0x0000FFFF )
-        {
-            //convert to three characters
-            buffer[2] = (char)(uint8)(value & 0x3F | 0x80);
-            value >>= 6;
-            buffer[1] = (char)(uint8)(value & 0x3F | 0x80);
-            value >>= 6;
-            buffer[0] = (char)(uint8)(value & 0x0F | 0xE0);
-            pos += 3;
-        }
-        //else if( value <= 0x001FFFFF )
-        //{
-        //    buf[3] = (unsigned char)(value & 0x3F | 0x80);
-        //    value>>=6;
-        //    buf[2] = (unsigned char)(value & 0x3F | 0x80);
-        //    value>>=6;
-        //    buf[1] = (unsigned char)(value & 0x3F | 0x80);
-        //    value>>=6;
-        //    buf[0] = (unsigned char)(value & 0x07 | 0xF0);
-        //    return 4;
-        //}
-        //else if( value <= 0x03FFFFFF )
-        //{
-        //    buf[4] = (unsigned char)(value & 0x3F | 0x80);
-        //    value>>=6;
-        //    buf[3] = (unsigned char)(value & 0x3F | 0x80);
-        //    value>>=6;
-        //    buf[2] = (unsigned char)(value & 0x3F | 0x80);
-        //    value>>=6;
-        //    buf[1] = (unsigned char)(value & 0x3F | 0x80);
-        //    value>>=6;
-        //    buf[0] = (unsigned char)(value & 0x03 | 0xF8);
-        //    return 5;
-        //}
-        //else if( value <= 0x7FFFFFFF )
-        //{
-        //    buf[5] = (unsigned char)(value & 0x3F | 0x80);
-        //    value>>=6;
-        //    buf[4] = (unsigned char)(value & 0x3F | 0x80);
-        //    value>>=6;
-        //    buf[3] = (unsigned char)(value & 0x3F | 0x80);
-        //    value>>=6;
-        //    buf[2] = (unsigned char)(value & 0x3F | 0x80);
-        //    value>>=6;
-        //    buf[1] = (unsigned char)(value & 0x3F | 0x80);
-        //    value>>=6;
-        //    buf[0] = (unsigned char)(value & 0x01 | 0xFC);
-        //    return 6;
-        //}
-        else
-        {
-            //we ran out of space
-            break;
-        }
-
-        //go to the next character
-        wcs++;
+        //cut it off there
+        buffer[len] = '\0';
+        length = len;
     }
+}
+
+#if StringBufferImpl_CharSize == 1
+template <int32 bufferLen>
+StringBufferImpl_ClassName<bufferLen> &StringBufferImpl_ClassName<bufferLen>::operator=(wchar const *wcs)
+{
+    //convert as much as fits, without splitting a character
+    length = ::Utf8FromWide(buffer, bufferLen, wcs);
 
-    //make sure it's null terminated.
-    buffer[pos] = 0;
+    //we return ourself
+    return *this;
+}
+#else
+template <int32 bufferLen>
+StringBufferImpl_ClassName<bufferLen> &StringBufferImpl_ClassName<bufferLen>::operator=(char const *utf8)
+{
+    //convert as much as fits, without splitting a character
+    length = ::WideFromUtf8(buffer, bufferLen, utf8);
 
     //we return ourself
-    return &buffer[0];
+    return *this;
 }
 #endif
 
@@ -0,0 +1,486 @@
+//
+// v1 - Prototype character/item/tradeskill game.
+// Copyright (C) 2013 Adam Hayek (adam.hayek@gmail.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see [http://www.gnu.org/licenses/].
+//
+
+#include <string.h>
+#include <wchar.h>
+#include "common\global\global.h"
+#include "common\global\Utf.h"
+
+//wchar is UTF-16 on Windows, and UTF-32 on most other platforms
+#if WCHAR_MAX <= 0xFFFF
+#define UTF_WIDE16
+#endif
+
+//the number of units converted at once by the ASCII fast paths
+#define UTF_BLOCK 16
+
+//
+//local functions
+//
+
+//decodes the character at src[i], moving i past it.  Returns UTF_REPLACEMENT for a maximal
+//invalid subpart, which is the lead byte and however many of its continuation bytes were right.
+static uint32 Utf8Decode(uint8 const *src, int32 &i, int32 end)
+{
+    //the lead byte
+    uint32 lead = src[i++];
+    if (lead < 0x80)
+    {
+        return lead;
+    }
+
+    //the number of continuation bytes, and the range of the first one, which rules out overlong
+    //encodings, surrogates and values past U+10FFFF.
+    int32 need = 0;
+    uint32 lower = 0x80;
+    uint32 upper = 0xBF;
+    uint32 value = 0;
+    if (lead >= 0xC2 && lead <= 0xDF)
+    {
+        need = 1;
+        value = lead & 0x1F;
+    }
+    else if (lead >= 0xE0 && lead <= 0xEF)
+    {
+        need = 2;
+        value = lead & 0x0F;
+        if (lead == 0xE0) { lower = 0xA0; }
+        if (lead == 0xED) { upper = 0x9F; }
+    }
+    else if (lead >= 0xF0 && lead <= 0xF4)
+    {
+        need = 3;
+        value = lead & 0x07;
+        if (lead == 0xF0) { lower = 0x90; }
+        if (lead == 0xF4) { upper = 0x8F; }
+    }
+    else
+    {
+        //a continuation byte or a byte which never appears in UTF-8
+        return UTF_REPLACEMENT;
+    }
+
+    //the continuation bytes
+    for (int32 k = 0; k < need; k++)
+    {
+        //check if the sequence is cut off or broken here, which leaves this byte for the next character
+        if (i >= end || src[i] < lower || src[i] > upper)
+        {
+            return UTF_REPLACEMENT;
+        }
+
+        //add its bits
+        value = (value << 6) | (src[i++] & 0x3F);
+
+        //only the first continuation byte has a narrower range
+        lower = 0x80;
+        upper = 0xBF;
+    }
+
+    return value;
+}
+
+//encodes a character as UTF-8.  Returns the number of bytes, which are written to out.
+static int32 Utf8Encode(uint32 value, char *out)
+{
+    if (value < 0x80)
+    {
+        out[0] = char(value);
+        return 1;
+    }
+    if (value < 0x800)
+    {
+        out[0] = char(0xC0 | (value >> 6));
+        out[1] = char(0x80 | (value & 0x3F));
+        return 2;
+    }
+    if (value < 0x10000)
+    {
+        out[0] = char(0xE0 | (value >> 12));
+        out[1] = char(0x80 | ((value >> 6) & 0x3F));
+        out[2] = char(0x80 | (value & 0x3F));
+        return 3;
+    }
+    out[0] = char(0xF0 | (value >> 18));
+    out[1] = char(0x80 | ((value >> 12) & 0x3F));
+    out[2] = char(0x80 | ((value >> 6) & 0x3F));
+    out[3] = char(0x80 | (value & 0x3F));
+    return 4;
+}
+
+//decodes the character at src[i], moving i past it.  Returns UTF_REPLACEMENT for anything that isn't a character.
+static uint32 WideDecode(wchar const *src, int32 &i, int32 end)
+{
+    uint32 value = uint32(src[i++]);
+
+    #if defined(UTF_WIDE16)
+    //check for a surrogate pair
+    if (value >= 0xD800 && value <= 0xDBFF)
+    {
+        //it needs a low surrogate after it
+        if (i < end && uint32(src[i]) >= 0xDC00 && uint32(src[i]) <= 0xDFFF)
+        {
+            return 0x10000 + ((value - 0xD800) << 10) + (uint32(src[i++]) - 0xDC00);
+        }
+        return UTF_REPLACEMENT;
+    }
+    #endif
+
+    //lone surrogates and values past the last character
+    if ((value >= 0xD800 && value <= 0xDFFF) || value > 0x10FFFF)
+    {
+        return UTF_REPLACEMENT;
+    }
+
+    return value;
+}
+
+//encodes a character as wchars.  Returns the number of wchars, which are written to out.
+static int32 WideEncode(uint32 value, wchar *out)
+{
+    #if defined(UTF_WIDE16)
+    //characters past the basic plane need a surrogate pair
+    if (value >= 0x10000)
+    {
+        value -= 0x10000;
+        out[0] = wchar(0xD800 + (value >> 10));
+        out[1] = wchar(0xDC00 + (value & 0x3FF));
+        return 2;
+    }
+    #endif
+
+    out[0] = wchar(value);
+    return 1;
+}
+
+#if defined(__PLATFORM_WIN32_PC)
+//converts the UTF_BLOCK wchars at src to chars at dest (unless dest is NULL).  Returns how many of
+//them, from the start, are ASCII; the chars past those are garbage for the caller to overwrite.
+static inline int32 Utf8FromWideBlock(char *dest, wchar const *src)
+{
+    __m128i zero = _mm_setzero_si128();
+
+    #if defined(UTF_WIDE16)
+    //8 wchars per register
+    __m128i a = _mm_loadu_si128((__m128i const *)&src[0]);
+    __m128i b = _mm_loadu_si128((__m128i const *)&src[8]);
+
+    //narrow them to bytes
+    __m128i bytes = _mm_packus_epi16(a, b);
+    #else
+    //4 wchars per register
+    __m128i a = _mm_loadu_si128((__m128i const *)&src[0]);
+    __m128i b = _mm_loadu_si128((__m128i const *)&src[4]);
+    __m128i c = _mm_loadu_si128((__m128i const *)&src[8]);
+    __m128i d = _mm_loadu_si128((__m128i const *)&src[12]);
+
+    //narrow them to bytes, the ASCII ones come through unchanged
+    __m128i bytes = _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+    #endif
+
+    //store them
+    if (dest != NULL)
+    {
+        _mm_storeu_si128((__m128i *)dest, bytes);
+    }
+
+    //check if they're all ASCII, no wchar having bits above the low 7
+    #if defined(UTF_WIDE16)
+    __m128i mask = _mm_set1_epi16(short(0xFF80));
+    if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(_mm_or_si128(a, b), mask), zero)) == 0xFFFF)
+    {
+        return UTF_BLOCK;
+    }
+
+    //otherwise a byte per wchar, set when it's ASCII
+    __m128i ascii = _mm_packs_epi16(_mm_cmpeq_epi16(_mm_and_si128(a, mask), zero), _mm_cmpeq_epi16(_mm_and_si128(b, mask), zero));
+    #else
+    __m128i mask = _mm_set1_epi32(int(0xFFFFFF80));
+    __m128i all = _mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d));
+    if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(all, mask), zero)) == 0xFFFF)
+    {
+        return UTF_BLOCK;
+    }
+
+    //otherwise a byte per wchar, set when it's ASCII
+    __m128i asciiLow = _mm_packs_epi32(_mm_cmpeq_epi32(_mm_and_si128(a, mask), zero), _mm_cmpeq_epi32(_mm_and_si128(b, mask), zero));
+    __m128i asciiHigh = _mm_packs_epi32(_mm_cmpeq_epi32(_mm_and_si128(c, mask), zero), _mm_cmpeq_epi32(_mm_and_si128(d, mask), zero));
+    __m128i ascii = _mm_packs_epi16(asciiLow, asciiHigh);
+    #endif
+
+    //count the ASCII ones up to the first that isn't
+    unsigned long count = 0;
+    _BitScanForward(&count, uint32(~_mm_movemask_epi8(ascii)));
+    return int32(count);
+}
+
+//converts the UTF_BLOCK chars at src to wchars at dest (unless dest is NULL).  Returns how many of
+//them, from the start, are ASCII; the wchars past those are garbage for the caller to overwrite.
+static inline int32 WideFromUtf8Block(wchar *dest, char const *src)
+{
+    //ASCII bytes have the high bit clear
+    __m128i bytes = _mm_loadu_si128((__m128i const *)src);
+
+    //widen them
+    if (dest != NULL)
+    {
+        __m128i zero = _mm_setzero_si128();
+        __m128i low = _mm_unpacklo_epi8(bytes, zero);
+        __m128i high = _mm_unpackhi_epi8(bytes, zero);
+        #if defined(UTF_WIDE16)
+        _mm_storeu_si128((__m128i *)&dest[0], low);
+        _mm_storeu_si128((__m128i *)&dest[8], high);
+        #else
+        _mm_storeu_si128((__m128i *)&dest[0], _mm_unpacklo_epi16(low, zero));
+        _mm_storeu_si128((__m128i *)&dest[4], _mm_unpackhi_epi16(low, zero));
+        _mm_storeu_si128((__m128i *)&dest[8], _mm_unpacklo_epi16(high, zero));
+        _mm_storeu_si128((__m128i *)&dest[12], _mm_unpackhi_epi16(high, zero));
+        #endif
+    }
+
+    //count the ASCII ones up to the first that isn't
+    uint32 high = uint32(_mm_movemask_epi8(bytes));
+    if (high == 0)
+    {
+        return UTF_BLOCK;
+    }
+    unsigned long count = 0;
+    _BitScanForward(&count, high);
+    return int32(count);
+}
+#endif
+
+
+//
+//global functions
+//
+
+int32 Utf8FromWide(char *dest, int32 destLen, wchar const *src, int32 srcLen)
+{
+    IFBREAKRETURNVAL(dest != NULL && destLen < 1, 0);
+
+    //no string converts to an empty one
+    if (src == NULL)
+    {
+        srcLen = 0;
+    }
+    else if (srcLen < 0)
+    {
+        //the vector loads must not read past the end of the string
+        srcLen = (int32)wcslen(src);
+    }
+
+    //the most chars we can write before the null
+    int32 room = (dest != NULL) ? destLen - 1 : 0x7FFFFFFF;
+
+    //convert
+    int32 pos = 0;
+    int32 i = 0;
+    while (i < srcLen)
+    {
+        #if defined(__PLATFORM_WIN32_PC)
+        //try a block of ASCII at once
+        if (i + UTF_BLOCK <= srcLen && pos + UTF_BLOCK <= room)
+        {
+            //take the ASCII run at the start of it, leaving the character that ended it for below
+            int32 count = Utf8FromWideBlock((dest != NULL) ? &dest[pos] : NULL, &src[i]);
+            i += count;
+            pos += count;
+            if (count == UTF_BLOCK)
+            {
+                continue;
+            }
+        }
+        #endif
+
+        //a single ASCII wchar, without the general encode
+        if (uint32(src[i]) < 0x80)
+        {
+            if (pos >= room)
+            {
+                break;
+            }
+            if (dest != NULL)
+            {
+                dest[pos] = char(src[i]);
+            }
+            pos++;
+            i++;
+            continue;
+        }
+
+        //one character
+        char bytes[4];
+        int32 start = i;
+        int32 count = Utf8Encode(WideDecode(src, i, srcLen), bytes);
+
+        //check if it fits
+        if (pos + count > room)
+        {
+            i = start;
+            break;
+        }
+
+        //copy it
+        if (dest != NULL)
+        {
+            for (int32 k = 0; k < count; k++)
+            {
+                dest[pos + k] = bytes[k];
+            }
+        }
+        pos += count;
+    }
+
+    //null terminate
+    if (dest != NULL)
+    {
+        dest[pos] = '\0';
+    }
+    return pos;
+}
+
+int32 WideFromUtf8(wchar *dest, int32 destLen, char const *src, int32 srcLen)
+{
+    IFBREAKRETURNVAL(dest != NULL && destLen < 1, 0);
+
+    //no string converts to an empty one
+    if (src == NULL)
+    {
+        srcLen = 0;
+    }
+    else if (srcLen < 0)
+    {
+        //the vector loads must not read past the end of the string
+        srcLen = (int32)strlen(src);
+    }
+
+    //the most wchars we can write before the null
+    int32 room = (dest != NULL) ? destLen - 1 : 0x7FFFFFFF;
+
+    //convert
+    uint8 const *bytes = (uint8 const *)src;
+    int32 pos = 0;
+    int32 i = 0;
+    while (i < srcLen)
+    {
+        #if defined(__PLATFORM_WIN32_PC)
+        //try a block of ASCII at once
+        if (i + UTF_BLOCK <= srcLen && pos + UTF_BLOCK <= room)
+        {
+            //take the ASCII run at the start of it, leaving the character that ended it for below
+            int32 count = WideFromUtf8Block((dest != NULL) ? &dest[pos] : NULL, &src[i]);
+            i += count;
+            pos += count;
+            if (count == UTF_BLOCK)
+            {
+                continue;
+            }
+        }
+        #endif
+
+        //a single ASCII byte, without the general decode
+        if (bytes[i] < 0x80)
+        {
+            if (pos >= room)
+            {
+                break;
+            }
+            if (dest != NULL)
+            {
+                dest[pos] = wchar(bytes[i]);
+            }
+            pos++;
+            i++;
+            continue;
+        }
+
+        //one character
+        wchar units[2];
+        int32 start = i;
+        int32 count = WideEncode(Utf8Decode(bytes, i, srcLen), units);
+
+        //check if it fits
+        if (pos + count > room)
+        {
+            i = start;
+            break;
+        }
+
+        //copy it
+        if (dest != NULL)
+        {
+            for (int32 k = 0; k < count; k++)
+            {
+                dest[pos + k] = units[k];
+            }
+        }
+        pos += count;
+    }
+
+    //null terminate
+    if (dest != NULL)
+    {
+        dest[pos] = 0;
+    }
+    return pos;
+}
+
+bool Utf8Valid(char const *src, int32 srcLen)
+{
+    //no string is an empty one
+    if (src == NULL)
+    {
+        return true;
+    }
+    if (srcLen < 0)
+    {
+        srcLen = (int32)strlen(src);
+    }
+
+    //decode every character
+    uint8 const *bytes = (uint8 const *)src;
+    int32 i = 0;
+    while (i < srcLen)
+    {
+        #if defined(__PLATFORM_WIN32_PC)
+        //skip the ASCII at the start of a block, decoding the character that ended it below
+        if (i + UTF_BLOCK <= srcLen)
+        {
+            uint32 high = uint32(_mm_movemask_epi8(_mm_loadu_si128((__m128i const *)&src[i])));
+            if (high == 0)
+            {
+                i += UTF_BLOCK;
+                continue;
+            }
+            unsigned long count = 0;
+            _BitScanForward(&count, high);
+            i += int32(count);
+        }
+        #endif
+
+        //a U+FFFD in the text is three bytes starting with EF.  Bad input never decodes three bytes before failing.
+        int32 start = i;
+        if (Utf8Decode(bytes, i, srcLen) == UTF_REPLACEMENT && (i - start != 3 || bytes[start] != 0xEF))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
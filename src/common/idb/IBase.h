@@ -30,6 +30,10 @@ class IBase
 public:
     //function defined by the implementation class
     virtual const char *__implName() = 0;
+
+    //initializes the implementation, called once by InterfaceStartup.  Interfaces which need it
+    //declare it again; the others get this one, which does nothing.
+    virtual bool Startup(Context &caller);
 };
 
 //
@@ -47,18 +51,103 @@ public:
 //It creates a static object of type InterfaceDatabase::Implementation.
 //The first parameter is the actual statically defined object of the implementation class.
 //The second and third parameters are the name of the interface and the instance name 
-//that the object implements.
+//that the object implements.  They are joined into a string literal key, hashed by the compiler.
 //
 
 #define InterfaceRegister(instObj, ifaceName, instName) \
-    static InterfaceDatabase::Implementation __implVar_##ifaceName##_##instName##_(static_cast<ifaceName &>(instObj), instObj.__implName(), #ifaceName "." #instName);
+    static InterfaceDatabase::Implementation __implVar_##ifaceName##_##instName##_(static_cast<ifaceName &>(instObj), instObj.__implName(), InterfaceDatabase::Key(#ifaceName "." #instName));
 
 #define InterfaceInNamespaceRegister(instObj, namespaceName, ifaceName, instName) \
-    static InterfaceDatabase::Implementation __implVar_##namespaceName##_##ifaceName##_##instName##_(static_cast<ifaceName &>(instObj), instObj.__implName(), #namespaceName "::" #ifaceName "." #instName);
+    static InterfaceDatabase::Implementation __implVar_##namespaceName##_##ifaceName##_##instName##_(static_cast<ifaceName &>(instObj), instObj.__implName(), InterfaceDatabase::Key(#namespaceName "::" #ifaceName "." #instName));
 
 //
-//Instantiate and register an implementation class
+//Static interface builds.  A build which links exactly one implementation of each interface it
+//uses can define __CONFIG_STATIC_INTERFACES to bind its references when the program is linked,
+//instead of through the database.  Each interface's implementation is named with
+//InterfaceStatic, and each reference is declared with InterfacePointer, which is then a pointer to
+//the sealed implementation class instead of to the interface.  Calls through it are direct calls
+//the compiler can inline, across files with whole program optimization.  Without the define,
+//InterfacePointer is a pointer to the interface and everything goes through the database.
+//The InterfaceStatic lines go in a bindings header of their own, so the interface headers don't
+//include implementation classes, and only files declaring a reference include it.
+//
+//  //in sim\src\StaticInterfaces.h
+//  #if defined(__CONFIG_STATIC_INTERFACES)
+//  #include "sim\win32\TimeImpl.h"
+//  InterfaceStatic(ITime, default, TimeImpl);
+//  #endif
+//
+//  //in TimeImpl.h
+//  class TimeImpl InterfaceSealed : public ITime
+//
+//  //where it's used
+//  #include "sim\ITime.h"
+//  #include "sim\src\StaticInterfaces.h"
+//  static InterfacePointer(ITime, default) timer;
+//  InterfaceReference(timer, ITime, default);
 //
+//Static references can't be switched with InterfaceUse.
+//
+
+#if defined(__CONFIG_STATIC_INTERFACES)
+
+//the implementation class can't be derived from, so calls through a pointer to it aren't virtual
+#define InterfaceSealed sealed
+
+//names the implementation class of an interface and its instantiation, which InterfaceCreate makes
+#define InterfaceStatic(ifaceName, instName, implClass) \
+    class implClass; \
+    typedef implClass __ifaceStatic_##ifaceName##_##instName; \
+    extern implClass __implInst_##ifaceName##_##instName
+
+#define InterfaceInNamespaceStatic(namespaceName, ifaceName, instName, implClass) \
+    class implClass; \
+    typedef implClass __ifaceStatic_##namespaceName##_##ifaceName##_##instName; \
+    extern implClass __implInst_##namespaceName##_##ifaceName##_##instName
+
+//the type of a reference variable
+#define InterfacePointer(ifaceName, instName) __ifaceStatic_##ifaceName##_##instName *
+#define InterfaceInNamespacePointer(namespaceName, ifaceName, instName) __ifaceStatic_##namespaceName##_##ifaceName##_##instName *
+
+//points a static reference at its implementation during static initialization.
+template <class ImplClass> class InterfaceStaticReference
+{
+public:
+    inline InterfaceStaticReference(ImplClass *&refVar, ImplClass &impl)
+    {
+        refVar = &impl;
+    }
+};
+
+#else
+
+#define InterfaceSealed
+#define InterfaceStatic(ifaceName, instName, implClass)
+#define InterfaceInNamespaceStatic(namespaceName, ifaceName, instName, implClass)
+#define InterfacePointer(ifaceName, instName) ifaceName *
+#define InterfaceInNamespacePointer(namespaceName, ifaceName, instName) ifaceName *
+
+#endif
+
+
+//
+//Instantiate and register an implementation class.  In static interface builds the object has
+//a global name, so static references can link to it.
+//
+
+#if defined(__CONFIG_STATIC_INTERFACES)
+
+#define InterfaceCreate(implClass, implVar, ifaceName, instName) \
+    implClass __implInst_##ifaceName##_##instName; \
+    static implClass &implVar = __implInst_##ifaceName##_##instName; \
+    InterfaceRegister(implVar, ifaceName, instName);
+
+#define InterfaceInNamespaceCreate(implClass, implVar, namespaceName, ifaceName, instName) \
+    implClass __implInst_##namespaceName##_##ifaceName##_##instName; \
+    static implClass &implVar = __implInst_##namespaceName##_##ifaceName##_##instName; \
+    InterfaceInNamespaceRegister(implVar, namespaceName, ifaceName, instName);
+
+#else
 
 #define InterfaceCreate(implClass, implVar, ifaceName, instName) \
     static implClass implVar; \
@@ -68,18 +157,250 @@ public:
     static implClass implVar; \
     InterfaceInNamespaceRegister(implVar, namespaceName, ifaceName, instName);
 
+#endif
+
 
 //
 //Adds an interface reference to the database.  It creates a static object
 //of type InterfaceDatabase::reference.  The first parameter
 //is a statically defined pointer to the desired interface class.  
 //The second and third parameters are the name of the interface and the instance name
-//of the desired interface.
+//of the desired interface, which make its key the same way.
+//In static interface builds the pointer is set to the implementation directly instead.
 //
 
+#if defined(__CONFIG_STATIC_INTERFACES)
+
+#define InterfaceReference(refVar, ifaceName, instName) \
+    static InterfaceStaticReference<__ifaceStatic_##ifaceName##_##instName> __refVar_##ifaceName##_##instName##_(refVar, __implInst_##ifaceName##_##instName);
+
+#define InterfaceInNamespaceReference(refVar, namespaceName, ifaceName, instName) \
+    static InterfaceStaticReference<__ifaceStatic_##namespaceName##_##ifaceName##_##instName> __refVar_##namespaceName##_##ifaceName##_##instName##_(refVar, __implInst_##namespaceName##_##ifaceName##_##instName);
+
+#else
+
 #define InterfaceReference(refVar, ifaceName, instName) \
-    static InterfaceDatabase::Reference __refVar_##ifaceName##_##instName##_((IBase **)&refVar, #ifaceName "." #instName);
+    static InterfaceDatabase::Reference __refVar_##ifaceName##_##instName##_((IBase **)&refVar, InterfaceDatabase::Key(#ifaceName "." #instName));
 
 #define InterfaceInNamespaceReference(refVar, namespaceName, ifaceName, instName) \
-    static InterfaceDatabase::Reference __refVar_##namespaceName##_##ifaceName##_##instName##_((IBase **)&refVar, #namespaceName "::" #ifaceName "." #instName);
+    static InterfaceDatabase::Reference __refVar_##namespaceName##_##ifaceName##_##instName##_((IBase **)&refVar, InterfaceDatabase::Key(#namespaceName "::" #ifaceName "." #instName));
+
+#endif
+
+
+//
+//Per thread implementations.  An implementation which keeps state between calls, like the last
+//frame's time or a list of lines, can only be used by one thread.  Made with
+//InterfaceCreatePerThread instead of InterfaceCreate, it gets one object per thread instead,
+//made the first time each thread uses it, so threads never share one and need no locks.
+//References to it are declared with InterfaceLocal and InterfaceLocalReference, and find the
+//calling thread's object through a TLS slot.  A local reference to an ordinary implementation
+//just gets its one object, so code can use them before it knows which kind it will get.
+//
+//  //in TimeImpl.cpp
+//  InterfaceCreatePerThread(TimeImpl, ITime, default);
+//
+//  //where it's used
+//  static InterfaceLocal<ITime> timer;
+//  InterfaceLocalReference(timer, ITime, default);
+//  timer->UpdateTime();
+//
+//The objects are made with the default constructor on the thread which uses them, which must set
+//them up; InterfaceStartup doesn't start them.  A thread's objects are destroyed when its
+//InterfaceThread is, and those of threads without one when the program exits.  A plain
+//InterfaceReference to a per thread implementation is left NULL.  Local references always go
+//through the database, even in static interface builds.
+//
+
+//makes the objects of a per thread implementation
+template <class ImplClass, class Iface> class InterfaceFactory : public InterfaceDatabase::Factory
+{
+public:
+    IBase *Create()
+    {
+        //convert through the interface, in case the class implements more than one
+        return static_cast<Iface *>(new ImplClass());
+    }
+
+    void Destroy(IBase *impl)
+    {
+        //IBase has no virtual destructor, so delete it as the class it is
+        delete static_cast<ImplClass *>(static_cast<Iface *>(impl));
+    }
+};
+
+#define InterfaceCreatePerThread(implClass, ifaceName, instName) \
+    static InterfaceFactory<implClass, ifaceName> __implFactory_##ifaceName##_##instName##_; \
+    static InterfaceDatabase::Implementation __implVar_##ifaceName##_##instName##_(__implFactory_##ifaceName##_##instName##_, #implClass, InterfaceDatabase::Key(#ifaceName "." #instName));
+
+#define InterfaceInNamespaceCreatePerThread(implClass, namespaceName, ifaceName, instName) \
+    static InterfaceFactory<implClass, ifaceName> __implFactory_##namespaceName##_##ifaceName##_##instName##_; \
+    static InterfaceDatabase::Implementation __implVar_##namespaceName##_##ifaceName##_##instName##_(__implFactory_##namespaceName##_##ifaceName##_##instName##_, #implClass, InterfaceDatabase::Key(#namespaceName "::" #ifaceName "." #instName));
+
+//a reference which gets the calling thread's object.  It has no constructor, so it is NULL
+//before static construction, and InterfaceLocalReference connects it.
+template <class Iface> class InterfaceLocal
+{
+public:
+    //the calling thread's object, or NULL if the interface isn't implemented
+    inline Iface *Get() const;
+    inline Iface *operator->() const;
 
+    //set by the database
+    InterfaceDatabase::Instances * volatile __instances;
+};
+
+#define InterfaceLocalReference(refVar, ifaceName, instName) \
+    static InterfaceDatabase::Reference __localRefVar_##ifaceName##_##instName##_((InterfaceDatabase::Instances **)&refVar.__instances, InterfaceDatabase::Key(#ifaceName "." #instName));
+
+#define InterfaceInNamespaceLocalReference(refVar, namespaceName, ifaceName, instName) \
+    static InterfaceDatabase::Reference __localRefVar_##namespaceName##_##ifaceName##_##instName##_((InterfaceDatabase::Instances **)&refVar.__instances, InterfaceDatabase::Key(#namespaceName "::" #ifaceName "." #instName));
+
+
+//
+//Plugins are DLLs which implement interfaces that aren't linked into the program, for optional
+//systems which shouldn't cost anything in the processes that don't use them.  InterfacePlugin
+//names the DLL which implements an interface.  InterfaceLoadPlugins loads the DLL of each
+//interface which is referenced but has no implementation, moves the DLL's implementations and
+//references into our database, and keeps going for the interfaces those need.  A DLL that isn't
+//referenced is never loaded, and one that isn't installed leaves its references NULL.
+//
+//  InterfacePlugin(IMarket, default, "market.dll");
+//
+//Call InterfaceLoadPlugins on startup, once static construction is done.  It can't be called from
+//a static constructor, since DLLs shouldn't be loaded while another DLL is initializing.
+//
+
+#define InterfacePlugin(ifaceName, instName, fileName) \
+    static InterfaceDatabase::Plugin __pluginVar_##ifaceName##_##instName##_(InterfaceDatabase::Key(#ifaceName "." #instName), fileName);
+
+#define InterfaceInNamespacePlugin(namespaceName, ifaceName, instName, fileName) \
+    static InterfaceDatabase::Plugin __pluginVar_##namespaceName##_##ifaceName##_##instName##_(InterfaceDatabase::Key(#namespaceName "::" #ifaceName "." #instName), fileName);
+
+//loads the plugins of the interfaces which are referenced but not implemented.  Returns the number of DLLs loaded.
+int32 InterfaceLoadPlugins();
+
+
+//
+//Starting up the implementations.  InterfaceStartup calls Startup on every registered
+//implementation which is in use, on a pool of threads, so the startups which don't depend on each
+//other run at the same time and starting up takes as long as the longest chain of dependencies.
+//InterfaceStartupAfter declares that one interface must be started after another, which it uses
+//in its Startup or as soon as Startup is done.  A dependency on an interface with no
+//implementation is ignored.  If a Startup fails, the interfaces after it aren't started.
+//The time each Startup took is written to the debug output.
+//
+//  InterfaceStartupAfter(IFrameRate, default, IScreenText, default);
+//
+//  InterfaceStartup(context);
+//
+//Startup runs on other threads, so it mustn't need anything that belongs to the calling thread.
+//
+
+#define InterfaceStartupAfter(ifaceName, instName, afterIfaceName, afterInstName) \
+    static InterfaceDatabase::Dependency __dependVar_##ifaceName##_##instName##_##afterIfaceName##_##afterInstName##_(InterfaceDatabase::Key(#ifaceName "." #instName), InterfaceDatabase::Key(#afterIfaceName "." #afterInstName));
+
+//starts up every implementation in use, on numThreads threads including this one, or one per cpu if
+//numThreads is 0.  Returns false if any Startup failed or the dependencies have a cycle.
+bool InterfaceStartup(Context &caller, int32 numThreads = 0);
+
+
+//
+//Switching implementations while the game runs.
+//
+//InterfaceUse points every reference to an interface at another of its registered
+//implementations, so two implementations can be compared live.  The references are rewritten
+//one store at a time, so a thread calling through one sees either the old implementation or the
+//new one, never a torn pointer.  A thread which is in the middle of a call to the old
+//implementation may still be running it, so InterfaceUse waits for a grace period before it
+//returns: each thread which calls through swappable interfaces owns an InterfaceThread, and calls
+//Quiescent at a point where it holds no interface, like the top of its frame.  Once every such
+//thread has done that, the old implementation is retired and no thread is using it.
+//
+//  void RenderingThread()
+//  {
+//      InterfaceThread interfaceThread;
+//      while (running)
+//      {
+//          interfaceThread.Quiescent();
+//          ...
+//      }
+//  }
+//
+//  InterfaceUse("ITime.default", "TimeSmoothedImpl");
+//
+//The new implementation must already be started up; the references just change where they point.
+//In static interface builds the references aren't in the database, and InterfaceUse returns false.
+//The database only waits for threads which own an InterfaceThread, so threads without one must
+//not call interfaces that are swapped.
+//
+
+//switches the named interface, like "ITime.default", to the implementation with the given class
+//name, then waits until no thread is using the old one.  Returns false if the interface or the
+//implementation isn't registered.  Must not be called while this thread is inside an interface call
+//through one of the references being switched.
+bool InterfaceUse(const char *interfaceName, const char *implClassName);
+
+//waits until every thread with an InterfaceThread, other than this one, has called Quiescent.
+void InterfaceSynchronize();
+
+//registers a thread with the grace period tracking for the life of the object.
+class InterfaceThread
+{
+private:
+    InterfaceThread(InterfaceThread const &other);
+public:
+    InterfaceThread();
+    ~InterfaceThread();
+
+    //tells the database that this thread isn't inside any interface call.  Cheap, call it every frame.
+    inline void Quiescent();
+
+private:
+    friend class InterfaceDatabaseObject;
+
+    //the database's count of grace periods started, and its value when we were last quiescent
+    long volatile const *epoch;
+    long volatile quiescentEpoch;
+
+    //the id of our thread
+    uint32 threadId;
+
+    //the database's list of registered threads
+    InterfaceThread *prev;
+    InterfaceThread *next;
+};
+
+
+//
+//InterfaceThread inline functions
+//
+
+inline void InterfaceThread::Quiescent()
+{
+    //keep the compiler from moving our interface calls after this point.  x86 doesn't move loads
+    //after later stores, so the store below is enough for the cpu.
+    _ReadWriteBarrier();
+    quiescentEpoch = *epoch;
+}
+
+
+//
+//InterfaceLocal inline functions
+//
+
+template <class Iface> inline Iface *InterfaceLocal<Iface>::Get() const
+{
+    //read the pointer once, since InterfaceUse can change it at any time
+    InterfaceDatabase::Instances *instances = __instances;
+    if (instances == NULL)
+    {
+        return NULL;
+    }
+    return static_cast<Iface *>(instances->Get());
+}
+
+template <class Iface> inline Iface *InterfaceLocal<Iface>::operator->() const
+{
+    return Get();
+}
@@ -29,6 +29,7 @@
 //
 
 #include "common\global\ManagerObject.h"
+#include "common\global\SpinLock.h"
 
 class IBase;
 
@@ -38,6 +39,80 @@ public:
     //the items we add to the interface database.
     class Implementation;
     class Reference;
+    class Plugin;
+    class Dependency;
+    class Instances;
+
+    //the name of an interface and instance, with its hash.  The registration macros make these
+    //from string literals, so the hash is computed by the compiler and the database can find the
+    //interface without reading the name unless two names share a hash.
+    class Key
+    {
+    public:
+        template <int32 Size> inline Key(char const (&name)[Size]);
+
+        //a key for a name made at runtime.  hash must be HashFunc64(name).
+        inline Key(char const *name, uint64 hash);
+
+        //true if this is the key of the given name
+        inline bool operator==(Key const &other) const;
+
+        //the name, and its HashFunc64
+        char const *name;
+        uint64 hash;
+    };
+
+    //makes and destroys the objects of an implementation which has one object per thread
+    class Factory
+    {
+    public:
+        virtual IBase *Create() = 0;
+        virtual void Destroy(IBase *impl) = 0;
+    };
+
+    //the objects of an implementation.  Either one object shared by every thread, or one object
+    //per thread, made by a Factory the first time each thread asks for it and found again through
+    //a TLS slot.
+    class Instances
+    {
+    private:
+        Instances(Instances const &other);
+    public:
+        Instances(IBase *shared);
+        Instances(Factory *factory);
+        ~Instances();
+
+        //returns the calling thread's object, or NULL if it couldn't be made
+        inline IBase *Get();
+
+        //returns the shared object, or NULL if each thread has its own
+        IBase *GetShared();
+
+        //true if each thread has its own object
+        bool IsPerThread() const;
+
+        //takes the calling thread's object away from it, or returns NULL if it has none.  The
+        //caller destroys it with the factory.
+        IBase *TakeThread();
+
+        //makes and destroys our per thread objects, or NULL if we have a shared one
+        Factory *GetFactory();
+
+    private:
+        //gets the calling thread's object from its TLS slot, making it on the thread's first call
+        IBase *GetThread();
+
+        //the object every thread uses, or NULL if each has its own
+        IBase *shared;
+
+        //makes the per thread objects, and the TLS slot which holds each thread's
+        Factory *factory;
+        uint32 slot;
+
+        //every per thread object we've made, so they can be destroyed, and the lock protecting it
+        ArrayPointer<IBase> made;
+        SpinLock lock;
+    };
 
     //our managed global items
     class Item
@@ -46,13 +121,18 @@ public:
         //cast ourself to one of the derived types
         virtual Implementation *ToImplementation();
         virtual Reference *ToReference();
+        virtual Plugin *ToPlugin();
+        virtual Dependency *ToDependency();
     };
 
     //interface database Implementation object.
     class Implementation : public Item
     {
     public:
-        Implementation(IBase &impl, const char *implClassName, const char *interfaceName);
+        Implementation(IBase &impl, const char *implClassName, Key const &interfaceKey);
+
+        //an implementation with an object per thread, made by the factory
+        Implementation(Factory &factory, const char *implClassName, Key const &interfaceKey);
         ~Implementation();
 
         //from Item
@@ -60,29 +140,36 @@ public:
     
         //returns name of the implemented interface
         const char *GetInterfaceName();
+        Key const &GetInterfaceKey() const;
 
         //returns the name of the implementation class
         const char *GetImplemenationName();
 
-        //returns the address of the implementation instantiation
+        //returns the address of the implementation instantiation, or NULL if each thread has its own
         IBase *GetInstance();
 
+        //returns the objects of the implementation, shared or per thread
+        Instances *GetInstances();
+
     private:
         //the actual implementation of an interface
-        IBase *impl;
+        Instances instances;
 
         //the name of the implemenation class
         const char *implementationName;
 
         //the name of the interface that is implemented.
-        const char *implementedInterfaceName;
+        Key implementedInterfaceKey;
     };
 
     //interface database Reference object
     class Reference : public Item
     {
     public:
-        Reference(IBase **ifaceRef, const char *interfaceName);
+        Reference(IBase **ifaceRef, Key const &interfaceKey);
+
+        //a reference which finds the calling thread's object, for implementations with one per thread
+        Reference(Instances **instancesRef, Key const &interfaceKey);
         ~Reference();
 
         //from Item
@@ -90,16 +177,77 @@ public:
 
         //returns the name of the interface we want
         const char *GetInterfaceName();
+        Key const &GetInterfaceKey() const;
 
-        //switches the implementation we point at.
-        void UseImplementation(IBase *impl);
+        //switches the implementation we point at, or disconnects us if it's NULL.
+        void UseImplementation(Implementation *impl);
 
     private:
-        //reference to the interface pointer
+        //reference to the interface pointer, or to the instances pointer of a per thread reference
         IBase **ifaceRef;
+        Instances **instancesRef;
 
         //the name of the interface
-        const char *interfaceName;
+        Key interfaceKey;
+    };
+
+    //interface database Plugin object, naming the DLL which implements an interface.
+    class Plugin : public Item
+    {
+    public:
+        Plugin(Key const &interfaceKey, const char *fileName);
+        ~Plugin();
+
+        //from Item
+        Plugin *ToPlugin();
+
+        //returns the name of the interface the DLL implements
+        Key const &GetInterfaceKey() const;
+
+        //returns the file name of the DLL
+        const char *GetFileName();
+
+        //true once we have tried to load the DLL, whether it worked or not
+        bool Tried();
+
+        //loads the DLL and moves its items into our database.  Only tries once.
+        //Returns true if the DLL is loaded.
+        bool Load();
+
+    private:
+        //the name of the interface the DLL implements
+        Key interfaceKey;
+
+        //the file name of the DLL
+        const char *fileName;
+
+        //the loaded DLL, or NULL
+        void *dllHandle;
+
+        //true once we have tried to load it
+        bool tried;
+    };
+
+    //interface database Dependency object, saying one interface's Startup must run after another's.
+    class Dependency : public Item
+    {
+    public:
+        Dependency(Key const &interfaceKey, Key const &afterKey);
+        ~Dependency();
+
+        //from Item
+        Dependency *ToDependency();
+
+        //returns the name of the interface which depends on the other
+        Key const &GetInterfaceKey() const;
+
+        //returns the name of the interface which must start up first
+        Key const &GetAfterKey() const;
+
+    private:
+        //the names of the two interfaces
+        Key interfaceKey;
+        Key afterKey;
     };
 
     //called from templated base class functions.
@@ -108,3 +256,42 @@ public:
     virtual void Transfer(InterfaceDatabase *manager) = 0;
 };
 
+
+//
+//InterfaceDatabase::Key inline functions
+//
+
+template <int32 Size> inline InterfaceDatabase::Key::Key(char const (&name)[Size])
+{
+    //hashed at compile time in optimized builds
+    this->name = name;
+    hash = HashLiteral(name);
+}
+
+inline InterfaceDatabase::Key::Key(char const *name, uint64 hash)
+{
+    this->name = name;
+    this->hash = hash;
+}
+
+inline bool InterfaceDatabase::Key::operator==(Key const &other) const
+{
+    //the hash almost always decides it.  The linker merges identical literals, so the name
+    //pointers are usually the same too, and the strings are only compared when they aren't.
+    return hash == other.hash && (name == other.name || strcmp(name, other.name) == 0);
+}
+
+
+//
+//InterfaceDatabase::Instances inline functions
+//
+
+inline IBase *InterfaceDatabase::Instances::Get()
+{
+    //shared objects don't need the TLS lookup
+    if (shared != NULL)
+    {
+        return shared;
+    }
+    return GetThread();
+}
@@ -16,9 +16,15 @@
 //  along with this program.  If not, see [http://www.gnu.org/licenses/].
 //
 
+#include <windows.h>
+#include <process.h>
 #include "common\idb\src\InterfaceDatabaseImpl.h"
 
 
+//every module exports the function which moves its items into the database of the module that loads it
+ManagerExportTransfer(InterfaceDatabaseStatic, InterfaceDatabaseObject, InterfaceDatabaseTransfer)
+
+
 //
 //InterfaceDatabaseStatic functions
 //
@@ -38,11 +44,23 @@ ManagerObject *InterfaceDatabaseStatic::Create()
 //InterfaceDatabaseObject functions
 //
 
+InterfaceDatabaseObject::InterfaceDatabaseObject()
+{
+    //no grace periods yet, and no threads to wait for
+    epoch = 0;
+    firstThread = NULL;
+}
+
 void InterfaceDatabaseObject::Add(Item *object)
 {
-    //cast to both types
+    //only one thread changes the database at a time
+    SpinLockScope scope(lock);
+
+    //cast to all the types
     Implementation *implementation = object->ToImplementation();
     Reference *reference = object->ToReference();
+    Plugin *plugin = object->ToPlugin();
+    Dependency *dependency = object->ToDependency();
 
     //check if its is an implementation
     if (implementation != NULL)
@@ -56,6 +74,18 @@ void InterfaceDatabaseObject::Add(Item *object)
         //add it as a reference
         Add(reference);
     }
+    //check if it is a plugin
+    else if (plugin != NULL)
+    {
+        //add it as a plugin
+        Add(plugin);
+    }
+    //check if it is a dependency
+    else if (dependency != NULL)
+    {
+        //add it as a dependency
+        Add(dependency);
+    }
     else
     {
         //messed up object
@@ -65,61 +95,84 @@ void InterfaceDatabaseObject::Add(Item *object)
 
 void InterfaceDatabaseObject::Remove(Item *object)
 {
-    //check if its is an implementation
-    if (object->ToImplementation() != NULL)
-    {
-        //remove it as an implementation
-        Remove(object->ToImplementation());
-    }
-    //check if it is a reference
-    else if (object->ToReference() != NULL)
+    //true if the references were moved off the removed implementation
+    bool wasActive = false;
+
     {
-        //remove it as a reference
-        Remove(object->ToReference());
+        //only one thread changes the database at a time
+        SpinLockScope scope(lock);
+
+        //check if its is an implementation
+        if (object->ToImplementation() != NULL)
+        {
+            //remove it as an implementation
+            wasActive = Remove(object->ToImplementation());
+        }
+        //check if it is a reference
+        else if (object->ToReference() != NULL)
+        {
+            //remove it as a reference
+            Remove(object->ToReference());
+        }
+        //check if it is a plugin
+        else if (object->ToPlugin() != NULL)
+        {
+            //remove it as a plugin
+            Remove(object->ToPlugin());
+        }
+        //check if it is a dependency
+        else if (object->ToDependency() != NULL)
+        {
+            //remove it as a dependency
+            Remove(object->ToDependency());
+        }
+        else
+        {
+            //messed up object
+            BREAK1();
+        }
     }
-    else
+
+    //the implementation is going away, usually with its DLL, so wait until no thread is running it
+    if (wasActive == true)
     {
-        //messed up object
-        BREAK1();
+        Synchronize();
     }
 }
 
 void InterfaceDatabaseObject::Add(InterfaceDatabase::Implementation *impl)
 {
     //get the name of the implemented interface
-    const char *ifaceName = impl->GetInterfaceName();
-    IFBREAKRETURN(ifaceName == NULL);
+    Key const &ifaceKey = impl->GetInterfaceKey();
 
     //find the UniqueInterface instance for this interface
-    UniqueInterface *iface = GetIface(ifaceName);
+    UniqueInterface *iface = GetIface(ifaceKey);
     IFBREAKRETURN(iface == NULL);
 
     //add the implementation to the iface
     iface->Add(impl);
 }
 
-void InterfaceDatabaseObject::Remove(InterfaceDatabase::Implementation *impl)
+bool InterfaceDatabaseObject::Remove(InterfaceDatabase::Implementation *impl)
 {
     //get the name of the implemented interface
-    const char *ifaceName = impl->GetInterfaceName();
-    IFBREAKRETURN(ifaceName == NULL);
+    Key const &ifaceKey = impl->GetInterfaceKey();
 
     //find the UniqueInterface instance for this interface
-    UniqueInterface *iface = GetIface(ifaceName);
-    IFBREAKRETURN(iface == NULL);
+    UniqueInterface *iface = GetIface(ifaceKey);
+    IFBREAKRETURNVAL(iface == NULL, false);
 
     //remove the implementation
-    iface->Remove(impl);
+    return iface->Remove(impl);
 }
 
 void InterfaceDatabaseObject::Add(InterfaceDatabase::Reference *ref)
 {
     //get the name of the requested interface
-    const char *ifaceName = ref->GetInterfaceName();
-    IFBREAKRETURN(ifaceName == NULL);
+    Key const &ifaceKey = ref->GetInterfaceKey();
 
     //find the UniqueInterface instance for this interface
-    UniqueInterface *iface = GetIface(ifaceName);
+    UniqueInterface *iface = GetIface(ifaceKey);
     IFBREAKRETURN(iface == NULL);
 
     //add the implementation to the iface
@@ -129,31 +182,109 @@ void InterfaceDatabaseObject::Add(InterfaceDatabase::Reference *ref)
 void InterfaceDatabaseObject::Remove(InterfaceDatabase::Reference *ref)
 {
     //get the name of the referenced interface
-    const char *ifaceName = ref->GetInterfaceName();
-    IFBREAKRETURN(ifaceName == NULL);
+    Key const &ifaceKey = ref->GetInterfaceKey();
 
     //find the UniqueInterface instance for this interface
-    UniqueInterface *iface = GetIface(ifaceName);
+    UniqueInterface *iface = GetIface(ifaceKey);
     IFBREAKRETURN(iface == NULL);
 
     //remove the reference
     iface->Remove(ref);
 }
 
-InterfaceDatabaseObject::UniqueInterface *InterfaceDatabaseObject::GetIface(char const *name)
+void InterfaceDatabaseObject::Add(InterfaceDatabase::Plugin *plugin)
+{
+    //get the name of the interface the plugin implements
+    Key const &ifaceKey = plugin->GetInterfaceKey();
+
+    //find the UniqueInterface instance for this interface
+    UniqueInterface *iface = GetIface(ifaceKey);
+    IFBREAKRETURN(iface == NULL);
+
+    //add the plugin
+    iface->Add(plugin);
+}
+
+void InterfaceDatabaseObject::Remove(InterfaceDatabase::Plugin *plugin)
+{
+    //get the name of the interface the plugin implements
+    Key const &ifaceKey = plugin->GetInterfaceKey();
+
+    //find the UniqueInterface instance for this interface
+    UniqueInterface *iface = GetIface(ifaceKey);
+    IFBREAKRETURN(iface == NULL);
+
+    //remove the plugin
+    iface->Remove(plugin);
+}
+
+void InterfaceDatabaseObject::Add(InterfaceDatabase::Dependency *dependency)
+{
+    //get the name of the interface which depends on the other
+    Key const &ifaceKey = dependency->GetInterfaceKey();
+
+    //find the UniqueInterface instance for this interface
+    UniqueInterface *iface = GetIface(ifaceKey);
+    IFBREAKRETURN(iface == NULL);
+
+    //add the dependency
+    iface->Add(dependency);
+}
+
+void InterfaceDatabaseObject::Remove(InterfaceDatabase::Dependency *dependency)
+{
+    //get the name of the interface which depends on the other
+    Key const &ifaceKey = dependency->GetInterfaceKey();
+
+    //find the UniqueInterface instance for this interface
+    UniqueInterface *iface = GetIface(ifaceKey);
+    IFBREAKRETURN(iface == NULL);
+
+    //remove the dependency
+    iface->Remove(dependency);
+}
+
+InterfaceDatabaseObject::UniqueInterface *InterfaceDatabaseObject::FindIface(Key const &key)
+{
+    //find the interfaces with this hash.  Only a collision makes this look at more than one.
+    for (UniqueInterface *iface = database.Find(key.hash); iface != NULL; iface = iface->GetCollision())
+    {
+        if (iface->GetKey() == key)
+        {
+            return iface;
+        }
+    }
+
+    //we don't have it
+    return NULL;
+}
+
+InterfaceDatabaseObject::UniqueInterface *InterfaceDatabaseObject::GetIface(Key const &key)
 {
     //check if we already have one
-    UniqueInterface *iface = database.Find(name, FindIFace);
+    UniqueInterface *iface = FindIface(key);
     if (iface != NULL)
     {
         return iface;
     }
 
     //we need to create a new database element
-    iface = new UniqueInterface(name);
+    iface = new UniqueInterface(key);
+
+    //find any interface whose name has the same hash
+    UniqueInterface *first = database.Find(key.hash);
 
-    //insert the iface into the database
-    database.Add(iface, CompareIFace);
+    //check if another name already has this hash
+    if (first != NULL)
+    {
+        //chain it behind the one in the database
+        iface->SetCollision(first->GetCollision());
+        first->SetCollision(iface);
+        return iface;
+    }
+
+    //insert the iface into the database, keyed by its hash
+    database.Add(key.hash, iface);
 
     //return it.
     return iface;
@@ -166,37 +297,570 @@ void InterfaceDatabaseObject::Transfer(InterfaceDatabase *manager)
     //cast manager to database
     InterfaceDatabaseObject *other = (InterfaceDatabaseObject *)manager;
 
+    //lock both databases while we move everything
+    SpinLockScope scope(lock);
+    SpinLockScope otherScope(other->lock);
+
+    //go through all of our interfaces
+    for (int32 slot = 0, numSlots = database.Slots(); slot < numSlots; slot++)
+    {
+        //get the interface in this slot
+        UniqueInterface *iface = database.GetSlot(slot);
+        if (iface == NULL)
+        {
+            continue;
+        }
+
+        //transfer all the objects to the other database, including those of any colliding names.
+        for (; iface != NULL; iface = iface->GetCollision())
+        {
+            iface->TransferTo(other);
+        }
+    }
+
+    //delete all the ifaces
+    database.Empty();
+}
+
+bool InterfaceDatabaseObject::Use(Key const &key, const char *implClassName)
+{
+    {
+        //only one thread changes the database at a time
+        SpinLockScope scope(lock);
+
+        //find the interface
+        UniqueInterface *iface = FindIface(key);
+        if (iface == NULL)
+        {
+            return false;
+        }
+
+        //switch it
+        if (iface->Use(implClassName) == false)
+        {
+            return false;
+        }
+    }
+
+    //wait until nobody is still in the old implementation
+    Synchronize();
+    return true;
+}
+
+void InterfaceDatabaseObject::AddThread(InterfaceThread *thread)
+{
+    IFBREAKRETURN(thread == NULL);
+
+    //the thread has nothing from before now
+    thread->epoch = &epoch;
+    thread->quiescentEpoch = epoch;
+
+    //add it to the front of the list
+    SpinLockScope scope(threadLock);
+    thread->prev = NULL;
+    thread->next = firstThread;
+    if (firstThread != NULL)
+    {
+        firstThread->prev = thread;
+    }
+    firstThread = thread;
+}
+
+void InterfaceDatabaseObject::RemoveThread(InterfaceThread *thread)
+{
+    IFBREAKRETURN(thread == NULL);
+
+    //unlink it
+    SpinLockScope scope(threadLock);
+    if (thread->prev != NULL)
+    {
+        thread->prev->next = thread->next;
+    }
+    else
+    {
+        firstThread = thread->next;
+    }
+    if (thread->next != NULL)
+    {
+        thread->next->prev = thread->prev;
+    }
+    thread->prev = NULL;
+    thread->next = NULL;
+}
+
+void InterfaceDatabaseObject::ReleaseThread()
+{
+    //take this thread's objects while the database can't change, so no implementation goes away under us
+    ArrayValue<ThreadObject> taken;
+    {
+        //only one thread changes the database at a time
+        SpinLockScope scope(lock);
+
+        //go through all of our interfaces, including those of any colliding names
+        for (int32 slot = 0, numSlots = database.Slots(); slot < numSlots; slot++)
+        {
+            for (UniqueInterface *iface = database.GetSlot(slot); iface != NULL; iface = iface->GetCollision())
+            {
+                iface->TakeThread(taken);
+            }
+        }
+    }
+
+    //destroy them after letting go of the lock.  A Destroy can take as long as it likes or call
+    //back into the database, and other threads don't spin on the lock meanwhile.
+    for (int32 i = 0, num = taken.Num(); i < num; i++)
+    {
+        ThreadObject *object = taken.Get(i);
+        object->factory->Destroy(object->instance);
+    }
+}
+
+void InterfaceDatabaseObject::Synchronize()
+{
+    //start a new grace period.  The interlocked add is a full barrier, so a thread which sees the
+    //new count in Quiescent also sees every reference we changed before it.
+    long target = _InterlockedIncrement(&epoch);
+
+    //we aren't inside an interface call ourselves
+    uint32 self = GetCurrentThreadId();
+
+    //wait until every other thread has been quiescent since we started
+    for (;;)
+    {
+        //look for a thread which hasn't
+        bool waiting = false;
+        {
+            SpinLockScope scope(threadLock);
+            for (InterfaceThread *thread = firstThread; thread != NULL; thread = thread->next)
+            {
+                //compare the difference, so the count can wrap
+                if (thread->threadId != self && int32(uint32(thread->quiescentEpoch) - uint32(target)) < 0)
+                {
+                    waiting = true;
+                    break;
+                }
+            }
+        }
+
+        //check if the grace period is over
+        if (waiting == false)
+        {
+            return;
+        }
+
+        //threads are quiescent about once a frame, so don't spin while they get there
+        Sleep(1);
+    }
+}
+
+
+InterfaceDatabase::Plugin *InterfaceDatabaseObject::FindPendingPlugin()
+{
     //go through all of our interfaces
-    while (database.Num() > 0)
+    for (int32 slot = 0, numSlots = database.Slots(); slot < numSlots; slot++)
+    {
+        //check the interfaces in this slot, including those of any colliding names
+        for (UniqueInterface *iface = database.GetSlot(slot); iface != NULL; iface = iface->GetCollision())
+        {
+            //check if it's waiting for a DLL
+            Plugin *plugin = iface->GetPendingPlugin();
+            if (plugin != NULL)
+            {
+                return plugin;
+            }
+        }
+    }
+
+    //nothing to load
+    return NULL;
+}
+
+int32 InterfaceDatabaseObject::LoadPlugins()
+{
+    //loading a DLL can add references which need other DLLs, so keep going until nothing is waiting
+    int32 numLoaded = 0;
+    for (;;)
+    {
+        //find a plugin to load
+        Plugin *plugin = NULL;
+        {
+            SpinLockScope scope(lock);
+            plugin = FindPendingPlugin();
+        }
+        if (plugin == NULL)
+        {
+            return numLoaded;
+        }
+
+        //load it without the lock.  Its static objects are made in its own database, and then
+        //transfered into ours.
+        if (plugin->Load() == true)
+        {
+            numLoaded++;
+        }
+    }
+}
+
+
+bool InterfaceDatabaseObject::Startup(Context &caller, int32 numThreads)
+{
+    CONTEXT_CALLED();
+
+    //one thread per cpu, unless we are told otherwise
+    if (numThreads <= 0)
+    {
+        SYSTEM_INFO system;
+        GetSystemInfo(&system);
+        numThreads = int32(system.dwNumberOfProcessors);
+    }
+
+    //the work, shared by all the threads
+    StartupRun run(context, numThreads);
+
+    //make a node for each implementation in use
+    ArrayHashed<UniqueInterface *, StartupNode> nodeOfIface;
+    {
+        SpinLockScope scope(lock);
+
+        //go through all of our interfaces, including those of any colliding names
+        for (int32 slot = 0, numSlots = database.Slots(); slot < numSlots; slot++)
+        {
+            for (UniqueInterface *iface = database.GetSlot(slot); iface != NULL; iface = iface->GetCollision())
+            {
+                //only the ones which are implemented start up.  Per thread objects are made when they
+                //are first used, so they aren't started.
+                if (iface->GetActiveInstance() == NULL)
+                {
+                    continue;
+                }
+
+                //make its node
+                StartupNode *node = new StartupNode(iface);
+                run.nodes.Add(node);
+                nodeOfIface.Add(iface, node);
+            }
+        }
+
+        //connect each node to the nodes it runs after
+        for (int32 n = 0, numNodes = run.nodes.Num(); n < numNodes; n++)
+        {
+            //go through the dependencies of this node's interface
+            StartupNode *node = run.nodes.Get(n);
+            UniqueInterface *iface = node->iface;
+            for (int32 i = 0, num = iface->NumDependencies(); i < num; i++)
+            {
+                //find the node of the interface it runs after.  Interfaces that aren't implemented don't hold anyone up.
+                UniqueInterface *after = FindIface(iface->GetDependency(i)->GetAfterKey());
+                StartupNode *afterNode = (after != NULL) ? nodeOfIface.Find(after) : NULL;
+                if (afterNode == NULL || afterNode->dependents.Contains(node) == true)
+                {
+                    continue;
+                }
+
+                //we wait for it
+                afterNode->dependents.Add(node);
+                node->waitingOn++;
+            }
+        }
+    }
+
+    //check for a cycle by finishing the nodes in order without running them
+    {
+        //the nodes which are waiting on nothing go first
+        ArrayPointerQueue<StartupNode> order;
+        for (int32 i = 0, num = run.nodes.Num(); i < num; i++)
+        {
+            StartupNode *node = run.nodes.Get(i);
+            node->unordered = node->waitingOn;
+            if (node->waitingOn == 0)
+            {
+                order.Add(node);
+            }
+        }
+
+        //finish them one at a time, counting down the ones after them
+        int32 numOrdered = 0;
+        while (order.Num() > 0)
+        {
+            StartupNode *node = order.PopFront();
+            numOrdered++;
+            for (int32 i = 0, num = node->dependents.Num(); i < num; i++)
+            {
+                StartupNode *dependent = node->dependents.Get(i);
+                if (--dependent->unordered == 0)
+                {
+                    order.Add(dependent);
+                }
+            }
+        }
+
+        //anything left over is waiting on itself
+        IFBREAKCONTEXTMSG(numOrdered != run.nodes.Num(), "interface startup dependencies have a cycle");
+    }
+
+    //the nodes which are waiting on nothing are ready to go
+    for (int32 i = 0, num = run.nodes.Num(); i < num; i++)
+    {
+        StartupNode *node = run.nodes.Get(i);
+        if (node->waitingOn == 0)
+        {
+            run.ready.Add(node);
+        }
+    }
+    run.remaining = run.nodes.Num();
+
+    //nothing to do
+    if (run.remaining == 0)
+    {
+        return true;
+    }
+
+    //there's no use for more threads than nodes
+    bound_max(run.numThreads, run.nodes.Num());
+    bound_max(run.numThreads, INTERFACE_STARTUP_MAX_THREADS);
+
+    //the time we start
+    LARGE_INTEGER begin;
+    QueryPerformanceCounter(&begin);
+
+    //wake a thread for each ready node
+    ReleaseSemaphore(run.semaphore, run.ready.Num(), NULL);
+
+    //start the other threads.  If some don't start, the rest do their work, and the extra wake
+    //ups at the end are never taken.
+    HANDLE threads[INTERFACE_STARTUP_MAX_THREADS];
+    int32 numStarted = 0;
+    for (int32 i = 1; i < run.numThreads; i++)
+    {
+        //start one
+        HANDLE thread = (HANDLE)_beginthreadex(NULL, 0, StartupRun::Thread, &run, 0, NULL);
+        IFBREAKBREAK(thread == NULL);
+        threads[numStarted++] = thread;
+    }
+
+    //and work ourselves
+    run.Work(context);
+
+    //wait for the others to finish
+    for (int32 i = 0; i < numStarted; i++)
     {
-        //remove an interface
-        UniqueInterface *iface = database.Remove(database.Num() - 1);
-        IFBREAKCONTINUE(iface == NULL);
+        WaitForSingleObject(threads[i], INFINITE);
+        CloseHandle(threads[i]);
+    }
+
+    //the time we finish
+    LARGE_INTEGER end;
+    QueryPerformanceCounter(&end);
+
+    //write the times, and total them
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    double msPerTick = 1000.0 / double(frequency.QuadPart);
+    double totalMs = 0.0;
+    bool succeeded = true;
+    OutputDebugStringA("interface startup:\n");
+    for (int32 i = 0, num = run.nodes.Num(); i < num; i++)
+    {
+        //one line for each
+        StartupNode *node = run.nodes.Get(i);
+        double ms = double(node->ticks) * msPerTick;
+        buffer512 line;
+        line.Set("  %8.2f ms  %s (%s)%s\n", ms, node->interfaceName, node->implementationName,
+            node->dependencyFailed ? " skipped" : (node->succeeded ? "" : " failed"));
+        OutputDebugStringA(line);
+
+        //add it up
+        totalMs += ms;
+        if (node->succeeded == false)
+        {
+            succeeded = false;
+        }
+    }
+    buffer256 total;
+    total.Set("  %8.2f ms  in all, done in %.2f ms on %d threads\n", totalMs, double(end.QuadPart - begin.QuadPart) * msPerTick, numStarted + 1);
+    OutputDebugStringA(total);
+
+    return succeeded;
+}
+
+
+//
+//InterfaceDatabaseObject::StartupNode functions
+//
+
+InterfaceDatabaseObject::StartupNode::StartupNode(UniqueInterface *iface)
+{
+    //save who we start up
+    this->iface = iface;
+    interfaceName = iface->GetInterfaceName();
+    implementationName = iface->GetActiveImplementation()->GetImplemenationName();
+    instance = iface->GetActiveInstance();
+
+    //nothing yet
+    waitingOn = 0;
+    unordered = 0;
+    dependencyFailed = false;
+    succeeded = false;
+    ticks = 0;
+}
+
+
+//
+//InterfaceDatabaseObject::StartupRun functions
+//
+
+InterfaceDatabaseObject::StartupRun::StartupRun(Context &creator, int32 numThreads)
+    : creator(creator)
+{
+    //save the parameters
+    this->numThreads = numThreads;
+
+    //nothing to do yet
+    remaining = 0;
+    semaphore = CreateSemaphoreA(NULL, 0, 0x7FFFFFFF, NULL);
+}
+
+InterfaceDatabaseObject::StartupRun::~StartupRun()
+{
+    //done with the semaphore
+    CloseHandle(semaphore);
+}
 
-        //transfer all the objects to the other database.
-        iface->TransferTo(other);
+unsigned __stdcall InterfaceDatabaseObject::StartupRun::Thread(void *param)
+{
+    //our contexts go under the context of the thread which called Startup
+    StartupRun *run = (StartupRun *)param;
+    ThreadRootContext root(run->creator);
+    HERE();
+    Context context(&root, here__);
+
+    //do nodes until they are done
+    run->Work(context);
+    return 0;
+}
+
+void InterfaceDatabaseObject::StartupRun::Work(Context &caller)
+{
+    for (;;)
+    {
+        //wait until there's a node ready, or we're done
+        WaitForSingleObject(semaphore, INFINITE);
+
+        //take the node
+        StartupNode *node = NULL;
+        {
+            SpinLockScope scope(lock);
+            if (ready.Num() > 0)
+            {
+                node = ready.PopFront();
+            }
+        }
 
-        //delete the iface
-        delete iface;
+        //being woken with nothing ready means everything is done
+        if (node == NULL)
+        {
+            return;
+        }
+
+        //run it
+        Run(node, caller);
+    }
+}
+
+void InterfaceDatabaseObject::StartupRun::Run(StartupNode *node, Context &caller)
+{
+    //start it up, unless something it needs failed
+    if (node->dependencyFailed == false)
+    {
+        LARGE_INTEGER start;
+        LARGE_INTEGER end;
+        QueryPerformanceCounter(&start);
+        node->succeeded = node->instance->Startup(caller);
+        QueryPerformanceCounter(&end);
+        node->ticks = end.QuadPart - start.QuadPart;
+    }
+
+    //let the nodes after it go
+    int32 numReady = 0;
+    bool done = false;
+    {
+        SpinLockScope scope(lock);
+        for (int32 i = 0, num = node->dependents.Num(); i < num; i++)
+        {
+            //the ones after a failure are skipped
+            StartupNode *dependent = node->dependents.Get(i);
+            if (node->succeeded == false)
+            {
+                dependent->dependencyFailed = true;
+            }
+
+            //check if this was the last one it waited for
+            if (--dependent->waitingOn == 0)
+            {
+                ready.Add(dependent);
+                numReady++;
+            }
+        }
+
+        //check if that was the last node
+        done = (--remaining == 0);
+    }
+
+    //wake a thread for each node that's ready
+    if (numReady > 0)
+    {
+        ReleaseSemaphore(semaphore, numReady, NULL);
     }
+
+    //wake everyone to finish
+    if (done == true)
+    {
+        ReleaseSemaphore(semaphore, numThreads, NULL);
+    }
+}
+
+
+//
+//InterfaceDatabaseObject::UniqueInterface functions
+//
+
+InterfaceDatabaseObject::UniqueInterface::UniqueInterface(Key const &key)
+    : interfaceKey(key)
+{
+    //keep one copy of our name for the whole program.  This is once per interface, not once per
+    //reference or implementation, so registering stays cheap.
+    interfaceName = Atom::Intern(key.name);
+    interfaceKey.name = interfaceName.Str();
+
+    //no other name shares our hash yet
+    collision = NULL;
+
+    //we have no current implementation.
+    curImpl = NULL;
+
+    //or a DLL to get one from
+    plugin = NULL;
 }
 
-//
-//InterfaceDatabaseObject::UniqueInterface functions
-//
+InterfaceDatabaseObject::UniqueInterface::~UniqueInterface()
+{
+    //the database only owns the first interface of a chain
+    delete collision;
+}
 
-InterfaceDatabaseObject::UniqueInterface::UniqueInterface(char const *name)
+InterfaceDatabase::Key const &InterfaceDatabaseObject::UniqueInterface::GetKey() const
 {
-    //save the name
-    interfaceName = name;
+    return interfaceKey;
+}
 
-    //we have no current implementation.
-    curImpl = NULL;
+InterfaceDatabaseObject::UniqueInterface *InterfaceDatabaseObject::UniqueInterface::GetCollision() const
+{
+    return collision;
 }
 
-const char *InterfaceDatabaseObject::UniqueInterface::GetName() const
+void InterfaceDatabaseObject::UniqueInterface::SetCollision(UniqueInterface *iface)
 {
-    return interfaceName;
+    collision = iface;
 }
 
 void InterfaceDatabaseObject::UniqueInterface::Add(InterfaceDatabase::Implementation *impl)
@@ -214,12 +878,13 @@ void InterfaceDatabaseObject::UniqueInterface::Add(InterfaceDatabase::Implementa
     }
 }
 
-void InterfaceDatabaseObject::UniqueInterface::Remove(InterfaceDatabase::Implementation *impl)
+bool InterfaceDatabaseObject::UniqueInterface::Remove(InterfaceDatabase::Implementation *impl)
 {
-    IFBREAKRETURN(impl == NULL);
+    IFBREAKRETURNVAL(impl == NULL, false);
 
     //check if this is the one currently selected
-    if (impl == curImpl)
+    bool wasActive = (impl == curImpl);
+    if (wasActive == true)
     {
         //disconnect all references
         DisconnectReferences();
@@ -244,6 +909,8 @@ void InterfaceDatabaseObject::UniqueInterface::Remove(InterfaceDatabase::Impleme
             UseImplementation(new_impl);
         }
     }
+
+    return wasActive;
 }
 
 void InterfaceDatabaseObject::UniqueInterface::Add(InterfaceDatabase::Reference *ref)
@@ -256,8 +923,8 @@ void InterfaceDatabaseObject::UniqueInterface::Add(InterfaceDatabase::Reference
     //check if we have an active implementation.
     if (curImpl != NULL)
     {
-        //this is the first impl we have so far.
-        ref->UseImplementation(curImpl->GetInstance());
+        //point it at the implementation
+        ref->UseImplementation(curImpl);
     }
 }
 
@@ -272,6 +939,82 @@ void InterfaceDatabaseObject::UniqueInterface::Remove(InterfaceDatabase::Referen
     ref->UseImplementation(NULL);
 }
 
+void InterfaceDatabaseObject::UniqueInterface::Add(InterfaceDatabase::Plugin *plugin)
+{
+    IFBREAKRETURN(plugin == NULL);
+
+    //an interface is implemented by one DLL
+    IFBREAKRETURN(this->plugin != NULL && this->plugin != plugin);
+
+    //remember it
+    this->plugin = plugin;
+}
+
+void InterfaceDatabaseObject::UniqueInterface::Remove(InterfaceDatabase::Plugin *plugin)
+{
+    IFBREAKRETURN(plugin == NULL);
+
+    //forget it
+    if (this->plugin == plugin)
+    {
+        this->plugin = NULL;
+    }
+}
+
+void InterfaceDatabaseObject::UniqueInterface::Add(InterfaceDatabase::Dependency *dependency)
+{
+    IFBREAKRETURN(dependency == NULL);
+
+    //insert it into our list
+    dependencies.Add(dependency);
+}
+
+void InterfaceDatabaseObject::UniqueInterface::Remove(InterfaceDatabase::Dependency *dependency)
+{
+    IFBREAKRETURN(dependency == NULL);
+
+    //remove it
+    dependencies.Remove(dependency);
+}
+
+int32 InterfaceDatabaseObject::UniqueInterface::NumDependencies()
+{
+    return dependencies.Num();
+}
+
+InterfaceDatabase::Dependency *InterfaceDatabaseObject::UniqueInterface::GetDependency(int32 index)
+{
+    return dependencies.Get(index);
+}
+
+InterfaceDatabase::Plugin *InterfaceDatabaseObject::UniqueInterface::GetPendingPlugin()
+{
+    //we only need the DLL if someone wants us and we aren't linked in
+    if (plugin == NULL || plugin->Tried() == true || references.Num() == 0 || implementations.Num() > 0)
+    {
+        return NULL;
+    }
+
+    //load it
+    return plugin;
+}
+
+void InterfaceDatabaseObject::UniqueInterface::TakeThread(ArrayValue<ThreadObject> &taken)
+{
+    //any of our implementations may have made an object for this thread
+    for (int32 i = 0, num = implementations.Num(); i < num; i++)
+    {
+        Instances *instances = implementations.Get(i)->GetInstances();
+        IBase *instance = instances->TakeThread();
+        if (instance != NULL)
+        {
+            ThreadObject *object = taken.AddNew();
+            object->factory = instances->GetFactory();
+            object->instance = instance;
+        }
+    }
+}
+
 void InterfaceDatabaseObject::UniqueInterface::UseImplementation(InterfaceDatabase::Implementation *impl)
 {
     IFBREAKRETURN(impl == NULL);
@@ -294,7 +1037,7 @@ void InterfaceDatabaseObject::UniqueInterface::UseImplementation(InterfaceDataba
         IFBREAKCONTINUE(ref == NULL);
 
         //make the reference use this implementation
-        ref->UseImplementation(impl->GetInstance());
+        ref->UseImplementation(impl);
     }
 }
 
@@ -325,9 +1068,42 @@ void InterfaceDatabaseObject::UniqueInterface::TransferTo(InterfaceDatabaseObjec
         db->Add(impl);
     }
 
+    //move our plugin to the other database
+    if (plugin != NULL)
+    {
+        db->Add(plugin);
+        plugin = NULL;
+    }
+
+    //and our dependencies
+    while (dependencies.Num() > 0)
+    {
+        db->Add(dependencies.Remove(0L));
+    }
+
     //done
 }
 
+bool InterfaceDatabaseObject::UniqueInterface::Use(const char *implClassName)
+{
+    IFBREAKRETURNVAL(implClassName == NULL, false);
+
+    //find the implementation with that class name
+    for (int32 i = 0, num = implementations.Num(); i < num; i++)
+    {
+        Implementation *impl = implementations.Get(i);
+        if (strcmp(impl->GetImplemenationName(), implClassName) == 0)
+        {
+            //point all the references at it
+            UseImplementation(impl);
+            return true;
+        }
+    }
+
+    //we don't have it
+    return false;
+}
+
 void InterfaceDatabaseObject::UniqueInterface::DisconnectReferences()
 {
     //get the number of references
@@ -347,7 +1123,12 @@ void InterfaceDatabaseObject::UniqueInterface::DisconnectReferences()
 const char *InterfaceDatabaseObject::UniqueInterface::GetInterfaceName()
 {
     //return our name
-    return interfaceName;
+    return interfaceKey.name;
+}
+
+InterfaceDatabase::Implementation *InterfaceDatabaseObject::UniqueInterface::GetActiveImplementation()
+{
+    return curImpl;
 }
 
 IBase *InterfaceDatabaseObject::UniqueInterface::GetActiveInstance()
@@ -380,19 +1161,36 @@ InterfaceDatabase::Reference *InterfaceDatabase::Item::ToReference()
     return NULL;
 }
 
+InterfaceDatabase::Plugin *InterfaceDatabase::Item::ToPlugin()
+{
+    //by default, we aren't a plugin
+    return NULL;
+}
+
+InterfaceDatabase::Dependency *InterfaceDatabase::Item::ToDependency()
+{
+    //by default, we aren't a dependency
+    return NULL;
+}
+
 
 //
 //InterfaceDatabase::Implementation functions
 //
 
-InterfaceDatabase::Implementation::Implementation(IBase &impl, const char *implClassName, const char *interfaceName)
+InterfaceDatabase::Implementation::Implementation(IBase &impl, const char *implClassName, Key const &interfaceKey)
+    : instances(&impl), implementedInterfaceKey(interfaceKey)
 {
-    //save a pointer to the implementation
-    this->impl = &impl;
+    //save the name of the implementation class
+    implementationName = implClassName;
 
-    //save the name of the implemented interface
-    implementedInterfaceName = interfaceName;
+    //add ourself to the global manager
+    InterfaceDatabaseStatic::AddObject(this);
+}
 
+InterfaceDatabase::Implementation::Implementation(Factory &factory, const char *implClassName, Key const &interfaceKey)
+    : instances(&factory), implementedInterfaceKey(interfaceKey)
+{
     //save the name of the implementation class
     implementationName = implClassName;
 
@@ -414,7 +1212,12 @@ InterfaceDatabase::Implementation *InterfaceDatabase::Implementation::ToImplemen
 
 const char *InterfaceDatabase::Implementation::GetInterfaceName()
 {
-    return implementedInterfaceName;
+    return implementedInterfaceKey.name;
+}
+
+InterfaceDatabase::Key const &InterfaceDatabase::Implementation::GetInterfaceKey() const
+{
+    return implementedInterfaceKey;
 }
 
 const char *InterfaceDatabase::Implementation::GetImplemenationName()
@@ -424,7 +1227,12 @@ const char *InterfaceDatabase::Implementation::GetImplemenationName()
 
 IBase *InterfaceDatabase::Implementation::GetInstance()
 {
-    return impl;
+    return instances.GetShared();
+}
+
+InterfaceDatabase::Instances *InterfaceDatabase::Implementation::GetInstances()
+{
+    return &instances;
 }
 
 
@@ -432,11 +1240,12 @@ IBase *InterfaceDatabase::Implementation::GetInstance()
 //InterfaceDatabase::Reference functions
 //
 
-InterfaceDatabase::Reference::Reference(IBase **ifaceRef, const char *interfaceName)
+InterfaceDatabase::Reference::Reference(IBase **ifaceRef, Key const &interfaceKey)
+    : interfaceKey(interfaceKey)
 {
     //save the passed in parameters.
     this->ifaceRef = ifaceRef;
-    this->interfaceName = interfaceName;
+    instancesRef = NULL;
 
     //initialize the pointer
     *ifaceRef = NULL;
@@ -445,7 +1254,24 @@ InterfaceDatabase::Reference::Reference(IBase **ifaceRef, const char *interfaceN
     InterfaceDatabaseStatic::AddObject(this);
 
     //this better never fire.
-    IFBREAKRETURN(interfaceName == NULL || ifaceRef == NULL);
+    IFBREAKRETURN(interfaceKey.name == NULL || ifaceRef == NULL);
+}
+
+InterfaceDatabase::Reference::Reference(Instances **instancesRef, Key const &interfaceKey)
+    : interfaceKey(interfaceKey)
+{
+    //save the passed in parameters.
+    ifaceRef = NULL;
+    this->instancesRef = instancesRef;
+
+    //initialize the pointer
+    *instancesRef = NULL;
+
+    //add ourselves to the global manager
+    InterfaceDatabaseStatic::AddObject(this);
+
+    //this better never fire.
+    IFBREAKRETURN(interfaceKey.name == NULL || instancesRef == NULL);
 }
 
 InterfaceDatabase::Reference::~Reference()
@@ -455,6 +1281,10 @@ InterfaceDatabase::Reference::~Reference()
     {
         *ifaceRef = NULL;
     }
+    if (instancesRef != NULL)
+    {
+        *instancesRef = NULL;
+    }
 
     //remove ourselves from the global manager
     InterfaceDatabaseStatic::RemoveObject(this);
@@ -468,12 +1298,332 @@ InterfaceDatabase::Reference *InterfaceDatabase::Reference::ToReference()
 
 const char *InterfaceDatabase::Reference::GetInterfaceName()
 {
-    return interfaceName;
+    return interfaceKey.name;
+}
+
+InterfaceDatabase::Key const &InterfaceDatabase::Reference::GetInterfaceKey() const
+{
+    return interfaceKey;
+}
+
+void InterfaceDatabase::Reference::UseImplementation(Implementation *impl)
+{
+    //change the pointer with a single store, so threads calling through it never see half of it.
+    //The barrier keeps the compiler from moving earlier stores after it, which with x86 store
+    //ordering makes this a release: a thread which loads the new pointer sees the object ready.
+    if (instancesRef != NULL)
+    {
+        //per thread references find the calling thread's object when they are used
+        _ReadWriteBarrier();
+        *(Instances * volatile *)instancesRef = (impl != NULL) ? impl->GetInstances() : NULL;
+        return;
+    }
+
+    //a plain pointer can only point at a shared object, so it's left NULL for a per thread
+    //implementation, which needs InterfaceLocalReference.
+    IBase *instance = (impl != NULL) ? impl->GetInstance() : NULL;
+    _ReadWriteBarrier();
+    *(IBase * volatile *)ifaceRef = instance;
+    IFBREAKRETURN(impl != NULL && instance == NULL);
+}
+
+
+//
+//InterfaceDatabase::Plugin functions
+//
+
+InterfaceDatabase::Plugin::Plugin(Key const &interfaceKey, const char *fileName)
+    : interfaceKey(interfaceKey)
+{
+    //save the name of the DLL
+    this->fileName = fileName;
+
+    //we haven't loaded it
+    dllHandle = NULL;
+    tried = false;
+
+    //add ourselves to the global manager
+    InterfaceDatabaseStatic::AddObject(this);
+}
+
+InterfaceDatabase::Plugin::~Plugin()
+{
+    //remove ourselves from the global manager.  The DLL stays loaded, its items remove themselves
+    //when the process unloads it.
+    InterfaceDatabaseStatic::RemoveObject(this);
+}
+
+InterfaceDatabase::Plugin *InterfaceDatabase::Plugin::ToPlugin()
+{
+    //we are a plugin object
+    return this;
+}
+
+InterfaceDatabase::Key const &InterfaceDatabase::Plugin::GetInterfaceKey() const
+{
+    return interfaceKey;
+}
+
+const char *InterfaceDatabase::Plugin::GetFileName()
+{
+    return fileName;
+}
+
+bool InterfaceDatabase::Plugin::Tried()
+{
+    return tried;
+}
+
+bool InterfaceDatabase::Plugin::Load()
+{
+    //only try once, a missing DLL stays missing
+    if (tried == true)
+    {
+        return dllHandle != NULL;
+    }
+    tried = true;
+
+    //load the DLL, which makes its static objects in its own database.  An optional DLL may
+    //not be installed, then its interface just stays NULL.
+    dllHandle = LoadLibraryA(fileName);
+    if (dllHandle == NULL)
+    {
+        return false;
+    }
+
+    //move its items into our database, which connects its implementations to our references
+    InterfaceDatabaseStatic::TransferFromDLL(dllHandle, INTERFACE_TRANSFER_FUNC);
+    return true;
+}
+
+
+//
+//InterfaceDatabase::Dependency functions
+//
+
+InterfaceDatabase::Dependency::Dependency(Key const &interfaceKey, Key const &afterKey)
+    : interfaceKey(interfaceKey), afterKey(afterKey)
+{
+    //add ourselves to the global manager
+    InterfaceDatabaseStatic::AddObject(this);
+}
+
+InterfaceDatabase::Dependency::~Dependency()
+{
+    //remove ourselves from the global manager
+    InterfaceDatabaseStatic::RemoveObject(this);
+}
+
+InterfaceDatabase::Dependency *InterfaceDatabase::Dependency::ToDependency()
+{
+    //we are a dependency object
+    return this;
+}
+
+InterfaceDatabase::Key const &InterfaceDatabase::Dependency::GetInterfaceKey() const
+{
+    return interfaceKey;
+}
+
+InterfaceDatabase::Key const &InterfaceDatabase::Dependency::GetAfterKey() const
+{
+    return afterKey;
+}
+
+
+//
+//InterfaceDatabase::Instances functions
+//
+
+InterfaceDatabase::Instances::Instances(IBase *shared)
+{
+    //every thread uses this one
+    this->shared = shared;
+    factory = NULL;
+    slot = TLS_OUT_OF_INDEXES;
+}
+
+InterfaceDatabase::Instances::Instances(Factory *factory)
+{
+    //each thread makes its own
+    shared = NULL;
+    this->factory = factory;
+
+    //the slot each thread keeps its object in
+    slot = TlsAlloc();
+    IFBREAKRETURN(slot == TLS_OUT_OF_INDEXES);
+}
+
+InterfaceDatabase::Instances::~Instances()
+{
+    //destroy the objects of threads which are still running, or exited without releasing them
+    for (int32 i = 0, num = made.Num(); i < num; i++)
+    {
+        factory->Destroy(made.Get(i));
+    }
+    made.Empty();
+
+    //done with the slot
+    if (slot != TLS_OUT_OF_INDEXES)
+    {
+        TlsFree(slot);
+    }
+}
+
+IBase *InterfaceDatabase::Instances::GetShared()
+{
+    return shared;
+}
+
+bool InterfaceDatabase::Instances::IsPerThread() const
+{
+    return factory != NULL;
+}
+
+IBase *InterfaceDatabase::Instances::GetThread()
+{
+    IFBREAKNULL(factory == NULL || slot == TLS_OUT_OF_INDEXES);
+
+    //check if this thread already has one
+    IBase *instance = (IBase *)TlsGetValue(slot);
+    if (instance != NULL)
+    {
+        return instance;
+    }
+
+    //make it, on the thread which will use it
+    instance = factory->Create();
+    IFBREAKNULL(instance == NULL);
+    TlsSetValue(slot, instance);
+
+    //remember it so it can be destroyed
+    SpinLockScope scope(lock);
+    made.Add(instance);
+    return instance;
+}
+
+IBase *InterfaceDatabase::Instances::TakeThread()
+{
+    //only per thread objects belong to a thread
+    if (factory == NULL || slot == TLS_OUT_OF_INDEXES)
+    {
+        return NULL;
+    }
+
+    //check if this thread made one
+    IBase *instance = (IBase *)TlsGetValue(slot);
+    if (instance == NULL)
+    {
+        return NULL;
+    }
+    TlsSetValue(slot, NULL);
+
+    //forget it, it's the caller's to destroy now
+    SpinLockScope scope(lock);
+    made.Remove(instance);
+    return instance;
+}
+
+InterfaceDatabase::Factory *InterfaceDatabase::Instances::GetFactory()
+{
+    return factory;
+}
+
+
+//
+//IBase functions
+//
+
+bool IBase::Startup(Context &caller)
+{
+    //nothing to start
+    return true;
+}
+
+
+//
+//global functions
+//
+
+bool InterfaceUse(const char *interfaceName, const char *implClassName)
+{
+    IFBREAKRETURNVAL(interfaceName == NULL || implClassName == NULL, false);
+
+#if defined(__CONFIG_STATIC_INTERFACES)
+    //the references were bound when we were linked, so there's nothing to switch
+    return false;
+#else
+    //get the database every module shares
+    InterfaceDatabaseObject *database = InterfaceDatabaseStatic::GetManager();
+    IFBREAKRETURNVAL(database == NULL, false);
+
+    //switch it
+    return database->Use(InterfaceDatabase::Key(interfaceName, HashFunc64(interfaceName)), implClassName);
+#endif
+}
+
+int32 InterfaceLoadPlugins()
+{
+    //get the database every module shares
+    InterfaceDatabaseObject *database = InterfaceDatabaseStatic::GetManager();
+    IFBREAKRETURNVAL(database == NULL, 0);
+
+    //load everything that's wanted
+    return database->LoadPlugins();
+}
+
+bool InterfaceStartup(Context &caller, int32 numThreads)
+{
+    CONTEXT_CALLED();
+
+    //get the database every module shares
+    InterfaceDatabaseObject *database = InterfaceDatabaseStatic::GetManager();
+    IFBREAKCONTEXT(database == NULL);
+
+    //start everything up
+    return database->Startup(context, numThreads);
+}
+
+void InterfaceSynchronize()
+{
+    //get the database every module shares
+    InterfaceDatabaseObject *database = InterfaceDatabaseStatic::GetManager();
+    IFBREAKRETURN(database == NULL);
+
+    //wait for the grace period
+    database->Synchronize();
+}
+
+
+//
+//InterfaceThread functions
+//
+
+InterfaceThread::InterfaceThread()
+{
+    //remember which thread we are, so it doesn't wait for itself
+    threadId = GetCurrentThreadId();
+    prev = NULL;
+    next = NULL;
+
+    //not registered yet
+    epoch = &quiescentEpoch;
+    quiescentEpoch = 0;
+
+    //register with the database every module shares
+    InterfaceDatabaseObject *database = InterfaceDatabaseStatic::GetManager();
+    IFBREAKRETURN(database == NULL);
+    database->AddThread(this);
 }
 
-void InterfaceDatabase::Reference::UseImplementation(IBase *impl)
+InterfaceThread::~InterfaceThread()
 {
-    //change the pointer
-    *ifaceRef = impl;
+    //stop being waited for
+    InterfaceDatabaseObject *database = InterfaceDatabaseStatic::GetManager();
+    IFBREAKRETURN(database == NULL);
+    database->RemoveThread(this);
+
+    //the thread is done with its own objects of per thread implementations
+    database->ReleaseThread();
 }
 
@@ -27,7 +27,16 @@ class InterfaceDatabaseStatic;
 class InterfaceDatabaseObject;
 
 #include "common\idb\InterfaceDatabase.h"
+#include "common\idb\IBase.h"
 #include "common\global\ManagerStatic.h"
+#include "common\global\SpinLock.h"
+#include "common\global\Atom.h"
+
+//the name of the function every module exports to move its items into the loading module's database
+#define INTERFACE_TRANSFER_FUNC "InterfaceDatabaseTransfer"
+
+//the most threads InterfaceStartup uses
+#define INTERFACE_STARTUP_MAX_THREADS 64
 
 //
 //ManagerStatic implementation.
@@ -45,6 +54,29 @@ public:
 class InterfaceDatabaseObject : public InterfaceDatabase
 {
 public:
+    InterfaceDatabaseObject();
+
+    //switches the interface with the given key to the implementation with the given class name,
+    //and waits for the grace period.  Returns false if either isn't registered.
+    bool Use(Key const &key, const char *implClassName);
+
+    //adds/removes a thread from the grace period tracking
+    void AddThread(InterfaceThread *thread);
+    void RemoveThread(InterfaceThread *thread);
+
+    //destroys the calling thread's objects of every per thread implementation
+    void ReleaseThread();
+
+    //starts a grace period and waits until every other registered thread has been quiescent.
+    void Synchronize();
+
+    //loads the plugins of every interface which is referenced but has no implementation, until
+    //there are none left.  Returns the number of DLLs loaded.
+    int32 LoadPlugins();
+
+    //calls Startup on every active implementation, on numThreads threads in dependency order.
+    //Returns false if any failed or the dependencies have a cycle.
+    bool Startup(Context &caller, int32 numThreads);
 
 private:
     //from InterfaceManager.
@@ -52,33 +84,74 @@ private:
     void Remove(Item *object);
     void Transfer(InterfaceDatabase *manager);
 
-    //specialized versions of Add and Remove
+    //specialized versions of Add and Remove.  Removing an implementation returns true if it was the active one.
     void Add(Implementation *impl);
     void Add(Reference *ref);
-    void Remove(Implementation *impl);
+    bool Remove(Implementation *impl);
     void Remove(Reference *ref);
+    void Add(Plugin *plugin);
+    void Remove(Plugin *plugin);
+    void Add(Dependency *dependency);
+    void Remove(Dependency *dependency);
+
+    //a per thread object taken from its thread, and the factory which destroys it
+    class ThreadObject
+    {
+    public:
+        Factory *factory;
+        IBase *instance;
+    };
 
     //each unique interface name has a section in the database
     //A unique interface is a combination interface and instance name.
     class UniqueInterface
     {
     public:
-        UniqueInterface(char const *name);
+        UniqueInterface(Key const &key);
+        ~UniqueInterface();
+
+        //returns the key of the interface we manage.
+        Key const &GetKey() const;
 
-        //returns the name of the interface we manage.
-        const char *GetName() const;
+        //the next interface whose key has the same hash as ours, or NULL.  Almost always NULL.
+        UniqueInterface *GetCollision() const;
+        void SetCollision(UniqueInterface *iface);
 
-        //adds/removes an interface implementation
+        //adds/removes an interface implementation.  Remove returns true if it was the active one.
         void Add(Implementation *impl);
-        void Remove(Implementation *impl);
+        bool Remove(Implementation *impl);
 
         //adds/removes an interface reference
         void Add(Reference *ref);
         void Remove(Reference *ref);
 
+        //adds/removes the plugin which implements this interface
+        void Add(Plugin *plugin);
+        void Remove(Plugin *plugin);
+
+        //returns our plugin if we are referenced, have no implementation, and it hasn't been tried.
+        Plugin *GetPendingPlugin();
+
+        //adds/removes a dependency of our Startup on another interface
+        void Add(Dependency *dependency);
+        void Remove(Dependency *dependency);
+
+        //the interfaces our Startup must run after
+        int32 NumDependencies();
+        Dependency *GetDependency(int32 index);
+
+        //takes the calling thread's objects of our per thread implementations, adding them to taken
+        void TakeThread(ArrayValue<ThreadObject> &taken);
+
+        //gets the implementation which is currently active, or NULL
+        Implementation *GetActiveImplementation();
+
         //transfers all our objects to the given database
         void TransferTo(InterfaceDatabaseObject *db);
 
+        //activates the implementation with the given class name.  Returns false if we don't have it.
+        bool Use(const char *implClassName);
+
         //gets our interface name
         const char *GetInterfaceName();
 
@@ -86,18 +159,29 @@ private:
         IBase *GetActiveInstance();
 
     private:
-        //the name of the interface
-        buffer128 interfaceName;
+        //the name of the interface.  The key's name is our atom's copy, so it stays valid however
+        //long the string of the module which registered us does.
+        Key interfaceKey;
+        Atom interfaceName;
 
-        //the implementations of this interface that we currently know about
-        ArrayPointer<Implementation> implementations;
+        //the next interface with the same hash, which we own
+        UniqueInterface *collision;
+
+        //the implementations of this interface that we currently know about.  Almost always just one.
+        ArrayPointerInline<Implementation, 2> implementations;
 
         //the addresses of references to this interface
-        ArrayPointer<Reference> references;
+        ArrayPointerInline<Reference, 4> references;
 
         //the implementation that is currently being used
         Implementation *curImpl;
 
+        //the DLL which implements this interface, if it isn't linked in
+        Plugin *plugin;
+
+        //the interfaces our Startup must run after
+        ArrayPointer<Dependency> dependencies;
+
     private:
         //activates the given implementation, all references will point to it.
         void UseImplementation(Implementation *impl);
@@ -106,13 +190,96 @@ private:
         void DisconnectReferences();
     };
 
-    //The main data in the database, the collection of UniqueInterfaces
-    ArraySortedOwner<UniqueInterface> database;
+    //The main data in the database, the collection of UniqueInterfaces, keyed by the hash of their name.
+    //Interfaces whose names share a hash are chained off the one in the database.
+    ArrayHashedOwner<uint64, UniqueInterface> database;
+
+    //finds or creates a UniqueInterface for the given interface key.
+    UniqueInterface *GetIface(Key const &key);
+
+    //finds the UniqueInterface for the given interface key, or returns NULL.
+    UniqueInterface *FindIface(Key const &key);
+
+    //finds a plugin which needs to be loaded, or returns NULL.
+    Plugin *FindPendingPlugin();
+
+    //an implementation being started up
+    class StartupNode
+    {
+    public:
+        StartupNode(UniqueInterface *iface);
+
+        //the interface and the implementation we start up
+        UniqueInterface *iface;
+        const char *interfaceName;
+        const char *implementationName;
+        IBase *instance;
+
+        //number of the interfaces we run after which haven't finished yet
+        int32 waitingOn;
+
+        //the same count, used to check for cycles before we start
+        int32 unordered;
+
+        //the nodes which run after us
+        ArrayPointer<StartupNode> dependents;
+
+        //true if a node we run after failed, so we don't run
+        bool dependencyFailed;
+
+        //true if our Startup succeeded
+        bool succeeded;
+
+        //how long our Startup took, in performance counter ticks
+        int64 ticks;
+    };
+
+    //one call to Startup, shared by the threads doing it
+    class StartupRun
+    {
+    public:
+        StartupRun(Context &creator, int32 numThreads);
+        ~StartupRun();
+
+        //runs nodes as they become ready until they are all done
+        void Work(Context &caller);
+
+        //entry point of the extra threads
+        static unsigned __stdcall Thread(void *param);
+
+        //the context of the thread which called Startup, the root of the other threads' contexts
+        Context &creator;
+
+        //the threads working, including the creator
+        int32 numThreads;
+
+        //every node, and the ones whose dependencies are all done
+        ArrayPointerOwner<StartupNode> nodes;
+        ArrayPointerQueue<StartupNode> ready;
+
+        //number of nodes which haven't finished
+        int32 remaining;
+
+        //protects ready, remaining and the nodes' waitingOn counts
+        SpinLock lock;
+
+        //counts the ready nodes, plus one for each thread when everything is done
+        HANDLE semaphore;
+
+    private:
+        //runs a node's Startup and readies the nodes after it
+        void Run(StartupNode *node, Context &caller);
+    };
+
+    //protects the database.  Items are added by static constructors, which can run on any thread
+    //when a DLL is loaded, and InterfaceUse can be called on any thread.
+    SpinLock lock;
 
-    //finds or creates a UniqueInterface for the given interface name.
-    UniqueInterface *GetIface(char const *name);
+    //the number of grace periods that have been started
+    long volatile epoch;
 
-    //compare and find functions
-    SortedArrayFunctions(CompareIFace, FindIFace, UniqueInterface, char const *, GetName());
+    //the threads registered with InterfaceThread, and the lock protecting the list
+    InterfaceThread *firstThread;
+    SpinLock threadLock;
 };
 
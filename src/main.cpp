@@ -18,11 +18,20 @@
 
 #include "pch.h"
 #include "common\global\global.h"
+#include "common\idb\IBase.h"
 #include <SFML\Graphics.hpp>
 #include "render\RenderThread.h"
+#include "test\Test.h"
 
 int __stdcall wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPWSTR lpCmdLine, int nShowCmd)
 {
+#if defined(__CONFIG_TEST)
+    //the test build only runs the tests
+    return TestRun();
+#else
+    //load the DLLs which implement interfaces we reference but don't link
+    InterfaceLoadPlugins();
+
     sf::RenderWindow window(sf::VideoMode(800, 600), "v1 game");
 
     //deactivate window so we can render to it from other thread.
@@ -44,5 +53,6 @@ int __stdcall wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPWSTR lpCm
     }
 
     return 0;
+#endif
 }
 
@@ -20,28 +20,42 @@
 #include <SFML\Graphics.hpp>
 #include "render\RenderThread.h"
 
+//what the references below bind to in static interface builds
+#include "sim\src\StaticInterfaces.h"
+
 //text drawing interface
 #include "sim\IScreenText.h"
-static IScreenText *screenText;
+static InterfacePointer(IScreenText, default) screenText;
 InterfaceReference(screenText, IScreenText, default);
 
 //time interface
 #include "sim\ITime.h"
-static ITime *timer;
+static InterfacePointer(ITime, default) timer;
 InterfaceReference(timer, ITime, default);
 
 //frame rate tracking interface
 #include "sim\IFrameRate.h"
-static IFrameRate *frameRate;
+static InterfacePointer(IFrameRate, default) frameRate;
 InterfaceReference(frameRate, IFrameRate, default);
 
+//call tree writing interface
+#include "sim\IProfiler.h"
+static InterfacePointer(IProfiler, default) profiler;
+InterfaceReference(profiler, IProfiler, default);
+
+//how many call paths the profile report lists
+#define PROFILE_REPORT_LINES 32
+
 
 void RenderingThread(sf::RenderWindow* window)
 {
     CONTEXT_ROOT();
 
-    //initialize screen text module
-    screenText->Startup(context);
+    //we call through interfaces that can be switched while we run
+    InterfaceThread interfaceThread;
+
+    //start up all the modules, the ones that don't need each other at the same time
+    IFBREAKCONTEXTRETURN(InterfaceStartup(context) == false);
 
     //load a texture.
     sf::Texture grassTexture;
@@ -54,12 +68,12 @@ void RenderingThread(sf::RenderWindow* window)
     sf::Sprite sprite;
     sprite.setTexture(grassTexture);
 
-    //initialize time module
-    timer->Startup(context);
-
     // the rendering loop
     while (window->isOpen())
     {
+        //we aren't inside any interface between frames, so implementations can be switched here.
+        interfaceThread.Quiescent();
+
         //register the start of this frame.
         timer->UpdateTime();
 
@@ -96,4 +110,11 @@ void RenderingThread(sf::RenderWindow* window)
         //show the stuff we drew to the window.
         if (window->isOpen() == true) window->display();
     }
+
+#if defined(__CONFIG_CALL_TREE)
+    //write out where the time went
+    profiler->Report(PROFILE_REPORT_LINES, context);
+    profiler->WriteChromeTrace("profile.json", context);
+    profiler->WriteFoldedStacks("profile.folded", context);
+#endif
 }
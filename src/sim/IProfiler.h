@@ -0,0 +1,43 @@
+//
+// v1 - Prototype character/item/tradeskill game.
+// Copyright (C) 2013 Adam Hayek (adam.hayek@gmail.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see [http://www.gnu.org/licenses/].
+//
+
+#pragma once
+
+#include "common\idb\IBase.h"
+
+//
+//Module for writing out the call trees of builds with __CONFIG_CALL_TREE, see CallTree.h.
+//Times are converted from cycles with ITime::CyclesSeconds.  Without the call tree there is
+//nothing to write, and every function returns false.
+//
+
+class IProfiler : public IBase
+{
+public:
+    //writes every thread's call tree as a Chrome trace, for chrome://tracing or Perfetto.  Each
+    //call path is one event lasting its total time, with its children laid out one after another
+    //inside it, so the trace reads like a flame graph per thread.
+    virtual bool WriteChromeTrace(char const *fileName, Context &caller) = 0;
+
+    //writes every call path as a line of folded stacks, the function names from the root down
+    //separated by semicolons and then its exclusive cycles, for flamegraph.pl and speedscope.
+    virtual bool WriteFoldedStacks(char const *fileName, Context &caller) = 0;
+
+    //writes the call paths with the most exclusive time to the debug output.
+    virtual bool Report(int32 numLines, Context &caller) = 0;
+};
@@ -16,12 +16,13 @@
 //  along with this program.  If not, see [http://www.gnu.org/licenses/].
 //
 
-#include "sim\IFrameRate.h"
+#include "sim\src\FrameRateImpl.h"
 
 
 //text drawing interface
 #include "sim\IScreenText.h"
-static IScreenText *screenText;
+#include "sim\src\StaticInterfaces.h"
+static InterfacePointer(IScreenText, default) screenText;
 InterfaceReference(screenText, IScreenText, default);
 
 
@@ -29,43 +30,25 @@ InterfaceReference(screenText, IScreenText, default);
 #define TIME_EACH_FRAME 0.25f
 #define FRAMES_EACH_SECOND 4
 
-//our implementation of IFrameRate
-class FrameRateImpl : public IFrameRate
-{
-public:
-    InterfaceImplementation(FrameRateImpl);
-
-    //from IFrameRate
-    bool FrameStatistics(float timeSeconds, Context &caller);
-
-    //data for a frame
-    class Frame
-    {
-    public:
-        //how many frames this was worth.
-        int numFrames;
-
-        //time spend rendering this frame
-        double timeSeconds;
-    };
-
-    //all the frames we track right now
-    ArrayPointerOwnerQueue<Frame> frames;
-
-    //computed average frame time
-    float averageFrameTime;
-
-    //spare objects we can use instead of allocating a new one
-    ArrayPointerOwner<Frame> spares;
-};
-
 //instantiate and register our implementation
 InterfaceCreate(FrameRateImpl, frameRateImpl, IFrameRate, default);
 
+//we print our text as soon as we're running
+InterfaceStartupAfter(IFrameRate, default, IScreenText, default);
+
 //
 //FrameRateImpl functions
 //
 
+FrameRateImpl::FrameRateImpl()
+{
+    //no frames yet
+    averageFrameTime = 0.0f;
+
+    //name our frames in the array stats report
+    ARRAY_STATS_PLACE(frames);
+}
+
 bool FrameRateImpl::FrameStatistics(float timeSeconds, Context &caller)
 {
     CONTEXT_CALLED();
@@ -84,21 +67,9 @@ bool FrameRateImpl::FrameStatistics(float timeSeconds, Context &caller)
     }
     else
     {
-        //we need a new frame.
-        //check if we have a spare
-        if (spares.Num() > 0)
-        {
-            //take one from the spares list
-            frame = spares.Remove(0);
-        }
-        else
-        {
-            //we need to allocate a new one
-            frame = new Frame();
-        }
-
-        //add the frame to the list
-        frames.Add(frame);
+        //we need a new frame, add it to the list
+        frame = frames.AddNew();
+        IFBREAKCONTEXT(frame == null);
 
         //save frame data
         frame->timeSeconds = timeSeconds;
@@ -109,10 +80,7 @@ bool FrameRateImpl::FrameStatistics(float timeSeconds, Context &caller)
     while (frames.Num() > MAX_FRAMES)
     {
         //we can remove the oldest frame
-        Frame *oldest = frames.Remove(0);
-
-        //add it to our spares
-        spares.Add(oldest);
+        frames.PopFront();
     }
 
     //total time for all our frames
@@ -121,14 +89,14 @@ bool FrameRateImpl::FrameStatistics(float timeSeconds, Context &caller)
     //total number of frames
     int totalFrameCount = 0;
 
-    //add up all frame times
-    for (int i = 0, len = frames.Num(); i < len; i++)
+    //add up all frame times.  The iterators don't range check every frame like Get does.
+    for (ArrayValueQueue<Frame>::const_iterator iter = frames.begin(), end = frames.end(); iter != end; ++iter)
     {
         //add time for this frame
-        totalTime += float(frames.Get(i)->timeSeconds);
+        totalTime += float(iter->timeSeconds);
 
         //add to total frame count
-        totalFrameCount += frames.Get(i)->numFrames;
+        totalFrameCount += iter->numFrames;
     }
 
     //compute frames per second.
@@ -139,20 +107,20 @@ bool FrameRateImpl::FrameStatistics(float timeSeconds, Context &caller)
     totalFrameCount = 0;
 
     //go through last 2 seconds only
-    for (int len = frames.Num(), i = max(0, len - FRAMES_EACH_SECOND * 2); i < len; i++)
+    for (ArrayValueQueue<Frame>::const_iterator end = frames.end(), iter = end - min(frames.Num(), FRAMES_EACH_SECOND * 2); iter != end; ++iter)
     {
         //add time for this frame
-        totalTime += float(frames.Get(i)->timeSeconds);
+        totalTime += float(iter->timeSeconds);
 
         //add to total frame count
-        totalFrameCount += frames.Get(i)->numFrames;
+        totalFrameCount += iter->numFrames;
     }
 
     //compute recent fps
     float recentFps = totalFrameCount / totalTime;
 
     //display the time.
-    ubuffer256 frameDisplay; frameDisplay.Set(L"%3.0f FPS (%3.0f)", recentFps, smoothFps);
+    ubuffer256 frameDisplay; frameDisplay.AppendFloat(recentFps, 0, 3).Append(L" FPS (").AppendFloat(smoothFps, 0, 3).Append(L')');
     IFBREAKCONTEXTMSG(screenText->PrintLineTopLeft(frameDisplay, context) == false, "Error displaying frame rate on screen.");
     
     //success
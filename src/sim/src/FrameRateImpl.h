@@ -0,0 +1,50 @@
+//
+// v1 - Prototype character/item/tradeskill game.
+// Copyright (C) 2013 Adam Hayek (adam.hayek@gmail.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see [http://www.gnu.org/licenses/].
+//
+
+#pragma once
+
+#include "sim\IFrameRate.h"
+
+//our implementation of IFrameRate
+class FrameRateImpl InterfaceSealed : public IFrameRate
+{
+public:
+    InterfaceImplementation(FrameRateImpl);
+
+    FrameRateImpl();
+
+    //from IFrameRate
+    bool FrameStatistics(float timeSeconds, Context &caller);
+
+    //data for a frame
+    class Frame
+    {
+    public:
+        //how many frames this was worth.
+        int numFrames;
+
+        //time spend rendering this frame
+        double timeSeconds;
+    };
+
+    //all the frames we track right now, stored in place so we don't allocate them.
+    ArrayValueQueue<Frame> frames;
+
+    //computed average frame time
+    float averageFrameTime;
+};
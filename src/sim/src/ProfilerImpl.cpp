@@ -0,0 +1,469 @@
+//
+// v1 - Prototype character/item/tradeskill game.
+// Copyright (C) 2013 Adam Hayek (adam.hayek@gmail.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see [http://www.gnu.org/licenses/].
+//
+
+#include "pch.h"
+#include "sim\src\ProfilerImpl.h"
+
+//time interface, to convert cycles to time
+#include "sim\ITime.h"
+#include "sim\src\StaticInterfaces.h"
+static InterfacePointer(ITime, default) timer;
+InterfaceReference(timer, ITime, default);
+
+//instantiate and register our implementation
+InterfaceCreate(ProfilerImpl, profilerImpl, IProfiler, default);
+
+#if defined(__CONFIG_CALL_TREE)
+
+//how much text we collect before writing it to the file
+#define PROFILER_FILE_BUFFER 16384
+
+//the cycle count we convert to find the length of a cycle, big enough to keep the precision of a float
+#define PROFILER_CYCLES_SAMPLE 1000000000
+
+//
+//local classes
+//
+
+//a file written a buffer at a time
+class ProfilerFile
+{
+private:
+    ProfilerFile(ProfilerFile const &other);
+public:
+    ProfilerFile(char const *fileName);
+    ~ProfilerFile();
+
+    //true if the file opened
+    bool IsOpen() const;
+
+    //adds text to the file
+    void Write(char const *text, int32 length);
+
+    //writes out the buffer and closes the file.  Returns false if anything couldn't be written.
+    bool Close();
+
+private:
+    //writes out the buffer
+    void Flush();
+
+    //the file, or INVALID_HANDLE_VALUE
+    HANDLE file;
+
+    //text not written yet
+    char buffer[PROFILER_FILE_BUFFER];
+    int32 used;
+
+    //true if a write failed
+    bool failed;
+};
+
+//a line of the report
+class ProfilerLine
+{
+public:
+    CallNode *node;
+    int64 inclusive;
+    int64 exclusive;
+};
+
+
+//
+//local functions
+//
+
+//the length of a cycle in microseconds, or 0 if we can't tell yet
+static double ProfilerMicrosecondsPerCycle()
+{
+    //the timer is linear, so convert once and scale
+    if (timer == null)
+    {
+        return 0.0;
+    }
+    double microseconds = double(timer->CyclesSeconds(PROFILER_CYCLES_SAMPLE)) * 1000000.0 / PROFILER_CYCLES_SAMPLE;
+
+    //it's infinite until the timer has measured the cpu
+    return (microseconds > 0.0 && microseconds < 1.0) ? microseconds : 0.0;
+}
+
+//the function name out of a place's signature, without the return type, calling convention and
+//parameters: "bool __thiscall ScreenTextImpl::Startup(class Context &)" is "ScreenTextImpl::Startup".
+static void ProfilerName(Place const *place, buffer256 &name)
+{
+    char const *signature = place->Description();
+
+    //the parameters start at the first parenthesis outside of template arguments
+    char const *end = signature;
+    for (int32 depth = 0; *end != '\0'; end++)
+    {
+        if (*end == '<')
+        {
+            depth++;
+        }
+        else if (*end == '>')
+        {
+            depth--;
+        }
+        else if (*end == '(' && depth == 0)
+        {
+            break;
+        }
+    }
+
+    //the name starts after the last space before them outside of template arguments
+    char const *start = end;
+    for (int32 depth = 0; start > signature; start--)
+    {
+        if (start[-1] == '>')
+        {
+            depth++;
+        }
+        else if (start[-1] == '<')
+        {
+            depth--;
+        }
+        else if (start[-1] == ' ' && depth == 0)
+        {
+            break;
+        }
+    }
+
+    //use the whole signature if it isn't shaped like we expect
+    if (start == end)
+    {
+        name = signature;
+        return;
+    }
+    name.Strncpy(start, int32(end - start));
+}
+
+//appends text to a JSON string, escaping what JSON doesn't allow
+static void ProfilerJsonAppend(buffer1024 &line, char const *text)
+{
+    for (; *text != '\0'; text++)
+    {
+        if (*text == '"' || *text == '\\')
+        {
+            line.Append('\\');
+        }
+        line.Append(*text);
+    }
+}
+
+//the cycles of a call path, which is the cycles of its children if it hasn't returned yet
+static int64 ProfilerInclusive(CallNode *node, int64 childCycles)
+{
+    return (node->NumCycles() > childCycles) ? node->NumCycles() : childCycles;
+}
+
+//writes the Chrome trace events of a node's children, laid out one after another from start.
+//Returns the cycles they took.
+static int64 ProfilerTraceChildren(ProfilerFile &file, CallNode *node, int64 start, uint32 threadId, double microsecondsPerCycle)
+{
+    int64 childStart = start;
+    for (CallNode *child = node->FirstChild(); child != NULL; child = child->NextSibling())
+    {
+        //its children first, since it needs their cycles
+        int64 grandchildCycles = ProfilerTraceChildren(file, child, childStart, threadId, microsecondsPerCycle);
+        int64 inclusive = ProfilerInclusive(child, grandchildCycles);
+
+        //the event
+        buffer256 name;
+        ProfilerName(child->Spot(), name);
+        buffer1024 line;
+        line.Append(",\n{\"name\":\"");
+        ProfilerJsonAppend(line, name);
+        line.Append("\",\"cat\":\"call\",\"ph\":\"X\",\"pid\":1,\"tid\":").AppendInt(threadId);
+        line.Append(",\"ts\":").AppendFloat(childStart * microsecondsPerCycle, 3);
+        line.Append(",\"dur\":").AppendFloat(inclusive * microsecondsPerCycle, 3);
+        line.Append(",\"args\":{\"calls\":").AppendInt(child->NumCalls());
+        line.Append(",\"exclusive_us\":").AppendFloat((inclusive - grandchildCycles) * microsecondsPerCycle, 3);
+        line.Append("}}");
+        file.Write(line, line.Length());
+
+        //the next child starts after it
+        childStart += inclusive;
+    }
+    return childStart - start;
+}
+
+//writes the folded stack lines of a node's children, whose path so far is in path.
+//Returns the cycles they took.
+static int64 ProfilerFoldChildren(ProfilerFile &file, CallNode *node, buffer1024 &path)
+{
+    int64 cycles = 0;
+    int32 pathLength = path.Length();
+    for (CallNode *child = node->FirstChild(); child != NULL; child = child->NextSibling())
+    {
+        //add it to the path
+        buffer256 name;
+        ProfilerName(child->Spot(), name);
+        path.Append(';').Append(name);
+
+        //its children first, since it needs their cycles
+        int64 grandchildCycles = ProfilerFoldChildren(file, child, path);
+        int64 inclusive = ProfilerInclusive(child, grandchildCycles);
+
+        //paths which spent no time of their own add nothing to the graph
+        int64 exclusive = inclusive - grandchildCycles;
+        if (exclusive > 0)
+        {
+            buffer32 count;
+            count.Append(' ').AppendInt(exclusive).Append('\n');
+            file.Write(path, path.Length());
+            file.Write(count, count.Length());
+        }
+
+        //back to our path
+        path.Truncate(pathLength);
+        cycles += inclusive;
+    }
+    return cycles;
+}
+
+//adds a report line for each of a node's children, keeping the ones with the most exclusive cycles.
+//Returns the cycles they took.
+static int64 ProfilerReportChildren(CallNode *node, ArrayValueSorted<ProfilerLine> &lines, int32 numLines, ArrayValueSorted<ProfilerLine>::CompareFunc compareFunc)
+{
+    int64 cycles = 0;
+    for (CallNode *child = node->FirstChild(); child != NULL; child = child->NextSibling())
+    {
+        //its children first, since it needs their cycles
+        int64 grandchildCycles = ProfilerReportChildren(child, lines, numLines, compareFunc);
+
+        //add it, and drop the smallest if there are too many
+        ProfilerLine line;
+        line.node = child;
+        line.inclusive = ProfilerInclusive(child, grandchildCycles);
+        line.exclusive = line.inclusive - grandchildCycles;
+        lines.Add(line, compareFunc);
+        if (lines.Num() > numLines)
+        {
+            lines.Remove(lines.Num() - 1);
+        }
+
+        cycles += line.inclusive;
+    }
+    return cycles;
+}
+
+//sort function, most exclusive cycles first
+static int32 ProfilerCompareExclusive(ProfilerLine const *left, ProfilerLine const *right)
+{
+    return (right->exclusive > left->exclusive) ? 1 : ((right->exclusive < left->exclusive) ? -1 : 0);
+}
+
+
+//
+//ProfilerFile functions
+//
+
+ProfilerFile::ProfilerFile(char const *fileName)
+{
+    //replace any file that's there
+    file = CreateFileA(fileName, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    used = 0;
+    failed = (file == INVALID_HANDLE_VALUE);
+}
+
+ProfilerFile::~ProfilerFile()
+{
+    //make sure we're closed
+    Close();
+}
+
+bool ProfilerFile::IsOpen() const
+{
+    return file != INVALID_HANDLE_VALUE;
+}
+
+void ProfilerFile::Write(char const *text, int32 length)
+{
+    //text that doesn't fit goes out a buffer at a time
+    while (length > 0)
+    {
+        //make room
+        if (used == PROFILER_FILE_BUFFER)
+        {
+            Flush();
+        }
+
+        //copy what fits
+        int32 count = PROFILER_FILE_BUFFER - used;
+        bound_max(count, length);
+        memcpy(&buffer[used], text, count);
+        used += count;
+        text += count;
+        length -= count;
+    }
+}
+
+bool ProfilerFile::Close()
+{
+    //check if we're already closed
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return failed == false;
+    }
+
+    //write the rest and close
+    Flush();
+    CloseHandle(file);
+    file = INVALID_HANDLE_VALUE;
+    return failed == false;
+}
+
+void ProfilerFile::Flush()
+{
+    //write the buffer, remembering if it didn't all go
+    DWORD written = 0;
+    if (file != INVALID_HANDLE_VALUE && used > 0)
+    {
+        if (WriteFile(file, buffer, DWORD(used), &written, NULL) == FALSE || written != DWORD(used))
+        {
+            failed = true;
+        }
+    }
+    used = 0;
+}
+
+#endif
+
+
+//
+//ProfilerImpl functions
+//
+
+bool ProfilerImpl::WriteChromeTrace(char const *fileName, Context &caller)
+{
+    CONTEXT_CALLED();
+
+#if defined(__CONFIG_CALL_TREE)
+    //we need the length of a cycle
+    double microsecondsPerCycle = ProfilerMicrosecondsPerCycle();
+    IFBREAKCONTEXTMSG(microsecondsPerCycle == 0.0, "the timer hasn't measured the cpu speed");
+
+    //make the file
+    ProfilerFile file(fileName);
+    IFBREAKCONTEXT(file.IsOpen() == false);
+
+    //the process, so every other event can start with a comma
+    static char const header[] = "{\"traceEvents\":[\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"v1\"}}";
+    file.Write(header, sizeof(header) - 1);
+
+    //each thread's tree, its root contexts from the start of the trace
+    for (CallTree *tree = CallTree::First(); tree != NULL; tree = tree->Next())
+    {
+        //name the thread
+        buffer128 line;
+        line.Append(",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":").AppendInt(tree->ThreadId());
+        line.Append(",\"args\":{\"name\":\"thread ").AppendInt(tree->ThreadId()).Append("\"}}");
+        file.Write(line, line.Length());
+
+        //its calls
+        ProfilerTraceChildren(file, tree->Root(), 0, tree->ThreadId(), microsecondsPerCycle);
+    }
+
+    //done
+    static char const footer[] = "\n],\"displayTimeUnit\":\"ms\"}\n";
+    file.Write(footer, sizeof(footer) - 1);
+    IFBREAKCONTEXT(file.Close() == false);
+    return true;
+#else
+    //there's no call tree in this build
+    return false;
+#endif
+}
+
+bool ProfilerImpl::WriteFoldedStacks(char const *fileName, Context &caller)
+{
+    CONTEXT_CALLED();
+
+#if defined(__CONFIG_CALL_TREE)
+    //make the file
+    ProfilerFile file(fileName);
+    IFBREAKCONTEXT(file.IsOpen() == false);
+
+    //each thread's tree, under a frame naming the thread so they can be told apart
+    for (CallTree *tree = CallTree::First(); tree != NULL; tree = tree->Next())
+    {
+        buffer1024 path;
+        path.Append("thread ").AppendInt(tree->ThreadId());
+        ProfilerFoldChildren(file, tree->Root(), path);
+    }
+
+    //done
+    IFBREAKCONTEXT(file.Close() == false);
+    return true;
+#else
+    //there's no call tree in this build
+    return false;
+#endif
+}
+
+bool ProfilerImpl::Report(int32 numLines, Context &caller)
+{
+    CONTEXT_CALLED();
+
+#if defined(__CONFIG_CALL_TREE)
+    IFBREAKCONTEXT(numLines <= 0);
+
+    //we need the length of a cycle
+    double microsecondsPerCycle = ProfilerMicrosecondsPerCycle();
+    IFBREAKCONTEXTMSG(microsecondsPerCycle == 0.0, "the timer hasn't measured the cpu speed");
+
+    //find the call paths with the most time of their own, in every thread
+    ArrayValueSorted<ProfilerLine> lines;
+    for (CallTree *tree = CallTree::First(); tree != NULL; tree = tree->Next())
+    {
+        ProfilerReportChildren(tree->Root(), lines, numLines, ProfilerCompareExclusive);
+    }
+
+    //heading
+    OutputDebugStringA("call tree, most exclusive time first:\n");
+
+    //a line for each, naming it and its caller
+    for (int32 i = 0, num = lines.Num(); i < num; i++)
+    {
+        ProfilerLine const *record = lines.Get(i);
+        buffer256 name;
+        ProfilerName(record->node->Spot(), name);
+        buffer256 callerName;
+        CallNode *parent = record->node->Parent();
+        if (parent->Spot() != NULL)
+        {
+            ProfilerName(parent->Spot(), callerName);
+        }
+        else
+        {
+            callerName = "thread root";
+        }
+
+        buffer1024 line;
+        line.Append("  ").AppendFloat(record->exclusive * microsecondsPerCycle / 1000.0, 3, 10).Append(" ms exclusive");
+        line.Append(", ").AppendFloat(record->inclusive * microsecondsPerCycle / 1000.0, 3, 10).Append(" ms inclusive");
+        line.Append(", ").AppendInt(record->node->NumCalls(), 8).Append(" calls: ");
+        line.Append(name).Append(" from ").Append(callerName).Append('\n');
+        OutputDebugStringA(line);
+    }
+    return true;
+#else
+    //there's no call tree in this build
+    return false;
+#endif
+}
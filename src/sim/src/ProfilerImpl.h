@@ -0,0 +1,33 @@
+//
+// v1 - Prototype character/item/tradeskill game.
+// Copyright (C) 2013 Adam Hayek (adam.hayek@gmail.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see [http://www.gnu.org/licenses/].
+//
+
+#pragma once
+
+#include "sim\IProfiler.h"
+
+//our implementation of IProfiler
+class ProfilerImpl InterfaceSealed : public IProfiler
+{
+public:
+    InterfaceImplementation(ProfilerImpl);
+
+    //from IProfiler
+    bool WriteChromeTrace(char const *fileName, Context &caller);
+    bool WriteFoldedStacks(char const *fileName, Context &caller);
+    bool Report(int32 numLines, Context &caller);
+};
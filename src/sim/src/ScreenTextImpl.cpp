@@ -18,31 +18,7 @@
 
 #include "pch.h"
 #include <SFML\Graphics.hpp>
-#include "sim\IScreenText.h"
-
-
-//our implementation of IScreenText
-class ScreenTextImpl : public IScreenText
-{
-public:
-    InterfaceImplementation(ScreenTextImpl);
-
-    ScreenTextImpl();
-
-    //from IScreenText
-    bool Startup(Context &caller);
-    bool RenderText(sf::RenderWindow *window, Context &caller);
-    bool PrintLineTopLeft(wchar const *text, Context &caller);
-
-    //text strings we show on top left
-    ArrayPointerOwner<ubuffer256> topLeft;
-
-    //spare text strings
-    ArrayPointerOwner<ubuffer256> spares;
-
-    //our font
-    sf::Font *font;
-};
+#include "sim\src\ScreenTextImpl.h"
 
 //instantiate and register our implementation
 InterfaceCreate(ScreenTextImpl, screenTextImpl, IScreenText, default);
@@ -54,6 +30,18 @@ InterfaceCreate(ScreenTextImpl, screenTextImpl, IScreenText, default);
 ScreenTextImpl::ScreenTextImpl()
 {
     font = null;
+
+    //name our queue in the array stats report
+    ARRAY_STATS_PLACE(topLeft);
+}
+
+ScreenTextImpl::~ScreenTextImpl()
+{
+    //give back any strings we never drew
+    while (topLeft.Num() > 0)
+    {
+        stringPool.Release(topLeft.PopFront());
+    }
 }
 
 bool ScreenTextImpl::Startup(Context &caller)
@@ -125,14 +113,14 @@ bool ScreenTextImpl::RenderText(sf::RenderWindow *window, Context &caller)
             y += 12 + 0;
         }
 
-        //remove all our strings back to the spare pool
+        //remove all our strings back to the pool
         while (topLeft.Num() > 0)
         {
-            //remove one
-            ubuffer256 *str = topLeft.Remove(0);
+            //remove the oldest one
+            ubuffer256 *str = topLeft.PopFront();
 
-            //put it in spare pool
-            spares.Add(str);
+            //give it back
+            stringPool.Release(str);
         }
     }
 
@@ -145,20 +133,9 @@ bool ScreenTextImpl::PrintLineTopLeft(wchar const *text, Context &caller)
     CONTEXT_CALLED();
     IFBREAKCONTEXT(text == null);
 
-    //string we will store the text in
-    ubuffer256 *str = null;
-
-    //check if we have a string already allocated
-    if (spares.Num() > 0)
-    {
-        //get one out
-        str = spares.Remove(0);
-    }
-    else
-    {
-        //create a new one
-        str = new ubuffer256();
-    }
+    //get a string to store the text in
+    ubuffer256 *str = stringPool.Acquire();
+    IFBREAKCONTEXT(str == null);
 
     //add the string to our list
     topLeft.Add(str);
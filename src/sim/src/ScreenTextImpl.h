@@ -0,0 +1,51 @@
+//
+// v1 - Prototype character/item/tradeskill game.
+// Copyright (C) 2013 Adam Hayek (adam.hayek@gmail.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see [http://www.gnu.org/licenses/].
+//
+
+#pragma once
+
+#include "common\global\ObjectPool.h"
+#include "sim\IScreenText.h"
+
+namespace sf
+{
+    class Font;
+}
+
+//our implementation of IScreenText
+class ScreenTextImpl InterfaceSealed : public IScreenText
+{
+public:
+    InterfaceImplementation(ScreenTextImpl);
+
+    ScreenTextImpl();
+    ~ScreenTextImpl();
+
+    //from IScreenText
+    bool Startup(Context &caller);
+    bool RenderText(sf::RenderWindow *window, Context &caller);
+    bool PrintLineTopLeft(wchar const *text, Context &caller);
+
+    //text strings we show on top left, they belong to stringPool
+    ArrayPointerQueue<ubuffer256> topLeft;
+
+    //where our text strings come from and go back to
+    ObjectPool<ubuffer256> stringPool;
+
+    //our font
+    sf::Font *font;
+};
@@ -0,0 +1,43 @@
+//
+// v1 - Prototype character/item/tradeskill game.
+// Copyright (C) 2013 Adam Hayek (adam.hayek@gmail.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see [http://www.gnu.org/licenses/].
+//
+
+
+#pragma once
+
+//
+//The implementations of the sim interfaces linked in static interface builds, see IBase.h.  This
+//is kept out of the interface headers so they never pull in implementation classes.  Only a file
+//which declares an InterfacePointer to one of these interfaces includes it, before the
+//declaration.  Without __CONFIG_STATIC_INTERFACES it's empty.
+//
+
+#if defined(__CONFIG_STATIC_INTERFACES)
+
+#include "sim\src\FrameRateImpl.h"
+InterfaceStatic(IFrameRate, default, FrameRateImpl);
+
+#include "sim\src\ProfilerImpl.h"
+InterfaceStatic(IProfiler, default, ProfilerImpl);
+
+#include "sim\src\ScreenTextImpl.h"
+InterfaceStatic(IScreenText, default, ScreenTextImpl);
+
+#include "sim\win32\TimeImpl.h"
+InterfaceStatic(ITime, default, TimeImpl);
+
+#endif
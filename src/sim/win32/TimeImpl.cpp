@@ -17,56 +17,7 @@
 //
 
 #include "pch.h"
-#include "sim\ITime.h"
-
-
-//ITime implementation
-class TimeImpl : public ITime
-{
-public:
-    InterfaceImplementation(TimeImpl);
-
-    TimeImpl();
-
-    //ITime functions.
-    bool Startup(Context &caller);
-    void UpdateTime();
-    float FrameTime();
-    float AppTime();
-    float CyclesSeconds(int64 cycleCount);
-
-    //cpu tick when timer was initialized
-    int64 startupCpuTick;
-
-    //high res timer tick when initialized
-    int64 startupHighresTick;
-
-    //high res timer frequency
-    int64 highresTicksPerSecond;
-
-    //cpu frequency
-    int64 cpuTicksPerSecond;
-
-    //time of last query.
-    int64 lastFrameHighresTick;
-
-    //how much time went by in last frame, in seconds.
-    float lastFrameTimeSeconds;
-
-    //how much time has gone by since first init call.
-    float appTimeSeconds;
-
-    //true if we are done computing cpu speed.
-    bool haveComputedSpeed;
-
-    //
-    //Worker functions
-    //
-
-    //gets the initial tick and clock values
-    void InitBegin();
-    void InitUpdate();
-};
+#include "sim\win32\TimeImpl.h"
 
 //instantiate our implementation
 InterfaceCreate(TimeImpl, timeInst, ITime, default);
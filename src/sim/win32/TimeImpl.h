@@ -0,0 +1,69 @@
+//
+// v1 - Prototype character/item/tradeskill game.
+// Copyright (C) 2013 Adam Hayek (adam.hayek@gmail.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see [http://www.gnu.org/licenses/].
+//
+
+#pragma once
+
+#include "sim\ITime.h"
+
+//ITime implementation
+class TimeImpl InterfaceSealed : public ITime
+{
+public:
+    InterfaceImplementation(TimeImpl);
+
+    TimeImpl();
+
+    //ITime functions.
+    bool Startup(Context &caller);
+    void UpdateTime();
+    float FrameTime();
+    float AppTime();
+    float CyclesSeconds(int64 cycleCount);
+
+    //cpu tick when timer was initialized
+    int64 startupCpuTick;
+
+    //high res timer tick when initialized
+    int64 startupHighresTick;
+
+    //high res timer frequency
+    int64 highresTicksPerSecond;
+
+    //cpu frequency
+    int64 cpuTicksPerSecond;
+
+    //time of last query.
+    int64 lastFrameHighresTick;
+
+    //how much time went by in last frame, in seconds.
+    float lastFrameTimeSeconds;
+
+    //how much time has gone by since first init call.
+    float appTimeSeconds;
+
+    //true if we are done computing cpu speed.
+    bool haveComputedSpeed;
+
+    //
+    //Worker functions
+    //
+
+    //gets the initial tick and clock values
+    void InitBegin();
+    void InitUpdate();
+};
@@ -0,0 +1,51 @@
+//
+// v1 - Prototype character/item/tradeskill game.
+// Copyright (C) 2013 Adam Hayek (adam.hayek@gmail.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see [http://www.gnu.org/licenses/].
+//
+
+
+#pragma once
+
+#include "common\idb\IBase.h"
+
+//
+//The interfaces between the test program and testplugin.dll, which TestPlugin loads with
+//InterfaceLoadPlugins.  The DLL implements ITestPlugin, and references ITestPluginHost, which the
+//program implements, so references are checked in both directions.
+//
+
+//the name the DLL is built with, next to the test program
+#define TEST_PLUGIN_FILE "testplugin.dll"
+
+//what the DLL's implementation adds to a number, so the test can tell its calls went there
+#define TEST_PLUGIN_ADD 1000
+
+class ITestPlugin : public IBase
+{
+public:
+    //returns number plus TEST_PLUGIN_ADD
+    virtual int32 Add(int32 number) = 0;
+
+    //returns what ITestPluginHost::Value returns, or 0 if the DLL's reference to it isn't connected
+    virtual int32 HostValue() = 0;
+};
+
+class ITestPluginHost : public IBase
+{
+public:
+    //a number only the program knows
+    virtual int32 Value() = 0;
+};
@@ -0,0 +1,139 @@
+//
+// v1 - Prototype character/item/tradeskill game.
+// Copyright (C) 2013 Adam Hayek (adam.hayek@gmail.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see [http://www.gnu.org/licenses/].
+//
+
+
+#pragma once
+
+#include "common\global\global.h"
+
+//
+//Tests and benchmarks.  They are built by the Test configuration, which defines __CONFIG_TEST
+//and is otherwise the same as Release, so the benchmarks time the code the game ships with.  In
+//that build the game runs them instead of opening its window, writes their results with
+//OutputDebugString, and exits with the number of checks which failed.  In the other builds
+//nothing here is compiled.
+//
+//A test checks its results with TEST_CHECK.  A benchmark times a loop with TestClock, passes
+//what the loop computed to TestKeep so the optimizer can't remove it, and writes the time with
+//TestReport.
+//
+//  TestClock clock;
+//  for (int32 i = 0; i < num; i++)
+//  {
+//      total += array.Find(keys[i]) != NULL;
+//  }
+//  TestKeep(total);
+//  TestReport("  find: %.1f ns\n", clock.Nanoseconds() / num);
+//
+//Each file of tests has one function, which TestRun calls.
+//
+#if defined(__CONFIG_TEST)
+
+//checks that exp is true, counting and reporting a failure if it isn't
+#define TEST_CHECK(exp) TestCheck((exp) != false, __FILE__, __LINE__, #exp)
+
+//counts a check, and reports it if it failed.  Returns passed.
+bool TestCheck(bool passed, char const *file, int32 line, char const *expression);
+
+//writes a line of results
+void TestReport(char const *formatString, ...);
+
+//keeps the optimizer from removing the work of a benchmark
+void TestKeep(int64 value);
+
+//runs every test and benchmark.  Returns the number of checks which failed.
+int32 TestRun();
+
+//times a benchmark with the performance counter
+class TestClock
+{
+public:
+    //starts timing
+    TestClock();
+
+    //starts again
+    void Restart();
+
+    //nanoseconds since the clock was made or restarted
+    double Nanoseconds() const;
+
+private:
+    //the performance counter when we started
+    int64 start;
+};
+
+//a fast repeatable random number generator for making test data
+class TestRandom
+{
+public:
+    inline TestRandom(uint32 seed = 1);
+
+    //the next number
+    inline uint32 Next();
+
+    //a number from 0 to range - 1
+    inline uint32 Next(uint32 range);
+
+private:
+    uint32 state;
+};
+
+//
+//the tests, one function per file
+//
+void TestArrayValue();
+void TestArrayHashed();
+void TestArrayTree();
+void TestArrayFrozen();
+void TestArrayQueue();
+void TestPointerSearch();
+void TestStringBuffer();
+void TestUtf();
+void TestContext();
+void TestSlotMap();
+void TestAtom();
+void TestObjectPool();
+void TestInterfaceLocal();
+void TestPlugin();
+
+
+//
+//TestRandom inline functions
+//
+
+inline TestRandom::TestRandom(uint32 seed)
+{
+    //xorshift can't start at 0
+    state = (seed != 0) ? seed : 1;
+}
+
+inline uint32 TestRandom::Next()
+{
+    //xorshift32
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+inline uint32 TestRandom::Next(uint32 range)
+{
+    return uint32((uint64(Next()) * range) >> 32);
+}
+
+#endif
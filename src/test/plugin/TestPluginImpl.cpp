@@ -0,0 +1,53 @@
+//
+// v1 - Prototype character/item/tradeskill game.
+// Copyright (C) 2013 Adam Hayek (adam.hayek@gmail.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see [http://www.gnu.org/licenses/].
+//
+
+
+#include <windows.h>
+#include "common\global\global.h"
+#include "test\ITestPlugin.h"
+
+#if defined(__CONFIG_TEST)
+
+//
+//The implementation in testplugin.dll.  It isn't linked into the test program, which only finds
+//it by loading the DLL.
+//
+
+static ITestPluginHost *testPluginHost = NULL;
+InterfaceReference(testPluginHost, ITestPluginHost, default);
+
+class TestPluginImpl : public ITestPlugin
+{
+public:
+    InterfaceImplementation(TestPluginImpl);
+
+    //from ITestPlugin
+    int32 Add(int32 number)
+    {
+        return number + TEST_PLUGIN_ADD;
+    }
+
+    int32 HostValue()
+    {
+        return (testPluginHost != NULL) ? testPluginHost->Value() : 0;
+    }
+};
+
+InterfaceCreate(TestPluginImpl, testPluginImpl, ITestPlugin, default);
+
+#endif
@@ -0,0 +1,135 @@
+//
+// v1 - Prototype character/item/tradeskill game.
+// Copyright (C) 2013 Adam Hayek (adam.hayek@gmail.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see [http://www.gnu.org/licenses/].
+//
+
+
+#include <windows.h>
+#include <stdarg.h>
+#include "common\global\global.h"
+#include "test\Test.h"
+
+#if defined(__CONFIG_TEST)
+
+//
+//local data
+//
+
+//number of checks made, and how many failed
+static int32 testNumChecks = 0;
+static int32 testNumFailed = 0;
+
+//where TestKeep puts values, volatile so the stores can't be removed
+static int64 volatile testKept = 0;
+
+//performance counter ticks per second, once a clock has been made
+static double testFrequency = 0.0;
+
+
+//
+//global functions
+//
+
+bool TestCheck(bool passed, char const *file, int32 line, char const *expression)
+{
+    //count it
+    testNumChecks++;
+    if (passed)
+    {
+        return true;
+    }
+
+    //report the failure, and stop in the debugger
+    testNumFailed++;
+    TestReport("%s(%d): failed: %s\n", file, line, expression);
+    BREAK1();
+    return false;
+}
+
+void TestReport(char const *formatString, ...)
+{
+    //format it
+    buffer512 line;
+    va_list args;
+    va_start(args, formatString);
+    line.Sprintf(formatString, args);
+    va_end(args);
+
+    //and write it
+    OutputDebugStringA(line);
+}
+
+void TestKeep(int64 value)
+{
+    testKept += value;
+}
+
+int32 TestRun()
+{
+    //every test file
+    TestArrayValue();
+    TestArrayHashed();
+    TestArrayTree();
+    TestArrayFrozen();
+    TestArrayQueue();
+    TestPointerSearch();
+    TestStringBuffer();
+    TestUtf();
+    TestContext();
+    TestSlotMap();
+    TestAtom();
+    TestObjectPool();
+    TestInterfaceLocal();
+    TestPlugin();
+
+    //the totals
+    TestReport("tests: %d checks, %d failed\n", testNumChecks, testNumFailed);
+    return testNumFailed;
+}
+
+
+//
+//TestClock functions
+//
+
+TestClock::TestClock()
+{
+    Restart();
+}
+
+void TestClock::Restart()
+{
+    //the clock's units, the first time
+    if (testFrequency == 0.0)
+    {
+        LARGE_INTEGER frequency;
+        QueryPerformanceFrequency(&frequency);
+        testFrequency = double(frequency.QuadPart);
+    }
+
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    start = now.QuadPart;
+}
+
+double TestClock::Nanoseconds() const
+{
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    return double(now.QuadPart - start) * 1e9 / testFrequency;
+}
+
+#endif
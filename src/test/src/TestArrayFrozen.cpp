@@ -0,0 +1,178 @@
+//
+// v1 - Prototype character/item/tradeskill game.
+// Copyright (C) 2013 Adam Hayek (adam.hayek@gmail.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see [http://www.gnu.org/licenses/].
+//
+
+
+
+#include <windows.h>
+#include "common\global\global.h"
+#include "common\global\ArrayPointer.h"
+#include "common\global\ArrayFrozen.h"
+#include "test\Test.h"
+
+#if defined(__CONFIG_TEST)
+
+//largest array checked at every size, and a few bigger sizes which aren't powers of two
+#define TEST_FROZEN_SIZES 300
+#define TEST_FROZEN_BIG_SIZES 4
+
+//number of keys in the array the finds are timed on
+#define TEST_FROZEN_NUM 1000000
+
+//
+//local classes
+//
+
+//an item with a number key.  Ids are even and from 2, so the odd numbers around them are never found.
+class TestFrozenItem
+{
+public:
+    uint32 id;
+
+    SortedArrayFunctions(Compare, Find, TestFrozenItem, uint32, id);
+};
+
+SortedArrayKeyFuncMember(TestFrozenKey, uint32, TestFrozenItem, id);
+
+
+//
+//local functions
+//
+
+//checks every present and missing id in an array of num items against a plain binary search
+static void TestArrayFrozenSize(TestFrozenItem *items, int32 num)
+{
+    //add them in a scrambled order so AddBatch has to sort them
+    TestFrozenItem **pointers = new TestFrozenItem *[num + 1];
+    for (int32 i = 0; i < num; i++)
+    {
+        items[i].id = uint32(i + 1) * 2;
+        pointers[(i * 7919) % num] = &items[i];
+    }
+    ArraySorted<TestFrozenItem> sorted;
+    sorted.AddBatch(pointers, num, TestFrozenItem::Compare);
+
+    //what Find returns before freezing, for each id from 1 to one past the last
+    int32 numIds = num * 2 + 2;
+    TestFrozenItem **expected = new TestFrozenItem *[numIds + 1];
+    for (int32 id = 1; id <= numIds; id++)
+    {
+        expected[id] = sorted.Find(uint32(id), TestFrozenItem::Find);
+    }
+
+    //frozen ArraySorted by id and by item, and ArrayFrozen
+    TestFrozenItem probe;
+    bool same = sorted.Freeze() && sorted.IsFrozen() == (num > 0);
+    ArrayFrozen<uint32, TestFrozenItem> frozen;
+    same &= frozen.Build(sorted, TestFrozenKey) && frozen.Num() == num;
+    for (int32 id = 1; id <= numIds; id++)
+    {
+        probe.id = uint32(id);
+        same &= sorted.Find(uint32(id), TestFrozenItem::Find) == expected[id];
+        same &= sorted.Find(&probe, TestFrozenItem::Compare) == expected[id];
+        same &= frozen.Find(uint32(id)) == expected[id];
+        same &= (expected[id] != NULL) == (id % 2 == 0 && id <= num * 2);
+    }
+    if (!TEST_CHECK(same))
+    {
+        TestReport("  frozen lookups differ from Find with %d items\n", num);
+    }
+
+    //changing the array thaws it
+    if (num > 0)
+    {
+        sorted.Remove(uint32(2), TestFrozenItem::Find);
+        TEST_CHECK(!sorted.IsFrozen() && sorted.Find(uint32(2), TestFrozenItem::Find) == NULL);
+    }
+
+    delca(expected);
+    delca(pointers);
+}
+
+
+//
+//global functions
+//
+
+void TestArrayFrozen()
+{
+    //every size up to a few full levels of the tree, and some bigger ones
+    static int32 const bigSizes[TEST_FROZEN_BIG_SIZES] = {1000, 4095, 4097, 100003};
+    TestFrozenItem *items = new TestFrozenItem[TEST_FROZEN_NUM];
+    for (int32 num = 0; num <= TEST_FROZEN_SIZES; num++)
+    {
+        TestArrayFrozenSize(items, num);
+    }
+    for (int32 i = 0; i < TEST_FROZEN_BIG_SIZES; i++)
+    {
+        TestArrayFrozenSize(items, bigSizes[i]);
+    }
+
+    //a big table whose items aren't next to their neighbours in memory, like separately allocated
+    //items, and the ids to find in random order, half of them missing
+    TestRandom random;
+    TestFrozenItem **pointers = new TestFrozenItem *[TEST_FROZEN_NUM];
+    uint32 *ids = new uint32[TEST_FROZEN_NUM];
+    for (int32 i = 0; i < TEST_FROZEN_NUM; i++)
+    {
+        items[i].id = uint32((int64(i) * 7919) % TEST_FROZEN_NUM + 1) * 2;
+        pointers[i] = &items[i];
+        ids[i] = random.Next(TEST_FROZEN_NUM * 2) + 1;
+    }
+    ArraySorted<TestFrozenItem> sorted;
+    sorted.AddBatch(pointers, TEST_FROZEN_NUM, TestFrozenItem::Compare);
+    TestReport("ArraySorted Find against frozen searches, %d keys, ns per find:\n", TEST_FROZEN_NUM);
+
+    //binary search
+    int64 found = 0;
+    TestClock clock;
+    for (int32 i = 0; i < TEST_FROZEN_NUM; i++)
+    {
+        found += sorted.Find(ids[i], TestFrozenItem::Find) != NULL;
+    }
+    double sortedTime = clock.Nanoseconds() / TEST_FROZEN_NUM;
+
+    //frozen copy of the item pointers
+    int64 frozenFound = 0;
+    TEST_CHECK(sorted.Freeze());
+    clock.Restart();
+    for (int32 i = 0; i < TEST_FROZEN_NUM; i++)
+    {
+        frozenFound += sorted.Find(ids[i], TestFrozenItem::Find) != NULL;
+    }
+    double frozenTime = clock.Nanoseconds() / TEST_FROZEN_NUM;
+    TEST_CHECK(frozenFound == found);
+
+    //frozen keys
+    ArrayFrozen<uint32, TestFrozenItem> frozen;
+    TEST_CHECK(frozen.Build(sorted, TestFrozenKey));
+    frozenFound = 0;
+    clock.Restart();
+    for (int32 i = 0; i < TEST_FROZEN_NUM; i++)
+    {
+        frozenFound += frozen.Find(ids[i]) != NULL;
+    }
+    double keysTime = clock.Nanoseconds() / TEST_FROZEN_NUM;
+    TEST_CHECK(frozenFound == found);
+    TestReport("  find: ArraySorted %6.1f, Freeze %6.1f, ArrayFrozen %6.1f\n", sortedTime, frozenTime, keysTime);
+
+    delca(ids);
+    delca(pointers);
+    delca(items);
+}
+
+#endif
@@ -0,0 +1,170 @@
+//
+// v1 - Prototype character/item/tradeskill game.
+// Copyright (C) 2013 Adam Hayek (adam.hayek@gmail.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see [http://www.gnu.org/licenses/].
+//
+
+
+#include <windows.h>
+#include "common\global\global.h"
+#include "common\global\ArrayPointer.h"
+#include "common\global\ArrayHashed.h"
+#include "test\Test.h"
+
+#if defined(__CONFIG_TEST)
+
+//number of lookups timed at each size
+#define TEST_HASHED_FINDS 1000000
+
+//
+//local classes
+//
+
+//an item with a number key and a string key
+class TestKeyed
+{
+public:
+    uint32 id;
+    char name[16];
+
+    SortedArrayFunctions(CompareId, FindId, TestKeyed, uint32, id);
+    SortedArrayFunctions(CompareName, FindName, TestKeyed, char const *, name);
+};
+
+
+//
+//local functions
+//
+
+//times finding random items by number, then by string, in a sorted and a hashed array of num items
+static void TestArrayHashedFind(int32 num)
+{
+    //make the items.  Multiplying by an odd number gives every index a different id, and
+    //ArraySorted's Find doesn't take 0.
+    TestKeyed *items = new TestKeyed[num];
+    TestKeyed **pointers = new TestKeyed *[num];
+    for (int32 i = 0; i < num; i++)
+    {
+        items[i].id = uint32(i + 1) * 2654435761u;
+        memcpy(items[i].name, "item", 4);
+        items[i].name[4 + StringFormatInt(items[i].id, &items[i].name[4])] = '\0';
+        pointers[i] = &items[i];
+    }
+
+    //which ones we look for
+    TestRandom random(num);
+    TestKeyed **finds = new TestKeyed *[TEST_HASHED_FINDS];
+    for (int32 i = 0; i < TEST_HASHED_FINDS; i++)
+    {
+        finds[i] = &items[random.Next(num)];
+    }
+
+    //by number
+    {
+        //put them in both arrays
+        ArraySorted<TestKeyed> sorted;
+        sorted.AddBatch(pointers, num, TestKeyed::CompareId);
+        ArrayHashed<uint32, TestKeyed> hashed;
+        hashed.Reserve(num);
+        for (int32 i = 0; i < num; i++)
+        {
+            hashed.Add(items[i].id, &items[i]);
+        }
+        TEST_CHECK(sorted.Num() == num && hashed.Num() == num);
+
+        //time the sorted array
+        int64 found = 0;
+        TestClock clock;
+        for (int32 i = 0; i < TEST_HASHED_FINDS; i++)
+        {
+            found += sorted.Find(finds[i]->id, TestKeyed::FindId) == finds[i];
+        }
+        double sortedTime = clock.Nanoseconds() / TEST_HASHED_FINDS;
+        TEST_CHECK(found == TEST_HASHED_FINDS);
+        TestKeep(found);
+
+        //and the hashed one
+        found = 0;
+        clock.Restart();
+        for (int32 i = 0; i < TEST_HASHED_FINDS; i++)
+        {
+            found += hashed.Find(finds[i]->id) == finds[i];
+        }
+        double hashedTime = clock.Nanoseconds() / TEST_HASHED_FINDS;
+        TEST_CHECK(found == TEST_HASHED_FINDS);
+        TestKeep(found);
+
+        TestReport("  %7d uint32 keys: ArraySorted %6.1f ns, ArrayHashed %6.1f ns, %4.1fx\n", num, sortedTime, hashedTime, sortedTime / hashedTime);
+    }
+
+    //by string
+    {
+        //put them in both arrays
+        ArraySorted<TestKeyed> sorted;
+        sorted.AddBatch(pointers, num, TestKeyed::CompareName);
+        ArrayHashed<char const *, TestKeyed> hashed;
+        hashed.Reserve(num);
+        for (int32 i = 0; i < num; i++)
+        {
+            hashed.Add(items[i].name, &items[i]);
+        }
+        TEST_CHECK(sorted.Num() == num && hashed.Num() == num);
+
+        //time the sorted array
+        int64 found = 0;
+        TestClock clock;
+        for (int32 i = 0; i < TEST_HASHED_FINDS; i++)
+        {
+            found += sorted.Find(finds[i]->name, TestKeyed::FindName) == finds[i];
+        }
+        double sortedTime = clock.Nanoseconds() / TEST_HASHED_FINDS;
+        TEST_CHECK(found == TEST_HASHED_FINDS);
+        TestKeep(found);
+
+        //and the hashed one
+        found = 0;
+        clock.Restart();
+        for (int32 i = 0; i < TEST_HASHED_FINDS; i++)
+        {
+            found += hashed.Find(finds[i]->name) == finds[i];
+        }
+        double hashedTime = clock.Nanoseconds() / TEST_HASHED_FINDS;
+        TEST_CHECK(found == TEST_HASHED_FINDS);
+        TestKeep(found);
+
+        TestReport("  %7d string keys: ArraySorted %6.1f ns, ArrayHashed %6.1f ns, %4.1fx\n", num, sortedTime, hashedTime, sortedTime / hashedTime);
+    }
+
+    delca(finds);
+    delca(pointers);
+    delca(items);
+}
+
+
+//
+//global functions
+//
+
+void TestArrayHashed()
+{
+    //find, 10^2 to 10^6 items
+    TestReport("ArrayHashed find, %d random hits:\n", TEST_HASHED_FINDS);
+    for (int32 num = 100; num <= 1000000; num *= 10)
+    {
+        TestArrayHashedFind(num);
+    }
+}
+
+#endif
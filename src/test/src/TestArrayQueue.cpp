@@ -0,0 +1,205 @@
+//
+// v1 - Prototype character/item/tradeskill game.
+// Copyright (C) 2013 Adam Hayek (adam.hayek@gmail.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see [http://www.gnu.org/licenses/].
+//
+
+
+
+#include <windows.h>
+#include "common\global\global.h"
+#include "common\global\ArrayPointer.h"
+#include "test\Test.h"
+
+#if defined(__CONFIG_TEST)
+
+//number of random pushes, pops and removes checked against the plain array
+#define TEST_QUEUE_STEPS 100000
+
+//the most items in the queue at once, the queue grows past it a few times while wrapped
+#define TEST_QUEUE_MAX 200
+
+//
+//local functions
+//
+
+//returns true if the queue holds the same items in the same order as the plain array
+static bool TestQueueSame(ArrayPointerQueue<int32> &queue, int32 *const *model, int32 modelNum)
+{
+    //by index
+    bool same = queue.Num() == modelNum;
+    for (int32 i = 0; same && i < modelNum; i++)
+    {
+        same = queue.Get(i) == model[i];
+    }
+
+    //and with the iterators
+    int32 index = 0;
+    for (ArrayPointerQueue<int32>::iterator it = queue.begin(); same && it != queue.end(); ++it)
+    {
+        same = *it == model[index++];
+    }
+    return same && index == modelNum;
+}
+
+//returns true if the items of the queue wrap around the end of its pointer array
+static bool TestQueueWrapped(ArrayPointerQueue<int32> &queue)
+{
+    return queue.Num() > 1 && &queue[queue.Num() - 1] < &queue[0];
+}
+
+
+//
+//global functions
+//
+
+void TestArrayQueue()
+{
+    //the items, the ones not in the queue, and a plain array of the ones in it in queue order
+    int32 values[TEST_QUEUE_MAX];
+    int32 *freeItems[TEST_QUEUE_MAX];
+    int32 numFree = 0;
+    for (int32 i = 0; i < TEST_QUEUE_MAX; i++)
+    {
+        freeItems[numFree++] = &values[i];
+    }
+    int32 *model[TEST_QUEUE_MAX];
+    int32 modelNum = 0;
+    ArrayPointerQueue<int32> queue;
+
+    //what went wrong, and how often the cases we want to cover came up
+    TestRandom random(11);
+    int32 numWrong = 0;
+    int32 numWrapped = 0;
+    int32 numShiftedFront = 0;
+    int32 numShiftedBack = 0;
+    int32 numGrownWrapped = 0;
+    int32 numLinearized = 0;
+    for (int32 step = 0; step < TEST_QUEUE_STEPS; step++)
+    {
+        //pushes are a little more likely than pops and removes, so the queue fills up.  Now and then
+        //throw the queue's pointer array away so it grows again.
+        uint32 action = random.Next(16);
+        if (step % 5000 == 4999)
+        {
+            queue.Reset();
+            for (int32 i = 0; i < modelNum; i++)
+            {
+                freeItems[numFree++] = model[i];
+            }
+            modelNum = 0;
+            action = 16;
+        }
+        numWrapped += TestQueueWrapped(queue);
+
+        //push an item onto the back or the front
+        if (action < 8 && modelNum < TEST_QUEUE_MAX)
+        {
+            //take an item that isn't in the queue
+            int32 *item = freeItems[--numFree];
+
+            //the queue grows when it's full, which moves its first item.  Note if it was wrapped when it did.
+            bool wrapped = TestQueueWrapped(queue);
+            int32 *const *oldFirst = (modelNum > 0) ? &queue[0] : NULL;
+            if (action < 4)
+            {
+                queue.PushBack(item);
+                model[modelNum] = item;
+                numGrownWrapped += wrapped && &queue[0] != oldFirst;
+            }
+            else
+            {
+                queue.PushFront(item);
+                memmove(&model[1], &model[0], sizeof(int32 *) * modelNum);
+                model[0] = item;
+                numGrownWrapped += wrapped && &queue[1] != oldFirst;
+            }
+            modelNum++;
+        }
+
+        //pop the front item
+        else if (action < 10)
+        {
+            int32 *item = queue.PopFront();
+            numWrong += item != ((modelNum > 0) ? model[0] : NULL);
+            if (modelNum > 0)
+            {
+                freeItems[numFree++] = model[0];
+                modelNum--;
+                memmove(&model[0], &model[1], sizeof(int32 *) * modelNum);
+            }
+        }
+
+        //remove an item from anywhere by index, which moves whichever side of it is shorter
+        else if (action < 13 && modelNum > 0)
+        {
+            int32 index = int32(random.Next(modelNum));
+            int32 *const *before = (index > 0) ? &queue[index - 1] : NULL;
+            int32 *const *after = (index < modelNum - 1) ? &queue[index + 1] : NULL;
+            numWrong += queue.Remove(index) != model[index];
+            freeItems[numFree++] = model[index];
+            modelNum--;
+            memmove(&model[index], &model[index + 1], sizeof(int32 *) * (modelNum - index));
+
+            //the items after it stay where they were if it was in the first half, else the ones before it do
+            if (index < (modelNum + 1) / 2)
+            {
+                numWrong += after != NULL && &queue[index] != after;
+                numShiftedFront += after != NULL;
+            }
+            else
+            {
+                numWrong += before != NULL && &queue[index - 1] != before;
+                numShiftedBack += before != NULL;
+            }
+        }
+
+        //remove an item by its address
+        else if (action < 15 && modelNum > 0)
+        {
+            int32 index = int32(random.Next(modelNum));
+            int32 *item = model[index];
+            numWrong += queue.Remove(item) != item;
+            freeItems[numFree++] = item;
+            modelNum--;
+            memmove(&model[index], &model[index + 1], sizeof(int32 *) * (modelNum - index));
+            numWrong += queue.Remove(item) != NULL;
+        }
+
+        //get all of the items as one array, which moves them if they wrap around
+        else if (action < 16)
+        {
+            bool wrapped = TestQueueWrapped(queue);
+            int32 const *const *array = queue.Array();
+            numLinearized += wrapped;
+            numWrong += wrapped && TestQueueWrapped(queue);
+            for (int32 i = 0; i < modelNum; i++)
+            {
+                numWrong += array[i] != model[i];
+            }
+        }
+
+        //the whole queue still matches
+        numWrong += !TestQueueSame(queue, model, modelNum);
+        numWrong += modelNum > 0 && queue.IndexOf(model[modelNum - 1]) != modelNum - 1;
+    }
+    TEST_CHECK(numWrong == 0);
+
+    //every case came up
+    TEST_CHECK(numWrapped > 0 && numGrownWrapped > 0 && numLinearized > 0);
+    TEST_CHECK(numShiftedFront > 0 && numShiftedBack > 0);
+}
+
+#endif
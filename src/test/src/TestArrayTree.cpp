@@ -0,0 +1,167 @@
+//
+// v1 - Prototype character/item/tradeskill game.
+// Copyright (C) 2013 Adam Hayek (adam.hayek@gmail.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see [http://www.gnu.org/licenses/].
+//
+
+
+#include <windows.h>
+#include "common\global\global.h"
+#include "common\global\ArrayPointer.h"
+#include "common\global\ArrayTree.h"
+#include "test\Test.h"
+
+#if defined(__CONFIG_TEST)
+
+//number of keys in the arrays
+#define TEST_TREE_NUM 1000000
+
+//number of adds and removes timed once the arrays are full, ArraySorted's are slow
+#define TEST_TREE_CHANGES 10000
+
+//
+//local classes
+//
+
+//an item with a number key
+class TestTreeItem
+{
+public:
+    uint32 id;
+
+    SortedArrayFunctions(Compare, Find, TestTreeItem, uint32, id);
+};
+
+
+//
+//global functions
+//
+
+void TestArrayTree()
+{
+    //make the items in random order, ids from 1 since ArraySorted's Find doesn't take 0
+    TestRandom random;
+    TestTreeItem *items = new TestTreeItem[TEST_TREE_NUM + TEST_TREE_CHANGES];
+    TestTreeItem **pointers = new TestTreeItem *[TEST_TREE_NUM];
+    for (int32 i = 0; i < TEST_TREE_NUM + TEST_TREE_CHANGES; i++)
+    {
+        items[i].id = uint32(i + 1) * 2654435761u;
+    }
+    for (int32 i = 0; i < TEST_TREE_NUM; i++)
+    {
+        pointers[i] = &items[i];
+    }
+    TestReport("ArrayTree against ArraySorted, %d keys, ns per item:\n", TEST_TREE_NUM);
+
+    //building them, ArraySorted sorts them all at once since adding them one at a time is O(n^2)
+    ArraySorted<TestTreeItem> sorted;
+    TestClock clock;
+    sorted.AddBatch(pointers, TEST_TREE_NUM, TestTreeItem::Compare);
+    double sortedTime = clock.Nanoseconds() / TEST_TREE_NUM;
+    ArrayTree<TestTreeItem> tree;
+    clock.Restart();
+    for (int32 i = 0; i < TEST_TREE_NUM; i++)
+    {
+        tree.Add(pointers[i], TestTreeItem::Compare);
+    }
+    double treeTime = clock.Nanoseconds() / TEST_TREE_NUM;
+    TEST_CHECK(sorted.Num() == TEST_TREE_NUM && tree.Num() == TEST_TREE_NUM);
+    TestReport("  build: ArraySorted AddBatch %6.1f, ArrayTree Add %6.1f\n", sortedTime, treeTime);
+
+    //find
+    int64 found = 0;
+    clock.Restart();
+    for (int32 i = 0; i < TEST_TREE_NUM; i++)
+    {
+        found += sorted.Find(pointers[i]->id, TestTreeItem::Find) == pointers[i];
+    }
+    sortedTime = clock.Nanoseconds() / TEST_TREE_NUM;
+    TEST_CHECK(found == TEST_TREE_NUM);
+    found = 0;
+    clock.Restart();
+    for (int32 i = 0; i < TEST_TREE_NUM; i++)
+    {
+        found += tree.Find(pointers[i]->id, TestTreeItem::Find) == pointers[i];
+    }
+    treeTime = clock.Nanoseconds() / TEST_TREE_NUM;
+    TEST_CHECK(found == TEST_TREE_NUM);
+    TestReport("  find: ArraySorted %6.1f, ArrayTree %6.1f\n", sortedTime, treeTime);
+
+    //walking them in order
+    bool same = true;
+    int32 index = 0;
+    for (ArrayTree<TestTreeItem>::iterator it = tree.begin(); it != tree.end(); ++it)
+    {
+        same &= *it == sorted.Get(index++);
+    }
+    TEST_CHECK(same && index == TEST_TREE_NUM);
+    int64 total = 0;
+    clock.Restart();
+    for (int32 i = 0; i < TEST_TREE_NUM; i++)
+    {
+        total += sorted.Get(i)->id;
+    }
+    sortedTime = clock.Nanoseconds() / TEST_TREE_NUM;
+    TestKeep(total);
+    total = 0;
+    clock.Restart();
+    for (ArrayTree<TestTreeItem>::iterator it = tree.begin(); it != tree.end(); ++it)
+    {
+        total += (*it)->id;
+    }
+    treeTime = clock.Nanoseconds() / TEST_TREE_NUM;
+    TestKeep(total);
+    TestReport("  walk in order: ArraySorted %6.1f, ArrayTree %6.1f\n", sortedTime, treeTime);
+
+    //rank and select, which ArraySorted can only do with a search or an index
+    TestRandom picks(7);
+    same = true;
+    clock.Restart();
+    for (int32 i = 0; i < TEST_TREE_NUM; i++)
+    {
+        int32 pick = int32(picks.Next(TEST_TREE_NUM));
+        same &= tree.Rank(tree.Get(pick)->id, TestTreeItem::Find) == pick;
+    }
+    treeTime = clock.Nanoseconds() / TEST_TREE_NUM;
+    TEST_CHECK(same);
+    TestReport("  ArrayTree Get then Rank: %6.1f\n", treeTime);
+
+    //adds and removes, each keeping the arrays full
+    int64 changed = 0;
+    clock.Restart();
+    for (int32 i = 0; i < TEST_TREE_CHANGES; i++)
+    {
+        changed += sorted.Add(&items[TEST_TREE_NUM + i], TestTreeItem::Compare);
+        changed += sorted.Remove(pointers[i]->id, TestTreeItem::Find) == pointers[i];
+    }
+    sortedTime = clock.Nanoseconds() / (TEST_TREE_CHANGES * 2);
+    TEST_CHECK(changed == TEST_TREE_CHANGES * 2);
+    changed = 0;
+    clock.Restart();
+    for (int32 i = 0; i < TEST_TREE_CHANGES; i++)
+    {
+        changed += tree.Add(&items[TEST_TREE_NUM + i], TestTreeItem::Compare);
+        changed += tree.Remove(pointers[i]->id, TestTreeItem::Find) == pointers[i];
+    }
+    treeTime = clock.Nanoseconds() / (TEST_TREE_CHANGES * 2);
+    TEST_CHECK(changed == TEST_TREE_CHANGES * 2);
+    TEST_CHECK(sorted.Num() == TEST_TREE_NUM && tree.Num() == TEST_TREE_NUM);
+    TestReport("  add and remove: ArraySorted %6.1f, ArrayTree %6.1f\n", sortedTime, treeTime);
+
+    delca(pointers);
+    delca(items);
+}
+
+#endif
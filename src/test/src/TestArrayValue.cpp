@@ -0,0 +1,148 @@
+//
+// v1 - Prototype character/item/tradeskill game.
+// Copyright (C) 2013 Adam Hayek (adam.hayek@gmail.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see [http://www.gnu.org/licenses/].
+//
+
+
+#include <windows.h>
+#include "common\global\global.h"
+#include "common\global\ArrayValue.h"
+#include "test\Test.h"
+
+#if defined(__CONFIG_TEST)
+
+//
+//local classes
+//
+
+//an item which owns memory, so using one after the array has freed it shows up under a checker
+class TestValue
+{
+public:
+    TestValue(int32 value)
+    {
+        this->value = new int32(value);
+    }
+    TestValue(TestValue const &other)
+    {
+        value = new int32(*other.value);
+    }
+    ~TestValue()
+    {
+        delete value;
+    }
+
+    int32 Value() const
+    {
+        return *value;
+    }
+
+private:
+    TestValue &operator=(TestValue const &other);
+
+    int32 *value;
+};
+
+
+//
+//local functions
+//
+
+//sorts by value, equal values go after the ones already there
+static int32 TestValueCompare(TestValue const *item1, TestValue const *item2)
+{
+    return (item1->Value() < item2->Value()) ? -1 : 1;
+}
+
+//adds items of the array to itself, many of the adds growing the storage
+static void TestArrayValueSelf()
+{
+    //Add
+    ArrayValue<TestValue> array;
+    array.Add(TestValue(7));
+    for (int32 i = 1; i < 64; i++)
+    {
+        array.Add(*array.Get(i - 1));
+    }
+    bool same = true;
+    for (int32 i = 0; i < array.Num(); i++)
+    {
+        same &= array.Get(i)->Value() == 7;
+    }
+    TEST_CHECK(array.Num() == 64 && same);
+
+    //Emplace
+    ArrayValue<TestValue> emplaced;
+    emplaced.Emplace(3);
+    for (int32 i = 1; i < 64; i++)
+    {
+        emplaced.Emplace(*emplaced.Get(0));
+    }
+    same = true;
+    for (int32 i = 0; i < emplaced.Num(); i++)
+    {
+        same &= emplaced.Get(i)->Value() == 3;
+    }
+    TEST_CHECK(emplaced.Num() == 64 && same);
+
+    //PushFront and PushBack, from both ends
+    ArrayValueQueue<TestValue> queue;
+    queue.PushBack(TestValue(5));
+    for (int32 i = 1; i < 64; i++)
+    {
+        if (i & 1)
+        {
+            queue.PushFront(*queue.Get(queue.Num() - 1));
+        }
+        else
+        {
+            queue.PushBack(*queue.Get(0));
+        }
+    }
+    same = true;
+    for (int32 i = 0; i < queue.Num(); i++)
+    {
+        same &= queue.Get(i)->Value() == 5;
+    }
+    TEST_CHECK(queue.Num() == 64 && same);
+
+    //sorted Add, where the items after the new one move
+    ArrayValueSorted<TestValue> sorted;
+    sorted.Add(TestValue(1), TestValueCompare);
+    sorted.Add(TestValue(2), TestValueCompare);
+    for (int32 i = 2; i < 64; i++)
+    {
+        sorted.Add(*sorted.Get(i & 1), TestValueCompare);
+    }
+    bool ordered = true;
+    for (int32 i = 1; i < sorted.Num(); i++)
+    {
+        ordered &= sorted.Get(i - 1)->Value() <= sorted.Get(i)->Value();
+    }
+    TEST_CHECK(sorted.Num() == 64 && ordered && sorted.Get(0)->Value() == 1 && sorted.Get(63)->Value() == 2);
+}
+
+
+//
+//global functions
+//
+
+void TestArrayValue()
+{
+    TestArrayValueSelf();
+}
+
+#endif
@@ -0,0 +1,135 @@
+//
+// v1 - Prototype character/item/tradeskill game.
+// Copyright (C) 2013 Adam Hayek (adam.hayek@gmail.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see [http://www.gnu.org/licenses/].
+//
+
+
+#include <windows.h>
+#include <string.h>
+#include "common\global\global.h"
+#include "common\global\Atom.h"
+#include "test\Test.h"
+
+#if defined(__CONFIG_TEST)
+
+//how many names are interned to fill several of the table's 16K chunks
+#define TEST_ATOM_NAMES 4000
+
+//length of a string too big to share a chunk, and of one just small enough to
+#define TEST_ATOM_BIG 10000
+#define TEST_ATOM_CHUNK_MOST 4000
+
+//
+//local functions
+//
+
+//interning the same text gives the same atom, wherever the text is
+static void TestAtomIdentity()
+{
+    //not there until it's interned
+    TEST_CHECK(Atom::Find("TestAtom.identity").IsNull());
+    Atom first = Atom::Intern("TestAtom.identity");
+    TEST_CHECK(first.IsNull() == false);
+
+    //the same text from another buffer
+    char copy[32];
+    strcpy(copy, "TestAtom.identity");
+    Atom second = Atom::Intern(copy);
+    TEST_CHECK(second == first && Atom::Find(copy) == first);
+    TEST_CHECK(second.Str() == first.Str() && strcmp(first.Str(), "TestAtom.identity") == 0);
+    TEST_CHECK(first.Length() == 17 && first.Hash() == HashFunc("TestAtom.identity"));
+
+    //the atom keeps its own copy
+    copy[0] = 'X';
+    TEST_CHECK(strcmp(first.Str(), "TestAtom.identity") == 0);
+
+    //different text is a different atom
+    Atom other = Atom::Intern("TestAtom.identitz");
+    TEST_CHECK(other != first && other.Str() != first.Str());
+
+    //the null atom
+    Atom none;
+    TEST_CHECK(none.IsNull() && Atom::Intern(NULL).IsNull() && Atom::Find(NULL).IsNull());
+    TEST_CHECK(none != first && strcmp(none.Str(), "") == 0 && none.Length() == 0);
+}
+
+//interns enough names to start new chunks, checking every earlier atom is still right
+static void TestAtomChunks()
+{
+    int32 startAtoms = Atom::NumAtoms();
+    int32 startBytes = Atom::NumBytes();
+    Atom *atoms = new Atom[TEST_ATOM_NAMES];
+    for (int32 i = 0; i < TEST_ATOM_NAMES; i++)
+    {
+        buffer64 name;
+        name.Set("TestAtom.chunk.%d", i);
+        atoms[i] = Atom::Intern(name);
+    }
+    TEST_CHECK(Atom::NumAtoms() == startAtoms + TEST_ATOM_NAMES);
+    TEST_CHECK(Atom::NumBytes() - startBytes > 3 * 16384);
+
+    //each one still has its text, and finding it gives it back
+    int32 numWrong = 0;
+    for (int32 i = 0; i < TEST_ATOM_NAMES; i++)
+    {
+        buffer64 name;
+        name.Set("TestAtom.chunk.%d", i);
+        numWrong += (strcmp(atoms[i].Str(), name) != 0 || atoms[i].Length() != name.Length());
+        numWrong += (Atom::Find(name) != atoms[i] || Atom::Intern(name) != atoms[i]);
+    }
+    TEST_CHECK(numWrong == 0);
+    TEST_CHECK(Atom::NumAtoms() == startAtoms + TEST_ATOM_NAMES);
+    delca(atoms);
+}
+
+//strings too big for a chunk get their own allocation, and still intern the same
+static void TestAtomBig()
+{
+    int32 const lengths[] = {TEST_ATOM_CHUNK_MOST, TEST_ATOM_BIG};
+    for (int32 i = 0; i < 2; i++)
+    {
+        char *text = new char[lengths[i] + 1];
+        for (int32 k = 0; k < lengths[i]; k++)
+        {
+            text[k] = char('a' + (k * 7 + i) % 26);
+        }
+        memcpy(text, "TestAtom.big", 12);
+        text[lengths[i]] = '\0';
+
+        Atom big = Atom::Intern(text);
+        TEST_CHECK(big.Length() == lengths[i] && strcmp(big.Str(), text) == 0 && big.Str() != text);
+        TEST_CHECK(Atom::Intern(text) == big && Atom::Find(text) == big);
+        delca(text);
+    }
+
+    //small ones still go in the chunks after a big one
+    Atom small = Atom::Intern("TestAtom.afterBig");
+    TEST_CHECK(strcmp(small.Str(), "TestAtom.afterBig") == 0 && Atom::Find("TestAtom.afterBig") == small);
+}
+
+
+//
+//global functions
+//
+
+void TestAtom()
+{
+    TestAtomIdentity();
+    TestAtomChunks();
+    TestAtomBig();
+}
+
+#endif
@@ -0,0 +1,119 @@
+//
+// v1 - Prototype character/item/tradeskill game.
+// Copyright (C) 2013 Adam Hayek (adam.hayek@gmail.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see [http://www.gnu.org/licenses/].
+//
+
+
+#include <windows.h>
+#include "common\global\global.h"
+#include "common\global\Context.h"
+#include "test\Test.h"
+
+#if defined(__CONFIG_TEST)
+
+//number of calls timed at each level, and how many times they're timed.  The fastest time is
+//kept, which leaves out most of what other programs and interrupts cost.
+#define TEST_CONTEXT_CALLS 1000000
+#define TEST_CONTEXT_TRIALS 9
+
+//
+//local functions
+//
+
+//the same work with and without a context.  Neither can be inlined, so every call in the loops
+//below is a real call and the difference is what CONTEXT_CALLED costs.
+static __declspec(noinline) int32 TestContextBare(int32 value)
+{
+    return value * 3 + 1;
+}
+
+static __declspec(noinline) int32 TestContextCalled(int32 value, Context &caller)
+{
+    CONTEXT_CALLED();
+    return value * 3 + 1;
+}
+
+//times TEST_CONTEXT_CALLS calls of the bare function, returning the fastest trial in ns per call
+static double TestContextTimeBare()
+{
+    double best = 1e30;
+    for (int32 trial = 0; trial < TEST_CONTEXT_TRIALS; trial++)
+    {
+        int64 total = 0;
+        TestClock clock;
+        for (int32 i = 0; i < TEST_CONTEXT_CALLS; i++)
+        {
+            total += TestContextBare(i);
+        }
+        double time = clock.Nanoseconds() / TEST_CONTEXT_CALLS;
+        bound_max(best, time);
+        TestKeep(total);
+    }
+    return best;
+}
+
+//times TEST_CONTEXT_CALLS calls of the function with a context, the same way
+static double TestContextTimeCalled(Context &caller)
+{
+    double best = 1e30;
+    for (int32 trial = 0; trial < TEST_CONTEXT_TRIALS; trial++)
+    {
+        int64 total = 0;
+        TestClock clock;
+        for (int32 i = 0; i < TEST_CONTEXT_CALLS; i++)
+        {
+            total += TestContextCalled(i, caller);
+        }
+        double time = clock.Nanoseconds() / TEST_CONTEXT_CALLS;
+        bound_max(best, time);
+        TestKeep(total);
+    }
+    return best;
+}
+
+
+//
+//global functions
+//
+
+void TestContext()
+{
+    CONTEXT_ROOT();
+
+    //a build which is off has no instrumentation to change, so it only has the one level
+    #if __CONFIG_CONTEXT_INSTRUMENT == CONTEXT_INSTRUMENT_OFF
+    static int32 const levels[] = {CONTEXT_INSTRUMENT_OFF};
+    #else
+    static int32 const levels[] = {CONTEXT_INSTRUMENT_OFF, CONTEXT_INSTRUMENT_SAMPLED, CONTEXT_INSTRUMENT_FULL};
+    #endif
+
+    //the call without a context
+    double bare = TestContextTimeBare();
+    TestReport("CONTEXT_CALLED cost per call, build level %d, bare call %.2f ns:\n", __CONFIG_CONTEXT_INSTRUMENT, bare);
+
+    //the call with one, switching its place the way a game would at runtime
+    for (int32 i = 0; i < int32(sizeof(levels) / sizeof(levels[0])); i++)
+    {
+        ContextInstrument("TestContextCalled", levels[i]);
+        double called = TestContextTimeCalled(context);
+        TestReport("  interval %2d: %6.2f ns, %6.2f ns more\n", levels[i], called, called - bare);
+    }
+
+    //put it back to the build's level
+    ContextInstrument("TestContextCalled", __CONFIG_CONTEXT_INSTRUMENT);
+}
+
+#endif
@@ -0,0 +1,146 @@
+//
+// v1 - Prototype character/item/tradeskill game.
+// Copyright (C) 2013 Adam Hayek (adam.hayek@gmail.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see [http://www.gnu.org/licenses/].
+//
+
+
+#include <windows.h>
+#include <process.h>
+#include "common\global\global.h"
+#include "common\idb\IBase.h"
+#include "test\Test.h"
+
+#if defined(__CONFIG_TEST)
+
+//how many threads each get their own object
+#define TEST_LOCAL_THREADS 2
+
+//
+//local classes
+//
+
+//an interface implemented with one object per thread
+class ITestLocal : public IBase
+{
+public:
+    //the number the object was made with
+    virtual int32 Id() = 0;
+};
+
+//numbers the objects as they are made, and records the thread each is destroyed on
+static long volatile testLocalNumMade = 0;
+static uint32 volatile testLocalDestroyedOn[TEST_LOCAL_THREADS + 1];
+
+class TestLocalImpl : public ITestLocal
+{
+public:
+    InterfaceImplementation(TestLocalImpl);
+
+    TestLocalImpl()
+    {
+        id = _InterlockedIncrement(&testLocalNumMade);
+    }
+
+    ~TestLocalImpl()
+    {
+        if (id <= TEST_LOCAL_THREADS)
+        {
+            testLocalDestroyedOn[id] = GetCurrentThreadId();
+        }
+    }
+
+    //from ITestLocal
+    int32 Id()
+    {
+        return id;
+    }
+
+private:
+    int32 id;
+};
+
+InterfaceCreatePerThread(TestLocalImpl, ITestLocal, default);
+
+static InterfaceLocal<ITestLocal> testLocal;
+InterfaceLocalReference(testLocal, ITestLocal, default);
+
+//what each thread saw
+class TestLocalThread
+{
+public:
+    HANDLE handle;
+    uint32 threadId;
+    int32 firstId;
+    int32 secondId;
+};
+
+
+//
+//local functions
+//
+
+//uses the interface twice inside an InterfaceThread, which destroys the thread's object when it goes
+static unsigned __stdcall TestLocalRun(void *param)
+{
+    TestLocalThread *thread = (TestLocalThread *)param;
+    thread->threadId = GetCurrentThreadId();
+    {
+        InterfaceThread interfaceThread;
+        ITestLocal *local = testLocal.Get();
+        thread->firstId = (local != NULL) ? local->Id() : 0;
+        local = testLocal.Get();
+        thread->secondId = (local != NULL) ? local->Id() : 0;
+    }
+    return 0;
+}
+
+
+//
+//global functions
+//
+
+void TestInterfaceLocal()
+{
+    //run the threads at the same time
+    TestLocalThread threads[TEST_LOCAL_THREADS];
+    for (int32 i = 0; i < TEST_LOCAL_THREADS; i++)
+    {
+        threads[i].threadId = 0;
+        threads[i].firstId = 0;
+        threads[i].secondId = 0;
+        threads[i].handle = (HANDLE)_beginthreadex(NULL, 0, TestLocalRun, &threads[i], 0, NULL);
+    }
+    for (int32 i = 0; i < TEST_LOCAL_THREADS; i++)
+    {
+        WaitForSingleObject(threads[i].handle, INFINITE);
+        CloseHandle(threads[i].handle);
+    }
+
+    //each thread made one object, used it both times, and it was a different one than the other thread's
+    TEST_CHECK(testLocalNumMade == TEST_LOCAL_THREADS);
+    TEST_CHECK(threads[0].firstId != 0 && threads[0].firstId == threads[0].secondId);
+    TEST_CHECK(threads[1].firstId != 0 && threads[1].firstId == threads[1].secondId);
+    TEST_CHECK(threads[0].firstId != threads[1].firstId);
+
+    //and each object was destroyed on its own thread, by its InterfaceThread
+    for (int32 i = 0; i < TEST_LOCAL_THREADS; i++)
+    {
+        int32 id = threads[i].firstId;
+        TEST_CHECK(id > 0 && id <= TEST_LOCAL_THREADS && testLocalDestroyedOn[id] == threads[i].threadId);
+    }
+}
+
+#endif
@@ -0,0 +1,212 @@
+//
+// v1 - Prototype character/item/tradeskill game.
+// Copyright (C) 2013 Adam Hayek (adam.hayek@gmail.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see [http://www.gnu.org/licenses/].
+//
+
+
+
+#include <windows.h>
+#include "common\global\global.h"
+#include "common\global\ObjectPool.h"
+#include "test\Test.h"
+
+#if defined(__CONFIG_TEST)
+
+//objects in each slab of the pools
+#define TEST_POOL_SLAB 16
+
+//objects held at once while the pool grows, enough for several slabs
+#define TEST_POOL_HELD 100
+
+//slots a cache moves to or from its pool at once
+#define TEST_POOL_BATCH 8
+
+//number of random acquires and releases through a pool and a cache
+#define TEST_POOL_STEPS 20000
+
+//
+//local classes
+//
+
+//an object which counts its constructions and destructions, and notices if its memory is shared
+class TestPoolObject
+{
+public:
+    TestPoolObject();
+    ~TestPoolObject();
+
+    //set while the object is alive
+    uint32 alive;
+
+    //what the test wrote in it
+    int32 value;
+
+    //how many have been made and destroyed
+    static int32 numMade;
+    static int32 numDestroyed;
+};
+
+int32 TestPoolObject::numMade = 0;
+int32 TestPoolObject::numDestroyed = 0;
+
+TestPoolObject::TestPoolObject()
+{
+    alive = 0xa11fe;
+    value = -1;
+    numMade++;
+}
+
+TestPoolObject::~TestPoolObject()
+{
+    alive = 0;
+    numDestroyed++;
+}
+
+
+//
+//local functions
+//
+
+//fills a pool past several slabs, empties it, and fills it again from the same slabs
+static void TestObjectPoolSlabs()
+{
+    TestPoolObject::numMade = TestPoolObject::numDestroyed = 0;
+    {
+        ObjectPool<TestPoolObject> pool(TEST_POOL_SLAB);
+        TestPoolObject *held[TEST_POOL_HELD];
+        for (int32 pass = 0; pass < 2; pass++)
+        {
+            //each object is constructed, and no two share memory
+            for (int32 i = 0; i < TEST_POOL_HELD; i++)
+            {
+                held[i] = pool.Acquire();
+                TEST_CHECK(held[i] != NULL && held[i]->alive == 0xa11fe && held[i]->value == -1);
+                held[i]->value = i;
+            }
+            bool same = true;
+            for (int32 i = 0; i < TEST_POOL_HELD; i++)
+            {
+                same &= held[i]->value == i;
+            }
+            TEST_CHECK(same);
+
+            //the pool grew a slab at a time, and only the first time
+            int32 numSlabs = (TEST_POOL_HELD + TEST_POOL_SLAB - 1) / TEST_POOL_SLAB;
+            TEST_CHECK(pool.NumSlabs() == numSlabs && pool.NumSlots() == numSlabs * TEST_POOL_SLAB);
+            TEST_CHECK(pool.NumInUse() == TEST_POOL_HELD && pool.HighWater() == TEST_POOL_HELD);
+            TEST_CHECK(pool.NumAcquired() == int64(TEST_POOL_HELD) * (pass + 1));
+
+            //release them in a different order than they were acquired
+            for (int32 i = 0; i < TEST_POOL_HELD; i++)
+            {
+                pool.Release(held[(i * 7) % TEST_POOL_HELD]);
+            }
+            TEST_CHECK(pool.NumInUse() == 0 && pool.HighWater() == TEST_POOL_HELD);
+        }
+    }
+
+    //every object was destroyed by Release
+    TEST_CHECK(TestPoolObject::numMade == TEST_POOL_HELD * 2 && TestPoolObject::numDestroyed == TestPoolObject::numMade);
+}
+
+//acquires and releases at random through a cache and the pool directly, and checks the cache
+//hands its slots back in batches and all of them when it's destroyed
+static void TestObjectPoolCache()
+{
+    TestPoolObject::numMade = TestPoolObject::numDestroyed = 0;
+    ObjectPool<TestPoolObject> pool(TEST_POOL_SLAB);
+    TestPoolObject *held[TEST_POOL_HELD];
+    int32 numHeld = 0;
+    int32 mostHeld = 0;
+    int32 numWrong = 0;
+    {
+        //the first Acquire takes a whole batch from the pool
+        ObjectPool<TestPoolObject>::Cache cache(pool, TEST_POOL_BATCH);
+        held[numHeld++] = cache.Acquire();
+        TEST_CHECK(pool.NumInUse() == TEST_POOL_BATCH);
+
+        //holding twice a batch of free slots gives one batch back
+        for (int32 i = 1; i < TEST_POOL_BATCH * 2; i++)
+        {
+            held[numHeld++] = cache.Acquire();
+        }
+        TEST_CHECK(pool.NumInUse() == TEST_POOL_BATCH * 2);
+        while (numHeld > 0)
+        {
+            cache.Release(held[--numHeld]);
+        }
+        TEST_CHECK(pool.NumInUse() == TEST_POOL_BATCH);
+
+        //random acquires and releases.  The pool counts what callers hold plus what the cache keeps,
+        //which is less than two batches.
+        TestRandom random(5);
+        for (int32 step = 0; step < TEST_POOL_STEPS; step++)
+        {
+            bool useCache = random.Next(4) != 0;
+            if (numHeld < TEST_POOL_HELD && (numHeld == 0 || random.Next(2) == 0))
+            {
+                TestPoolObject *object = useCache ? cache.Acquire() : pool.Acquire();
+                numWrong += object == NULL || object->alive != 0xa11fe || object->value != -1;
+                object->value = step;
+                held[numHeld++] = object;
+                mostHeld = max(mostHeld, numHeld);
+            }
+            else
+            {
+                int32 index = int32(random.Next(numHeld));
+                TestPoolObject *object = held[index];
+                numWrong += object->alive != 0xa11fe;
+                held[index] = held[--numHeld];
+                if (useCache)
+                {
+                    cache.Release(object);
+                }
+                else
+                {
+                    pool.Release(object);
+                }
+            }
+            numWrong += pool.NumInUse() < numHeld || pool.NumInUse() >= numHeld + TEST_POOL_BATCH * 2;
+        }
+        TEST_CHECK(numWrong == 0);
+
+        //give back what we hold, the cache keeps some
+        while (numHeld > 0)
+        {
+            cache.Release(held[--numHeld]);
+        }
+        TEST_CHECK(pool.NumInUse() > 0 && pool.NumInUse() < TEST_POOL_BATCH * 2);
+    }
+
+    //destroying the cache gave back the rest, so the counts balance and every object was destroyed
+    TEST_CHECK(pool.NumInUse() == 0);
+    TEST_CHECK(pool.HighWater() >= mostHeld && pool.HighWater() < mostHeld + TEST_POOL_BATCH * 2);
+    TEST_CHECK(pool.HighWater() <= pool.NumSlots());
+    TEST_CHECK(TestPoolObject::numDestroyed == TestPoolObject::numMade);
+}
+
+
+//
+//global functions
+//
+
+void TestObjectPool()
+{
+    TestObjectPoolSlabs();
+    TestObjectPoolCache();
+}
+
+#endif
@@ -0,0 +1,84 @@
+//
+// v1 - Prototype character/item/tradeskill game.
+// Copyright (C) 2013 Adam Hayek (adam.hayek@gmail.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see [http://www.gnu.org/licenses/].
+//
+
+
+
+#include <windows.h>
+#include "common\global\global.h"
+#include "test\ITestPlugin.h"
+#include "test\Test.h"
+
+#if defined(__CONFIG_TEST)
+
+//the number the program's ITestPluginHost returns
+#define TEST_PLUGIN_HOST_VALUE 4321
+
+//
+//local classes
+//
+
+//the program's side, which the DLL references
+class TestPluginHostImpl : public ITestPluginHost
+{
+public:
+    InterfaceImplementation(TestPluginHostImpl);
+
+    //from ITestPluginHost
+    int32 Value()
+    {
+        return TEST_PLUGIN_HOST_VALUE;
+    }
+};
+
+InterfaceCreate(TestPluginHostImpl, testPluginHostImpl, ITestPluginHost, default);
+
+//the DLL's implementation, and one from a DLL which isn't installed
+InterfacePlugin(ITestPlugin, default, TEST_PLUGIN_FILE);
+InterfacePlugin(ITestPlugin, missing, "testplugin_missing.dll");
+
+static ITestPlugin *testPlugin = NULL;
+InterfaceReference(testPlugin, ITestPlugin, default);
+
+static ITestPlugin *testPluginMissing = NULL;
+InterfaceReference(testPluginMissing, ITestPlugin, missing);
+
+
+//
+//global functions
+//
+
+void TestPlugin()
+{
+    //nothing implements the interface until its DLL is loaded
+    TEST_CHECK(testPlugin == NULL && testPluginMissing == NULL);
+
+    //load the DLL, the missing one is tried but doesn't count
+    TEST_CHECK(InterfaceLoadPlugins() == 1);
+
+    //our reference reaches the DLL's implementation, and the DLL's reaches ours
+    TEST_CHECK(testPlugin != NULL && testPlugin->Add(1) == 1 + TEST_PLUGIN_ADD);
+    TEST_CHECK(testPlugin != NULL && testPlugin->HostValue() == TEST_PLUGIN_HOST_VALUE);
+
+    //an optional DLL which isn't there leaves its references NULL
+    TEST_CHECK(testPluginMissing == NULL);
+
+    //each DLL is only tried once
+    TEST_CHECK(InterfaceLoadPlugins() == 0);
+}
+
+#endif
@@ -0,0 +1,170 @@
+//
+// v1 - Prototype character/item/tradeskill game.
+// Copyright (C) 2013 Adam Hayek (adam.hayek@gmail.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see [http://www.gnu.org/licenses/].
+//
+
+
+#include <windows.h>
+#include "common\global\global.h"
+#include "common\global\PointerSearch.h"
+#include "test\Test.h"
+
+#if defined(__CONFIG_TEST)
+
+//the longest array timed
+#define TEST_SEARCH_MAX 48
+
+//number of searches timed at each length, and how many times they're timed.  The fastest time
+//is kept, which leaves out most of what other programs and interrupts cost.
+#define TEST_SEARCH_REPEATS 100000
+#define TEST_SEARCH_TRIALS 9
+
+//
+//local functions
+//
+
+//checks the vector search finds the same pointer as a plain loop, at every length and position
+static void TestPointerSearchMatches()
+{
+    //distinct pointers, with a copy of one later on so the first match must be returned
+    int32 targets[TEST_SEARCH_MAX * 2];
+    void const *pointers[TEST_SEARCH_MAX * 2];
+    for (int32 i = 0; i < TEST_SEARCH_MAX * 2; i++)
+    {
+        pointers[i] = &targets[i];
+    }
+
+    //every length, and every position plus a miss
+    bool same = true;
+    for (int32 count = 0; count <= TEST_SEARCH_MAX; count++)
+    {
+        for (int32 position = 0; position <= count; position++)
+        {
+            //the pointer at position, or one past the end
+            void const *value = pointers[position];
+            int32 expected = (position < count) ? position : -1;
+            same &= PointerSearch(pointers, count, value) == expected;
+            same &= PointerSearchVector(pointers, count, value) == expected;
+
+            //a later duplicate mustn't be found first
+            if (position + 1 < count)
+            {
+                void const *saved = pointers[count - 1];
+                pointers[count - 1] = value;
+                same &= PointerSearchVector(pointers, count, value) == expected;
+                pointers[count - 1] = saved;
+            }
+        }
+    }
+    TEST_CHECK(same);
+}
+
+//times the plain loop and the vector search at each length, finding pointers at random
+//positions, and reports where the vector search starts to win.
+static void TestPointerSearchCrossover()
+{
+    //the pointers to search through
+    int32 targets[TEST_SEARCH_MAX];
+    void const *pointers[TEST_SEARCH_MAX];
+    for (int32 i = 0; i < TEST_SEARCH_MAX; i++)
+    {
+        pointers[i] = &targets[i];
+    }
+
+    //the positions to look for, a quarter of them misses
+    TestRandom random;
+    uint8 *positions = new uint8[TEST_SEARCH_REPEATS];
+
+    //the shortest length the vector search wins from, and every longer one
+    int32 crossover = TEST_SEARCH_MAX + 1;
+    TestReport("PointerSearch, %d-byte pointers, ns per search:\n", int32(sizeof(void *)));
+    for (int32 count = 1; count <= TEST_SEARCH_MAX; count++)
+    {
+        //pick the positions, past the end is a miss
+        for (int32 i = 0; i < TEST_SEARCH_REPEATS; i++)
+        {
+            positions[i] = uint8(random.Next(count + (count + 2) / 3));
+            bound_max(positions[i], count);
+        }
+        void const *miss = &random;
+
+        //take turns timing each one
+        double scalarTime = 1e30;
+        double vectorTime = 1e30;
+        for (int32 trial = 0; trial < TEST_SEARCH_TRIALS; trial++)
+        {
+            //the plain loop, as PointerSearch inlines it
+            int64 total = 0;
+            TestClock clock;
+            for (int32 r = 0; r < TEST_SEARCH_REPEATS; r++)
+            {
+                void const *value = (positions[r] < count) ? pointers[positions[r]] : miss;
+                int32 found = -1;
+                for (int32 i = 0; i < count; i++)
+                {
+                    if (pointers[i] == value)
+                    {
+                        found = i;
+                        break;
+                    }
+                }
+                total += found;
+            }
+            double time = clock.Nanoseconds() / TEST_SEARCH_REPEATS;
+            bound_max(scalarTime, time);
+            TestKeep(total);
+
+            //the vector search
+            total = 0;
+            clock.Restart();
+            for (int32 r = 0; r < TEST_SEARCH_REPEATS; r++)
+            {
+                void const *value = (positions[r] < count) ? pointers[positions[r]] : miss;
+                total += PointerSearchVector(pointers, count, value);
+            }
+            time = clock.Nanoseconds() / TEST_SEARCH_REPEATS;
+            bound_max(vectorTime, time);
+            TestKeep(total);
+        }
+
+        //the crossover is the first length of the run of wins that lasts to the end
+        if (vectorTime < scalarTime)
+        {
+            bound_max(crossover, count);
+        }
+        else
+        {
+            crossover = TEST_SEARCH_MAX + 1;
+        }
+        TestReport("  %2d: loop %5.2f, vector %5.2f\n", count, scalarTime, vectorTime);
+    }
+    TestReport("  vector search wins from %d pointers, POINTER_SEARCH_MIN_VECTOR is %d\n", crossover, POINTER_SEARCH_MIN_VECTOR);
+
+    delca(positions);
+}
+
+
+//
+//global functions
+//
+
+void TestPointerSearch()
+{
+    TestPointerSearchMatches();
+    TestPointerSearchCrossover();
+}
+
+#endif
@@ -0,0 +1,181 @@
+//
+// v1 - Prototype character/item/tradeskill game.
+// Copyright (C) 2013 Adam Hayek (adam.hayek@gmail.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see [http://www.gnu.org/licenses/].
+//
+
+
+#include <windows.h>
+#include "common\global\global.h"
+#include "common\global\SlotMap.h"
+#include "test\Test.h"
+
+#if defined(__CONFIG_TEST)
+
+//number of random adds and removes checked against the plain list
+#define TEST_SLOT_STEPS 20000
+
+//the most items in the map at once during them
+#define TEST_SLOT_MAX 300
+
+//how many objects one slot holds with uint32 handles before it's retired
+#define TEST_SLOT_GENERATIONS 2048
+
+//
+//local functions
+//
+
+//adds and removes items at random, checking the map against a plain list of handles and values
+static void TestSlotMapRandom()
+{
+    SlotMap<int32> map;
+    TestRandom random(7);
+    ArrayValue<uint32> liveHandles;
+    ArrayValue<int32> liveValues;
+    ArrayValue<uint32> deadHandles;
+    int32 numWrong = 0;
+    for (int32 step = 0; step < TEST_SLOT_STEPS; step++)
+    {
+        //add one, more often while the map is small
+        if (liveHandles.Num() == 0 || int32(random.Next(TEST_SLOT_MAX)) >= liveHandles.Num())
+        {
+            int32 value = step;
+            uint32 handle = map.Add(value);
+            numWrong += (handle == 0);
+            liveHandles.Add(handle);
+            liveValues.Add(value);
+        }
+        else
+        {
+            //remove one, which then can't be found or removed again
+            int32 index = int32(random.Next(liveHandles.Num()));
+            uint32 handle = *liveHandles.Get(index);
+            numWrong += (map.Remove(handle) == false);
+            numWrong += (map.Remove(handle) != false);
+            numWrong += (map.Get(handle) != NULL);
+            deadHandles.Add(handle);
+            liveHandles.Remove(index);
+            liveValues.Remove(index);
+        }
+
+        //every so often check everything
+        if ((step & 255) == 0 || step == TEST_SLOT_STEPS - 1)
+        {
+            numWrong += (map.Num() != liveHandles.Num());
+            for (int32 i = 0; i < liveHandles.Num(); i++)
+            {
+                int32 const *item = map.Get(*liveHandles.Get(i));
+                numWrong += (item == NULL || *item != *liveValues.Get(i));
+            }
+            for (int32 i = 0; i < deadHandles.Num(); i++)
+            {
+                numWrong += map.Contains(*deadHandles.Get(i));
+            }
+
+            //walking the items gives each handle's item once
+            for (int32 i = 0; i < map.Num(); i++)
+            {
+                numWrong += (map.Get(map.HandleAt(i)) != map.GetAt(i));
+            }
+        }
+    }
+    TEST_CHECK(numWrong == 0);
+
+    //emptying it leaves no handle that works
+    map.Empty();
+    int32 numFound = 0;
+    for (int32 i = 0; i < liveHandles.Num(); i++)
+    {
+        numFound += map.Contains(*liveHandles.Get(i));
+    }
+    TEST_CHECK(map.Num() == 0);
+    TEST_CHECK(numFound == 0);
+}
+
+//uses one slot until its generations run out, checking no old handle ever matches again
+static void TestSlotMapGenerations()
+{
+    SlotMap<int32> map;
+    ArrayValue<uint32> handles;
+    int32 numWrong = 0;
+    for (int32 i = 0; i < TEST_SLOT_GENERATIONS + 2; i++)
+    {
+        //the newest handle finds its item, and the last one doesn't
+        uint32 handle = map.Add(i);
+        int32 const *item = map.Get(handle);
+        numWrong += (handle == 0 || item == NULL || *item != i);
+        if (handles.Num() > 0)
+        {
+            numWrong += map.Contains(*handles.Get(handles.Num() - 1));
+        }
+        handles.Add(handle);
+        numWrong += (map.Remove(handle) == false);
+
+        //removing the stale handle again leaves the free list alone
+        numWrong += (map.Remove(handle) != false);
+    }
+    TEST_CHECK(numWrong == 0);
+
+    //the first slot was retired once it had held every generation, so the next objects are in
+    //another slot.  The index is in the low 20 bits.
+    TEST_CHECK((*handles.Get(TEST_SLOT_GENERATIONS - 1) & 0xFFFFF) == 0);
+    TEST_CHECK((*handles.Get(TEST_SLOT_GENERATIONS) & 0xFFFFF) != 0);
+
+    //no handle was ever handed out twice, and none of them match now
+    int32 numRepeats = 0;
+    int32 numFound = 0;
+    for (int32 i = 0; i < handles.Num(); i++)
+    {
+        for (int32 j = 0; j < i; j++)
+        {
+            numRepeats += (*handles.Get(i) == *handles.Get(j));
+        }
+        numFound += map.Contains(*handles.Get(i));
+    }
+    TEST_CHECK(numRepeats == 0);
+    TEST_CHECK(numFound == 0);
+
+    //two new items get two working handles, so the free list didn't loop
+    uint32 first = map.Add(1);
+    uint32 second = map.Add(2);
+    TEST_CHECK(first != second && map.Get(first) != NULL && map.Get(second) != NULL && *map.Get(first) == 1 && *map.Get(second) == 2);
+}
+
+//the same with 64 bit handles, whose index takes 31 bits
+static void TestSlotMapWide()
+{
+    SlotMap<int32, uint64> map;
+    uint64 first = map.Add(10);
+    uint64 second = map.Add(20);
+    TEST_CHECK(first != 0 && second != 0 && (first & 0x7FFFFFFF) == 0 && (second & 0x7FFFFFFF) == 1);
+    TEST_CHECK(map.Remove(first) && map.Get(first) == NULL);
+    uint64 third = map.Add(30);
+    TEST_CHECK(third != first && (third & 0x7FFFFFFF) == 0 && *map.Get(third) == 30 && *map.Get(second) == 20);
+    TEST_CHECK(map.Get(0) == NULL);
+}
+
+
+//
+//global functions
+//
+
+void TestSlotMap()
+{
+    TestSlotMapRandom();
+    TestSlotMapGenerations();
+    TestSlotMapWide();
+}
+
+#endif
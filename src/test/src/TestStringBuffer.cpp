@@ -0,0 +1,162 @@
+//
+// v1 - Prototype character/item/tradeskill game.
+// Copyright (C) 2013 Adam Hayek (adam.hayek@gmail.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see [http://www.gnu.org/licenses/].
+//
+
+
+#include <windows.h>
+#include <math.h>
+#include <wchar.h>
+#include "common\global\global.h"
+#include "test\Test.h"
+
+#if defined(__CONFIG_TEST)
+
+//number of lines formatted for each timing
+#define TEST_FORMAT_LINES 1000000
+
+//
+//local functions
+//
+
+//the value for line i, spread over a few orders of magnitude and both signs
+static double TestFormatValue(int32 i)
+{
+    return ((i & 1) ? -1.0 : 1.0) * double(i % 100000) * 0.0137;
+}
+
+//true if the value is within rounding error of halfway between two values with 2 decimal places.
+//StringFormatFloat rounds those away from zero, and printf may round them either way.
+static bool TestFormatNearTie(double value)
+{
+    double scaled = value * 100.0;
+    double fraction = scaled - floor(scaled);
+    return fabs(fraction - 0.5) < 1e-6;
+}
+
+//checks the typed appends write what printf does
+static void TestStringBufferMatches()
+{
+    bool same = true;
+    for (int32 i = 0; i < 10000; i++)
+    {
+        //an integer
+        int64 value = int64(i) * 1234567 - 5000000000;
+        ubuffer64 printed;
+        printed.Set(L"%lld", value);
+        ubuffer64 typed;
+        typed.AppendInt(value);
+        same &= wcscmp(printed, typed) == 0;
+
+        //a float with 2 decimals
+        double fraction = TestFormatValue(i);
+        printed.Set(L"%.2f", fraction);
+        typed.Truncate(0);
+        typed.AppendFloat(fraction, 2);
+        same &= wcscmp(printed, typed) == 0 || TestFormatNearTie(fraction);
+    }
+    TEST_CHECK(same);
+}
+
+//times a line of the frame rate display, and plain numbers, through printf and the typed appends
+static void TestStringBufferSpeed()
+{
+    TestReport("StringBuffer formatting, ns per line:\n");
+
+    //the frame rate line, as FrameRateImpl used to write it
+    int64 total = 0;
+    TestClock clock;
+    for (int32 i = 0; i < TEST_FORMAT_LINES; i++)
+    {
+        ubuffer256 line;
+        line.Set(L"%3.0f FPS (%3.0f)", double(i % 1000) * 0.25, double(i % 997) * 0.125);
+        total += line.Length();
+    }
+    double printfTime = clock.Nanoseconds() / TEST_FORMAT_LINES;
+    TestKeep(total);
+
+    //and as it writes it now
+    total = 0;
+    clock.Restart();
+    for (int32 i = 0; i < TEST_FORMAT_LINES; i++)
+    {
+        ubuffer256 line;
+        line.AppendFloat(double(i % 1000) * 0.25, 0, 3).Append(L" FPS (").AppendFloat(double(i % 997) * 0.125, 0, 3).Append(L')');
+        total += line.Length();
+    }
+    double typedTime = clock.Nanoseconds() / TEST_FORMAT_LINES;
+    TestKeep(total);
+    TestReport("  \"%%3.0f FPS (%%3.0f)\": _vsnwprintf_s %6.1f, AppendFloat %6.1f, %4.1fx\n", printfTime, typedTime, printfTime / typedTime);
+
+    //an integer
+    total = 0;
+    clock.Restart();
+    for (int32 i = 0; i < TEST_FORMAT_LINES; i++)
+    {
+        ubuffer64 line;
+        line.Set(L"%d", (i % 200000) * 7919 - 800000000);
+        total += line.Length();
+    }
+    printfTime = clock.Nanoseconds() / TEST_FORMAT_LINES;
+    TestKeep(total);
+    total = 0;
+    clock.Restart();
+    for (int32 i = 0; i < TEST_FORMAT_LINES; i++)
+    {
+        ubuffer64 line;
+        line.AppendInt((i % 200000) * 7919 - 800000000);
+        total += line.Length();
+    }
+    typedTime = clock.Nanoseconds() / TEST_FORMAT_LINES;
+    TestKeep(total);
+    TestReport("  \"%%d\": _vsnwprintf_s %6.1f, AppendInt %6.1f, %4.1fx\n", printfTime, typedTime, printfTime / typedTime);
+
+    //a float with 2 decimals
+    total = 0;
+    clock.Restart();
+    for (int32 i = 0; i < TEST_FORMAT_LINES; i++)
+    {
+        ubuffer64 line;
+        line.Set(L"%.2f", TestFormatValue(i));
+        total += line.Length();
+    }
+    printfTime = clock.Nanoseconds() / TEST_FORMAT_LINES;
+    TestKeep(total);
+    total = 0;
+    clock.Restart();
+    for (int32 i = 0; i < TEST_FORMAT_LINES; i++)
+    {
+        ubuffer64 line;
+        line.AppendFloat(TestFormatValue(i), 2);
+        total += line.Length();
+    }
+    typedTime = clock.Nanoseconds() / TEST_FORMAT_LINES;
+    TestKeep(total);
+    TestReport("  \"%%.2f\": _vsnwprintf_s %6.1f, AppendFloat %6.1f, %4.1fx\n", printfTime, typedTime, printfTime / typedTime);
+}
+
+
+//
+//global functions
+//
+
+void TestStringBuffer()
+{
+    TestStringBufferMatches();
+    TestStringBufferSpeed();
+}
+
+#endif
@@ -0,0 +1,506 @@
+//
+// v1 - Prototype character/item/tradeskill game.
+// Copyright (C) 2013 Adam Hayek (adam.hayek@gmail.com)
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see [http://www.gnu.org/licenses/].
+//
+
+
+#include <windows.h>
+#include <string.h>
+#include <wchar.h>
+#include "common\global\global.h"
+#include "common\global\Utf.h"
+#include "test\Test.h"
+
+#if defined(__CONFIG_TEST)
+
+//number of random strings converted each way
+#define TEST_UTF_FUZZ 100000
+
+//the longest random string
+#define TEST_UTF_FUZZ_MAX 256
+
+//characters in the benchmark text, and how many times it is converted
+#define TEST_UTF_TEXT 4096
+#define TEST_UTF_REPEATS 2000
+
+//
+//local functions
+//
+//The reference conversions below are written the plain way, straight from the Unicode standard's
+//table of well formed UTF-8, one unit at a time, so Utf.cpp can be checked against them.
+//
+
+//decodes UTF-8 into characters, a U+FFFD for each maximal invalid subpart.  dest must have room
+//for srcLen characters.  Returns the number of characters, and sets errors to the number of
+//U+FFFD written for bad input.
+static int32 TestUtfDecode8(uint8 const *src, int32 srcLen, uint32 *dest, int32 &errors)
+{
+    int32 num = 0;
+    errors = 0;
+    int32 i = 0;
+    while (i < srcLen)
+    {
+        //ASCII
+        uint8 lead = src[i++];
+        if (lead < 0x80)
+        {
+            dest[num++] = lead;
+            continue;
+        }
+
+        //how many continuation bytes the lead byte needs, and the range of the first one
+        int32 need = 0;
+        uint8 low = 0x80;
+        uint8 high = 0xBF;
+        uint32 value = 0;
+        if (lead >= 0xC2 && lead <= 0xDF)
+        {
+            need = 1;
+            value = lead & 0x1F;
+        }
+        else if (lead >= 0xE0 && lead <= 0xEF)
+        {
+            need = 2;
+            value = lead & 0x0F;
+            low = (lead == 0xE0) ? 0xA0 : 0x80;
+            high = (lead == 0xED) ? 0x9F : 0xBF;
+        }
+        else if (lead >= 0xF0 && lead <= 0xF4)
+        {
+            need = 3;
+            value = lead & 0x07;
+            low = (lead == 0xF0) ? 0x90 : 0x80;
+            high = (lead == 0xF4) ? 0x8F : 0xBF;
+        }
+        else
+        {
+            //never a lead byte
+            dest[num++] = UTF_REPLACEMENT;
+            errors++;
+            continue;
+        }
+
+        //the continuation bytes, stopping at the first wrong one, which isn't used up
+        bool good = true;
+        for (int32 k = 0; k < need; k++)
+        {
+            if (i >= srcLen || src[i] < low || src[i] > high)
+            {
+                good = false;
+                break;
+            }
+            value = (value << 6) | (src[i++] & 0x3F);
+            low = 0x80;
+            high = 0xBF;
+        }
+        if (good == false)
+        {
+            value = UTF_REPLACEMENT;
+            errors++;
+        }
+        dest[num++] = value;
+    }
+    return num;
+}
+
+//decodes wchars into characters, a U+FFFD for each unpaired surrogate or value past U+10FFFF.
+//dest must have room for srcLen characters.  Returns the number of characters.
+static int32 TestUtfDecodeWide(wchar const *src, int32 srcLen, uint32 *dest)
+{
+    int32 num = 0;
+    for (int32 i = 0; i < srcLen; i++)
+    {
+        uint32 value = uint32(src[i]);
+        if (sizeof(wchar) == 2 && value >= 0xD800 && value <= 0xDBFF && i + 1 < srcLen && uint32(src[i + 1]) >= 0xDC00 && uint32(src[i + 1]) <= 0xDFFF)
+        {
+            //a surrogate pair
+            value = 0x10000 + ((value - 0xD800) << 10) + (uint32(src[++i]) - 0xDC00);
+        }
+        else if ((value >= 0xD800 && value <= 0xDFFF) || value > 0x10FFFF)
+        {
+            //not a character
+            value = UTF_REPLACEMENT;
+        }
+        dest[num++] = value;
+    }
+    return num;
+}
+
+//encodes characters as UTF-8.  Returns the number of bytes.
+static int32 TestUtfEncode8(uint32 const *src, int32 num, char *dest)
+{
+    int32 pos = 0;
+    for (int32 i = 0; i < num; i++)
+    {
+        uint32 value = src[i];
+        if (value < 0x80)
+        {
+            dest[pos++] = char(value);
+        }
+        else if (value < 0x800)
+        {
+            dest[pos++] = char(0xC0 | (value >> 6));
+            dest[pos++] = char(0x80 | (value & 0x3F));
+        }
+        else if (value < 0x10000)
+        {
+            dest[pos++] = char(0xE0 | (value >> 12));
+            dest[pos++] = char(0x80 | ((value >> 6) & 0x3F));
+            dest[pos++] = char(0x80 | (value & 0x3F));
+        }
+        else
+        {
+            dest[pos++] = char(0xF0 | (value >> 18));
+            dest[pos++] = char(0x80 | ((value >> 12) & 0x3F));
+            dest[pos++] = char(0x80 | ((value >> 6) & 0x3F));
+            dest[pos++] = char(0x80 | (value & 0x3F));
+        }
+    }
+    return pos;
+}
+
+//encodes characters as wchars.  Returns the number of wchars.
+static int32 TestUtfEncodeWide(uint32 const *src, int32 num, wchar *dest)
+{
+    int32 pos = 0;
+    for (int32 i = 0; i < num; i++)
+    {
+        uint32 value = src[i];
+        if (sizeof(wchar) == 2 && value >= 0x10000)
+        {
+            dest[pos++] = wchar(0xD800 + ((value - 0x10000) >> 10));
+            dest[pos++] = wchar(0xDC00 + ((value - 0x10000) & 0x3FF));
+        }
+        else
+        {
+            dest[pos++] = wchar(value);
+        }
+    }
+    return pos;
+}
+
+//a random character, never 0, weighted towards the ends of the UTF-8 lengths
+static uint32 TestUtfCharacter(TestRandom &random)
+{
+    static uint32 const edges[] = {0x01, 0x7F, 0x80, 0x7FF, 0x800, 0xD7FF, 0xE000, 0xFFFD, 0xFFFF, 0x10000, 0x10FFFF};
+    switch (random.Next(4))
+    {
+    case 0:
+        return 1 + random.Next(0x7F);
+    case 1:
+        return edges[random.Next(sizeof(edges) / sizeof(edges[0]))];
+    case 2:
+        return 0x80 + random.Next(0xD800 - 0x80);
+    default:
+        {
+            uint32 value = 0xE000 + random.Next(0x110000 - 0xE000);
+            return value;
+        }
+    }
+}
+
+//fills src with random UTF-8: runs of ASCII long enough for the fast path, good characters, and
+//bytes that can't start or continue a character here.  Returns the length.
+static int32 TestUtfRandom8(TestRandom &random, uint8 *src)
+{
+    static uint8 const odd[] = {0x80, 0x8F, 0x90, 0x9F, 0xA0, 0xBF, 0xC0, 0xC1, 0xC2, 0xDF, 0xE0, 0xED, 0xEF, 0xF0, 0xF4, 0xF5, 0xFF};
+    int32 length = int32(random.Next(TEST_UTF_FUZZ_MAX));
+    int32 num = 0;
+    while (num < length)
+    {
+        switch (random.Next(4))
+        {
+        case 0:
+            {
+                //a run of ASCII
+                int32 run = int32(random.Next(40));
+                for (int32 k = 0; k < run && num < length; k++)
+                {
+                    src[num++] = uint8(1 + random.Next(0x7F));
+                }
+            }
+            break;
+        case 1:
+            {
+                //a good character, sometimes cut short
+                uint32 value = TestUtfCharacter(random);
+                char bytes[4];
+                int32 count = TestUtfEncode8(&value, 1, bytes);
+                if (random.Next(8) == 0)
+                {
+                    count = int32(random.Next(count));
+                }
+                for (int32 k = 0; k < count && num < length; k++)
+                {
+                    src[num++] = uint8(bytes[k]);
+                }
+            }
+            break;
+        case 2:
+            //a byte that's often wrong
+            src[num++] = odd[random.Next(sizeof(odd))];
+            break;
+        default:
+            //any byte
+            src[num++] = uint8(1 + random.Next(0xFF));
+            break;
+        }
+    }
+    return num;
+}
+
+//fills src with random wchars: ASCII, good characters, and unpaired surrogates or values past
+//U+10FFFF.  Returns the length.
+static int32 TestUtfRandomWide(TestRandom &random, wchar *src)
+{
+    int32 length = int32(random.Next(TEST_UTF_FUZZ_MAX));
+    int32 num = 0;
+    while (num < length)
+    {
+        switch (random.Next(4))
+        {
+        case 0:
+            {
+                //a run of ASCII
+                int32 run = int32(random.Next(40));
+                for (int32 k = 0; k < run && num < length; k++)
+                {
+                    src[num++] = wchar(1 + random.Next(0x7F));
+                }
+            }
+            break;
+        case 1:
+            {
+                //a good character
+                uint32 value = TestUtfCharacter(random);
+                wchar units[2];
+                int32 count = TestUtfEncodeWide(&value, 1, units);
+                for (int32 k = 0; k < count && num < length; k++)
+                {
+                    src[num++] = units[k];
+                }
+            }
+            break;
+        case 2:
+            //a lone surrogate
+            src[num++] = wchar(0xD800 + random.Next(0x800));
+            break;
+        default:
+            //past the last character, where a wchar can hold it
+            src[num++] = (sizeof(wchar) == 2) ? wchar(0xDC00) : wchar(0x110000 + random.Next(0x1000));
+            break;
+        }
+    }
+    return num;
+}
+
+//converts random UTF-8 to wchars and back, checking against the reference conversions
+static void TestUtfFuzz8()
+{
+    TestRandom random(16);
+    uint8 src[TEST_UTF_FUZZ_MAX];
+    uint32 characters[TEST_UTF_FUZZ_MAX];
+    wchar expected[TEST_UTF_FUZZ_MAX * 2 + 1];
+    wchar wide[TEST_UTF_FUZZ_MAX * 2 + 1];
+    char back[TEST_UTF_FUZZ_MAX * 4 + 1];
+    char expectedBack[TEST_UTF_FUZZ_MAX * 4 + 1];
+    int32 numWrong = 0;
+    int32 numTruncatedWrong = 0;
+    for (int32 n = 0; n < TEST_UTF_FUZZ; n++)
+    {
+        //what it should be
+        int32 srcLen = TestUtfRandom8(random, src);
+        int32 errors = 0;
+        int32 numCharacters = TestUtfDecode8(src, srcLen, characters, errors);
+        int32 expectedLen = TestUtfEncodeWide(characters, numCharacters, expected);
+        expected[expectedLen] = 0;
+
+        //convert it, and check the length it asks for
+        int32 wideLen = WideFromUtf8(wide, TEST_UTF_FUZZ_MAX * 2 + 1, (char const *)src, srcLen);
+        bool right = wideLen == expectedLen && memcmp(wide, expected, sizeof(wchar) * (expectedLen + 1)) == 0;
+        right &= WideFromUtf8(NULL, 0, (char const *)src, srcLen) == expectedLen;
+        right &= Utf8Valid((char const *)src, srcLen) == (errors == 0);
+
+        //and back, which gives the input when it was valid
+        int32 backLen = Utf8FromWide(back, TEST_UTF_FUZZ_MAX * 4 + 1, wide, wideLen);
+        int32 expectedBackLen = TestUtfEncode8(characters, numCharacters, expectedBack);
+        right &= backLen == expectedBackLen && memcmp(back, expectedBack, expectedBackLen) == 0 && back[backLen] == '\0';
+        right &= errors != 0 || (backLen == srcLen && memcmp(back, src, srcLen) == 0);
+        numWrong += (right == false);
+
+        //into too little room, which stops before the character that doesn't fit
+        int32 destLen = 1 + int32(random.Next(expectedLen + 1));
+        int32 truncatedLen = WideFromUtf8(wide, destLen, (char const *)src, srcLen);
+        bool truncatedRight = truncatedLen <= destLen - 1 && memcmp(wide, expected, sizeof(wchar) * truncatedLen) == 0 && wide[truncatedLen] == 0;
+        truncatedRight &= truncatedLen == expectedLen || truncatedLen > destLen - 1 - int32(4 / sizeof(wchar));
+        numTruncatedWrong += (truncatedRight == false);
+    }
+    TEST_CHECK(numWrong == 0);
+    TEST_CHECK(numTruncatedWrong == 0);
+}
+
+//converts random wchars to UTF-8 and back, checking against the reference conversions
+static void TestUtfFuzzWide()
+{
+    TestRandom random(32);
+    wchar src[TEST_UTF_FUZZ_MAX + 1];
+    uint32 characters[TEST_UTF_FUZZ_MAX];
+    char expected[TEST_UTF_FUZZ_MAX * 4 + 1];
+    char utf8[TEST_UTF_FUZZ_MAX * 4 + 1];
+    wchar expectedBack[TEST_UTF_FUZZ_MAX * 2 + 1];
+    wchar back[TEST_UTF_FUZZ_MAX * 2 + 1];
+    int32 numWrong = 0;
+    int32 numTruncatedWrong = 0;
+    for (int32 n = 0; n < TEST_UTF_FUZZ; n++)
+    {
+        //what it should be
+        int32 srcLen = TestUtfRandomWide(random, src);
+        src[srcLen] = 0;
+        int32 numCharacters = TestUtfDecodeWide(src, srcLen, characters);
+        int32 expectedLen = TestUtfEncode8(characters, numCharacters, expected);
+
+        //convert it, null terminated half the time
+        int32 utf8Len = Utf8FromWide(utf8, TEST_UTF_FUZZ_MAX * 4 + 1, src, (n & 1) ? srcLen : -1);
+        bool right = utf8Len == expectedLen && memcmp(utf8, expected, expectedLen) == 0 && utf8[utf8Len] == '\0';
+        right &= Utf8FromWide(NULL, 0, src, srcLen) == expectedLen;
+        right &= Utf8Valid(utf8, utf8Len);
+
+        //and back, which gives the characters it was made from
+        int32 backLen = WideFromUtf8(back, TEST_UTF_FUZZ_MAX * 2 + 1, utf8, (n & 2) ? utf8Len : -1);
+        int32 expectedBackLen = TestUtfEncodeWide(characters, numCharacters, expectedBack);
+        right &= backLen == expectedBackLen && memcmp(back, expectedBack, sizeof(wchar) * expectedBackLen) == 0;
+        numWrong += (right == false);
+
+        //into too little room, which stops before the character that doesn't fit
+        int32 destLen = 1 + int32(random.Next(expectedLen + 1));
+        int32 truncatedLen = Utf8FromWide(utf8, destLen, src, srcLen);
+        bool truncatedRight = truncatedLen <= destLen - 1 && memcmp(utf8, expected, truncatedLen) == 0 && utf8[truncatedLen] == '\0';
+        truncatedRight &= truncatedLen == expectedLen || truncatedLen > destLen - 1 - 4;
+        numTruncatedWrong += (truncatedRight == false);
+    }
+    TEST_CHECK(numWrong == 0);
+    TEST_CHECK(numTruncatedWrong == 0);
+}
+
+//times converting ASCII text, which takes the fast path, and text with other characters mixed
+//in, against the reference conversions
+static void TestUtfSpeed()
+{
+    //ASCII, and the same with one character in 16 from further up
+    char *ascii = new char[TEST_UTF_TEXT + 1];
+    wchar *asciiWide = new wchar[TEST_UTF_TEXT + 1];
+    wchar *mixedWide = new wchar[TEST_UTF_TEXT + 1];
+    char *mixed = new char[TEST_UTF_TEXT * 3 + 1];
+    wchar *wide = new wchar[TEST_UTF_TEXT + 1];
+    char *utf8 = new char[TEST_UTF_TEXT * 3 + 1];
+    uint32 *characters = new uint32[TEST_UTF_TEXT * 3];
+    static char const sentence[] = "The quick brown fox jumps over the lazy dog. ";
+    for (int32 i = 0; i < TEST_UTF_TEXT; i++)
+    {
+        ascii[i] = sentence[i % (sizeof(sentence) - 1)];
+        asciiWide[i] = wchar(ascii[i]);
+        mixedWide[i] = ((i & 15) == 15) ? wchar(0x00E9 + (i & 0x300)) : asciiWide[i];
+    }
+    ascii[TEST_UTF_TEXT] = '\0';
+    asciiWide[TEST_UTF_TEXT] = 0;
+    mixedWide[TEST_UTF_TEXT] = 0;
+    int32 mixedLen = Utf8FromWide(mixed, TEST_UTF_TEXT * 3 + 1, mixedWide, TEST_UTF_TEXT);
+    TestReport("Utf conversions, %d character text, ns per character:\n", TEST_UTF_TEXT);
+
+    //UTF-8 to wchars
+    char const *texts[2] = {ascii, mixed};
+    int32 lengths[2] = {TEST_UTF_TEXT, mixedLen};
+    char const *names[2] = {"ASCII", "mixed"};
+    for (int32 t = 0; t < 2; t++)
+    {
+        int64 total = 0;
+        TestClock clock;
+        for (int32 r = 0; r < TEST_UTF_REPEATS; r++)
+        {
+            total += WideFromUtf8(wide, TEST_UTF_TEXT + 1, texts[t], lengths[t]);
+        }
+        double utfTime = clock.Nanoseconds() / (double(TEST_UTF_REPEATS) * TEST_UTF_TEXT);
+        TestKeep(total);
+
+        total = 0;
+        clock.Restart();
+        for (int32 r = 0; r < TEST_UTF_REPEATS; r++)
+        {
+            int32 errors = 0;
+            int32 num = TestUtfDecode8((uint8 const *)texts[t], lengths[t], characters, errors);
+            total += TestUtfEncodeWide(characters, num, wide);
+        }
+        double referenceTime = clock.Nanoseconds() / (double(TEST_UTF_REPEATS) * TEST_UTF_TEXT);
+        TestKeep(total);
+
+        //and checking it
+        clock.Restart();
+        for (int32 r = 0; r < TEST_UTF_REPEATS; r++)
+        {
+            total += Utf8Valid(texts[t], lengths[t]);
+        }
+        double validTime = clock.Nanoseconds() / (double(TEST_UTF_REPEATS) * TEST_UTF_TEXT);
+        TestKeep(total);
+        TestReport("  %s WideFromUtf8 %5.2f, reference %5.2f, %4.1fx; Utf8Valid %5.2f\n", names[t], utfTime, referenceTime, referenceTime / utfTime, validTime);
+    }
+
+    //wchars to UTF-8
+    wchar const *wideTexts[2] = {asciiWide, mixedWide};
+    for (int32 t = 0; t < 2; t++)
+    {
+        int64 total = 0;
+        TestClock clock;
+        for (int32 r = 0; r < TEST_UTF_REPEATS; r++)
+        {
+            total += Utf8FromWide(utf8, TEST_UTF_TEXT * 3 + 1, wideTexts[t], TEST_UTF_TEXT);
+        }
+        double utfTime = clock.Nanoseconds() / (double(TEST_UTF_REPEATS) * TEST_UTF_TEXT);
+        TestKeep(total);
+
+        total = 0;
+        clock.Restart();
+        for (int32 r = 0; r < TEST_UTF_REPEATS; r++)
+        {
+            int32 num = TestUtfDecodeWide(wideTexts[t], TEST_UTF_TEXT, characters);
+            total += TestUtfEncode8(characters, num, utf8);
+        }
+        double referenceTime = clock.Nanoseconds() / (double(TEST_UTF_REPEATS) * TEST_UTF_TEXT);
+        TestKeep(total);
+        TestReport("  %s Utf8FromWide %5.2f, reference %5.2f, %4.1fx\n", names[t], utfTime, referenceTime, referenceTime / utfTime);
+    }
+
+    delca(characters);
+    delca(utf8);
+    delca(wide);
+    delca(mixed);
+    delca(mixedWide);
+    delca(asciiWide);
+    delca(ascii);
+}
+
+
+//
+//global functions
+//
+
+void TestUtf()
+{
+    TestUtfFuzz8();
+    TestUtfFuzzWide();
+    TestUtfSpeed();
+}
+
+#endif